@@ -145,7 +145,8 @@ namespace Aggregator
 		UpdatesManager_ = std::make_shared<UpdatesManager> (UpdatesManager::InitParams {
 					DBUpThread_,
 					ErrorsManager_,
-					Proxy_->GetEntityManager ()
+					Proxy_->GetEntityManager (),
+					Proxy_->GetNetworkAccessManager ()
 				});
 
 		connect (AppWideActions_->ActionUpdateFeeds_,
@@ -30,10 +30,10 @@
 #include "dbupdatethreadworker.h"
 #include <stdexcept>
 #include <QUrl>
+#include <QHash>
 #include <QtDebug>
 #include <util/xpc/util.h>
 #include <util/xpc/defaulthookproxy.h>
-#include <util/sll/lazy.h>
 #include <interfaces/core/ientitymanager.h>
 #include "xmlsettingsmanager.h"
 #include "storagebackend.h"
@@ -95,7 +95,7 @@ namespace Aggregator
 		Proxy_->GetEntityManager ()->HandleEntity (Util::MakeNotification ("Aggregator", str, Priority::Info));
 	}
 
-	bool DBUpdateThreadWorker::AddItem (Item& item, const Channel& channel, const Feed::FeedSettings& settings)
+	bool DBUpdateThreadWorker::PrepareNewItem (Item& item, const Channel& channel, const Feed::FeedSettings& settings)
 	{
 		if (item.PubDate_.isValid ())
 		{
@@ -106,27 +106,26 @@ namespace Aggregator
 			item.FixDate ();
 
 		item.ChannelID_ = channel.ChannelID_;
-		SB_->AddItem (item);
+		return true;
+	}
 
+	void DBUpdateThreadWorker::DownloadEnclosures (const QList<Item>& items, const Channel& channel)
+	{
 		const auto iem = Proxy_->GetEntityManager ();
-		if (settings.AutoDownloadEnclosures_)
+		const auto& path = XmlSettingsManager::Instance ()->property ("EnclosuresDownloadPath").toString ();
+		for (const auto& item : items)
 			for (const auto& e : item.Enclosures_)
 			{
-				auto de = Util::MakeEntity (QUrl (e.URL_),
-						XmlSettingsManager::Instance ()->property ("EnclosuresDownloadPath").toString (),
-						0,
-						e.Type_);
+				auto de = Util::MakeEntity (QUrl (e.URL_), path, 0, e.Type_);
 				de.Additional_ [" Tags"] = channel.Tags_;
 				iem->HandleEntity (de);
 			}
-
-		return true;
 	}
 
-	bool DBUpdateThreadWorker::UpdateItem (const Item& item, Item ourItem)
+	std::optional<Item> DBUpdateThreadWorker::MergeItem (const Item& item, Item ourItem)
 	{
 		if (!IsModified (ourItem, item))
-			return false;
+			return {};
 
 		ourItem.Description_ = item.Description_;
 		ourItem.Categories_ = item.Categories_;
@@ -150,9 +149,7 @@ namespace Aggregator
 				ourItem.MRSSEntries_ << entry;
 			}
 
-		SB_->UpdateItem (ourItem);
-
-		return true;
+		return ourItem;
 	}
 
 	void DBUpdateThreadWorker::NotifyUpdates (int newItems, int updatedItems, const Channel_ptr& channel)
@@ -216,7 +213,23 @@ namespace Aggregator
 		SB_->ToggleChannelUnread (channel, state);
 	}
 
-	void DBUpdateThreadWorker::updateFeed (channels_container_t channels, QString url)
+	bool DBUpdateThreadWorker::updateFeed (channels_container_t channels, QString url)
+	{
+		try
+		{
+			return UpdateFeed (channels, url);
+		}
+		catch (const std::exception& e)
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "unable to update"
+					<< url
+					<< e.what ();
+			return false;
+		}
+	}
+
+	bool DBUpdateThreadWorker::UpdateFeed (const channels_container_t& channels, const QString& url)
 	{
 		const auto maybeFeedId = SB_->FindFeed (url);
 		if (!maybeFeedId)
@@ -225,10 +238,12 @@ namespace Aggregator
 				<< "skipping"
 				<< url
 				<< "cause seems like it's not in storage yet";
-			return;
+			return false;
 		}
 		const auto feedId = *maybeFeedId;
 
+		const auto transaction = SB_->StartTransaction ();
+
 		const auto& feedSettings = GetFeedSettings (feedId);
 		const auto ipc = feedSettings.NumItems_;
 		const auto days = feedSettings.ItemAge_;
@@ -245,39 +260,90 @@ namespace Aggregator
 			const auto ourChannelID = *maybeOurChannelID;
 			const auto& ourChannel = SB_->GetChannel (ourChannelID);
 
-			int newItems = 0;
-			int updatedItems = 0;
+			QHash<QPair<QString, QString>, IDType_t> byTitleLink;
+			QHash<QString, IDType_t> byLink;
+			QHash<QString, IDType_t> byTitle;
+			const auto rememberKey = [&] (IDType_t id, const QString& title, const QString& link)
+			{
+				if (!byTitleLink.contains ({ title, link }))
+					byTitleLink.insert ({ title, link }, id);
+				if (!link.isEmpty () && !byLink.contains (link))
+					byLink.insert (link, id);
+				if (!byTitle.contains (title))
+					byTitle.insert (title, id);
+			};
+			for (const auto& key : SB_->GetItemsKeys (ourChannelID))
+				rememberKey (key.ItemID_, key.Title_, key.Link_);
+
+			const auto findItem = [&] (const Item& item) -> std::optional<IDType_t>
+			{
+				if (const auto pos = byTitleLink.find ({ item.Title_, item.Link_ }); pos != byTitleLink.end ())
+					return *pos;
+				if (!item.Link_.isEmpty ())
+					if (const auto pos = byLink.find (item.Link_); pos != byLink.end ())
+						return *pos;
+				if (item.Link_.isEmpty ())
+					if (const auto pos = byTitle.find (item.Title_); pos != byTitle.end ())
+						return *pos;
+				return {};
+			};
+
+			QList<Item> newItems;
+			QList<Item> updatedItems;
+			QHash<IDType_t, int> updatedPositions;
+			QHash<IDType_t, int> newPositions;
 
 			for (const auto& itemPtr : channel->Items_)
 			{
 				auto& item = *itemPtr;
 
-				auto mkLazy = [] (auto&& f) { return Util::MakeLazyF<std::optional<IDType_t>> (f); };
-				const auto& ourItemID = Util::Msum ({
-							mkLazy ([&] { return SB_->FindItem (item.Title_, item.Link_, ourChannel.ChannelID_); }),
-							mkLazy ([&] { return SB_->FindItemByLink (item.Link_, ourChannel.ChannelID_); }),
-							mkLazy ([&]
-									{
-										if (!item.Link_.isEmpty ())
-											return std::optional<IDType_t> {};
-
-										return SB_->FindItemByTitle (item.Title_, ourChannel.ChannelID_);
-									})
-						}) ();
-				if (ourItemID)
+				if (const auto ourItemID = findItem (item))
+				{
+					if (const auto newPos = newPositions.find (*ourItemID); newPos != newPositions.end ())
+					{
+						if (const auto merged = MergeItem (item, newItems.at (*newPos)))
+							newItems [*newPos] = *merged;
+						continue;
+					}
+
+					const auto updatedPos = updatedPositions.find (*ourItemID);
+					const auto& ourItem = updatedPos != updatedPositions.end () ?
+							std::optional<Item> { updatedItems.at (*updatedPos) } :
+							SB_->GetItem (*ourItemID);
+					if (!ourItem)
+						continue;
+
+					if (const auto merged = MergeItem (item, *ourItem))
+					{
+						if (updatedPos != updatedPositions.end ())
+							updatedItems [*updatedPos] = *merged;
+						else
+						{
+							updatedPositions [*ourItemID] = updatedItems.size ();
+							updatedItems << *merged;
+						}
+					}
+				}
+				else if (PrepareNewItem (item, ourChannel, feedSettings))
 				{
-					if (const auto& ourItem = SB_->GetItem (*ourItemID);
-						ourItem && UpdateItem (item, *ourItem))
-						++updatedItems;
+					rememberKey (item.ItemID_, item.Title_, item.Link_);
+					newPositions [item.ItemID_] = newItems.size ();
+					newItems << item;
 				}
-				else if (AddItem (item, ourChannel, feedSettings))
-					++newItems;
 			}
 
+			SB_->AddItems (newItems);
+			SB_->UpdateItems (updatedItems);
+
+			if (feedSettings.AutoDownloadEnclosures_)
+				DownloadEnclosures (newItems, ourChannel);
+
 			SB_->TrimChannel (ourChannel.ChannelID_, days, ipc);
 
-			NotifyUpdates (newItems, updatedItems, channel);
+			NotifyUpdates (newItems.size (), updatedItems.size (), channel);
 		}
+
+		return true;
 	}
 }
 }
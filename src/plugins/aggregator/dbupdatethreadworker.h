@@ -59,14 +59,24 @@ namespace Aggregator
 	private:
 		Feed::FeedSettings GetFeedSettings (IDType_t);
 		void AddChannel (Channel channel);
-		bool AddItem (Item& item, const Channel& channel, const Feed::FeedSettings& settings);
-		bool UpdateItem (const Item& item, Item ourItem);
+		bool PrepareNewItem (Item& item, const Channel& channel, const Feed::FeedSettings& settings);
+		void DownloadEnclosures (const QList<Item>& items, const Channel& channel);
+		std::optional<Item> MergeItem (const Item& item, Item ourItem);
 		void NotifyUpdates (int newItems, int updatedItems, const Channel_ptr& channel);
 
 		std::optional<IDType_t> MatchChannel (const Channel&, IDType_t, const channels_container_t&) const;
+
+		bool UpdateFeed (const channels_container_t& channels, const QString& url);
 	public slots:
 		void toggleChannelUnread (IDType_t channel, bool state);
-		void updateFeed (channels_container_t channels, QString url);
+
+		/** @brief Stores the freshly fetched channels of the feed.
+		 *
+		 * @return Whether the channels have been stored, that is, the
+		 * feed still exists and the update transaction hasn't been
+		 * rolled back.
+		 */
+		bool updateFeed (channels_container_t channels, QString url);
 	};
 }
 }
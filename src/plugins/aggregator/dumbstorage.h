@@ -61,15 +61,21 @@ namespace Aggregator
 		items_shorts_t GetItems (IDType_t) const override { return {}; }
 		int GetUnreadItemsCount (IDType_t) const override { return {}; }
 		int GetTotalItemsCount (IDType_t) const override { return {}; }
+		QDateTime GetNewestItemDate (IDType_t) const override { return {}; }
 		std::optional<Item> GetItem (IDType_t) const override { return {}; }
 		std::optional<IDType_t> FindItem (const QString&, const QString&, IDType_t) const override { return {}; }
 		std::optional<IDType_t> FindItemByTitle (const QString&, IDType_t) const override { return {}; }
 		std::optional<IDType_t> FindItemByLink (const QString&, IDType_t) const override { return {}; }
+		QList<ItemKey> GetItemsKeys (IDType_t) const override { return {}; }
 		items_container_t GetFullItems (IDType_t) const override { return {}; }
+		QList<IDType_t> SearchItems (const QString&, int) const override { return {}; }
 		void AddFeed (const Feed&) override {}
 		void AddChannel (const Channel&) override {}
 		void AddItem (const Item&) override {}
 		void UpdateItem (const Item&) override {}
+		void AddItems (const QList<Item>&) override {}
+		void UpdateItems (const QList<Item>&) override {}
+		Util::DefaultScopeGuard StartTransaction () override { return Util::MakeScopeGuard ([] {}); }
 		void SetItemUnread (IDType_t, bool) override {}
 		void RemoveItems (const QSet<IDType_t>&) override {}
 		void RemoveChannel (IDType_t) override {}
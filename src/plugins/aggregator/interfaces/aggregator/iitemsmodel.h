@@ -51,6 +51,7 @@ namespace Aggregator
 		};
 
 		virtual void reset (IDType_t channelId) = 0;
+		virtual void resetItems (const QList<IDType_t>& items) = 0;
 		virtual void selected (const QModelIndex&) = 0;
 	};
 }
@@ -34,6 +34,7 @@
 #include "common.h"
 
 class QAbstractItemModel;
+class QString;
 
 namespace LeechCraft
 {
@@ -66,6 +67,16 @@ namespace Aggregator
 		virtual void SetItemRead (IDType_t, bool) const = 0;
 
 		virtual QAbstractItemModel* CreateItemsModel () const = 0;
+
+		/** @brief Searches the items of all channels by their text.
+		 *
+		 * @param[in] query The words to search for in items' titles
+		 * and descriptions.
+		 * @param[in] limit The maximum number of results.
+		 * @return The IDs of the matching items, the most relevant
+		 * ones first.
+		 */
+		virtual QList<IDType_t> SearchItems (const QString& query, int limit) const = 0;
 	};
 
 	typedef std::shared_ptr<IProxyObject> IProxyObject_ptr;
@@ -442,6 +442,11 @@ namespace Aggregator
 		Reset (channelId);
 	}
 
+	void ItemsListModel::resetItems (const QList<IDType_t>& items)
+	{
+		Reset (items);
+	}
+
 	void ItemsListModel::selected (const QModelIndex& index)
 	{
 		Selected (index);
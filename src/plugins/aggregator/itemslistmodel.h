@@ -88,6 +88,7 @@ namespace Aggregator
 		StorageBackend_ptr GetSB () const;
 	public slots:
 		void reset (IDType_t) override;
+		void resetItems (const QList<IDType_t>&) override;
 		void selected (const QModelIndex&) override;
 	private slots:
 		void handleItemsRemoved (const QSet<IDType_t>&);
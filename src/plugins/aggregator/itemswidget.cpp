@@ -1438,17 +1438,26 @@ namespace Aggregator
 	void ItemsWidget::updateItemsFilter ()
 	{
 		const int section = Impl_->Ui_.SearchType_->currentIndex ();
+		const QString& text = Impl_->Ui_.SearchLine_->text ();
 		if (section == 4)
 		{
 			const auto& sb = StorageBackendManager::Instance ().MakeStorageBackendForThread ();
 			Impl_->CurrentItemsModel_->Reset (sb->GetItemsForTag ("_important"));
 		}
+		else if (section == 5 && !text.trimmed ().isEmpty ())
+		{
+			const int maxResults = 500;
+			const auto& sb = StorageBackendManager::Instance ().MakeStorageBackendForThread ();
+			Impl_->CurrentItemsModel_->Reset (sb->SearchItems (text, maxResults));
+		}
 		else
 			CurrentChannelChanged (Impl_->LastSelectedChannel_);
 
-		const QString& text = Impl_->Ui_.SearchLine_->text ();
 		switch (section)
 		{
+		case 5:
+			Impl_->ItemsFilterModel_->setFilterFixedString ({});
+			break;
 		case 1:
 			Impl_->ItemsFilterModel_->setFilterWildcard (text);
 			break;
@@ -62,6 +62,19 @@ namespace Aggregator
 			*/
 		virtual channels_container_t ParseFeed (const QDomDocument& document,
 				const IDType_t& feedId) const;
+
+		/** @brief Parses a single item element.
+			*
+			* The element is expected to be attached to its parent
+			* channel element, since some data (like MediaRSS ratings)
+			* may be inherited from there.
+			*
+			* @param[in] item The item (or entry) element.
+			* @param[in] channelId The ID of the parent channel.
+			* @return The parsed item.
+			*/
+		virtual Item_ptr ParseItem (const QDomElement& item,
+				const IDType_t& channelId) const = 0;
 	protected:
 		static const QString DC_;
 		static const QString WFW_;
@@ -67,6 +67,16 @@ namespace Aggregator
 				return parser;
 		return nullptr;
 	}
+
+	bool ParserFactory::IsStreaming () const
+	{
+		return IsStreaming_;
+	}
+
+	void ParserFactory::SetStreaming (bool streaming)
+	{
+		IsStreaming_ = streaming;
+	}
 }
 }
 
@@ -42,6 +42,7 @@ namespace Aggregator
 	class ParserFactory
 	{
 		QList<Parser*> Parsers_;
+		bool IsStreaming_ = true;
 
 		ParserFactory () = default;
 	public:
@@ -51,6 +52,15 @@ namespace Aggregator
 		void RegisterDefaultParsers ();
 
 		Parser* Return (const QDomDocument&) const;
+
+		/** @brief Returns whether the feeds should be parsed by the StreamParser.
+		 *
+		 * If this is false, the whole feed is loaded into a
+		 * QDomDocument and passed to Parser::ParseFeed() instead.
+		 * The latter is mostly useful for comparing the results.
+		 */
+		bool IsStreaming () const;
+		void SetStreaming (bool);
 	};
 }
 }
@@ -35,6 +35,7 @@
 #include <Wt/WContainerWidget.h>
 #include <Wt/WBoxLayout.h>
 #include <Wt/WCheckBox.h>
+#include <Wt/WLineEdit.h>
 #include <Wt/WTreeView.h>
 #include <Wt/WTableView.h>
 #include <Wt/WStandardItemModel.h>
@@ -160,6 +161,17 @@ namespace WebAccess
 		ItemsModelDecorator { SourceItemModel_ }.Reset (cid, fid);
 	}
 
+	void AggregatorApp::HandleSearch (const QString& query)
+	{
+		if (query.trimmed ().isEmpty ())
+			return;
+
+		ItemView_->setText ({});
+
+		ItemsFilter_->ClearCurrentItem ();
+		ItemsModelDecorator { SourceItemModel_ }.ResetItems (AP_->SearchItems (query, 200));
+	}
+
 	void AggregatorApp::HandleItemClicked (const Wt::WModelIndex& idx, const Wt::WMouseEvent& event)
 	{
 		if (!idx.isValid ())
@@ -241,6 +253,15 @@ namespace WebAccess
 		showReadItems->checked ().connect ([this] { ItemsFilter_->SetHideRead (false); });
 		showReadItems->unChecked ().connect ([this] { ItemsFilter_->SetHideRead (true); });
 
+		auto searchLine = rightPaneLay->addWidget (std::make_unique<Wt::WLineEdit> ());
+		searchLine->setPlaceholderText (ToW (tr ("Search in all channels...")));
+		searchLine->enterPressed ().connect ([this, searchLine, showReadItems]
+				{
+					showReadItems->setChecked (true);
+					ItemsFilter_->SetHideRead (false);
+					HandleSearch (QString::fromStdString (searchLine->text ().toUTF8 ()));
+				});
+
 		ItemsTable_ = rightPaneLay->addWidget (std::make_unique<Wt::WTableView> (), 2, Wt::AlignmentFlag::Justify);
 		ItemsTable_->setModel (ItemsFilter_);
 		ItemsTable_->mouseWentUp ().connect (this, &AggregatorApp::HandleItemClicked);
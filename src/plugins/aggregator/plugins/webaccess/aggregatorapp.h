@@ -87,6 +87,7 @@ namespace WebAccess
 	private:
 		void HandleChannelClicked (const Wt::WModelIndex&, const Wt::WMouseEvent&);
 		void HandleItemClicked (const Wt::WModelIndex&, const Wt::WMouseEvent&);
+		void HandleSearch (const QString&);
 
 		void ShowItem (const QModelIndex&, const Item&);
 		void ShowItemMenu (const QModelIndex&, const Item&, const Wt::WMouseEvent&);
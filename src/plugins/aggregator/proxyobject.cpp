@@ -156,5 +156,10 @@ namespace Aggregator
 	{
 		return new ItemsListModel { Util::CoreProxyHolder::Get ()->GetIconThemeManager () };
 	}
+
+	QList<IDType_t> ProxyObject::SearchItems (const QString& query, int limit) const
+	{
+		return StorageBackendManager::Instance ().MakeStorageBackendForThread ()->SearchItems (query, limit);
+	}
 }
 }
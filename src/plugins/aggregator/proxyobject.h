@@ -118,6 +118,8 @@ namespace Aggregator
 		void SetItemRead (IDType_t, bool) const override;
 
 		QAbstractItemModel* CreateItemsModel () const override;
+
+		QList<IDType_t> SearchItems (const QString&, int) const override;
 	};
 }
 }
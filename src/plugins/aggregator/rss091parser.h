@@ -43,7 +43,7 @@ namespace Aggregator
 		bool CouldParse (const QDomDocument&) const override;
 	protected:
 		channels_container_t Parse (const QDomDocument&, const IDType_t&) const override;
-		Item_ptr ParseItem (const QDomElement&, const IDType_t&) const;
+		Item_ptr ParseItem (const QDomElement&, const IDType_t&) const override;
 	};
 }
 }
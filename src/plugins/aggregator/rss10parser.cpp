@@ -82,30 +82,36 @@ namespace Aggregator
 			if (!item2Channel.contains (about))
 				continue;
 
-			auto item = std::make_shared<Item> (Item::CreateForChannel (item2Channel [about]->ChannelID_));
-			item->Title_ = itemDescr.firstChildElement ("title").text ();
-			item->Link_ = itemDescr.firstChildElement ("link").text ();
-			item->Description_ = itemDescr.firstChildElement ("description").text ();
-			GetDescription (itemDescr, item->Description_);
-
-			item->Categories_ = GetAllCategories (itemDescr);
-			item->Author_ = GetAuthor (itemDescr);
-			item->PubDate_ = GetDCDateTime (itemDescr);
-			item->Unread_ = true;
-			item->NumComments_ = GetNumComments (itemDescr);
-			item->CommentsLink_ = GetCommentsRSS (itemDescr);
-			item->CommentsPageLink_ = GetCommentsLink (itemDescr);
-			item->Enclosures_ = GetEncEnclosures (itemDescr, item->ItemID_);
-			QPair<double, double> point = GetGeoPoint (itemDescr);
-			item->Latitude_ = point.first;
-			item->Longitude_ = point.second;
-			if (item->Guid_.isEmpty ())
-				item->Guid_ = "empty";
-
-			item2Channel [about]->Items_.push_back (item);
+			const auto& channel = item2Channel [about];
+			channel->Items_.push_back (ParseItem (itemDescr, channel->ChannelID_));
 		}
 	
 		return result;
 	}
+
+	Item_ptr RSS10Parser::ParseItem (const QDomElement& itemDescr, const IDType_t& channelId) const
+	{
+		auto item = std::make_shared<Item> (Item::CreateForChannel (channelId));
+		item->Title_ = itemDescr.firstChildElement ("title").text ();
+		item->Link_ = itemDescr.firstChildElement ("link").text ();
+		item->Description_ = itemDescr.firstChildElement ("description").text ();
+		GetDescription (itemDescr, item->Description_);
+
+		item->Categories_ = GetAllCategories (itemDescr);
+		item->Author_ = GetAuthor (itemDescr);
+		item->PubDate_ = GetDCDateTime (itemDescr);
+		item->Unread_ = true;
+		item->NumComments_ = GetNumComments (itemDescr);
+		item->CommentsLink_ = GetCommentsRSS (itemDescr);
+		item->CommentsPageLink_ = GetCommentsLink (itemDescr);
+		item->Enclosures_ = GetEncEnclosures (itemDescr, item->ItemID_);
+		QPair<double, double> point = GetGeoPoint (itemDescr);
+		item->Latitude_ = point.first;
+		item->Longitude_ = point.second;
+		if (item->Guid_.isEmpty ())
+			item->Guid_ = "empty";
+
+		return item;
+	}
 }
 }
@@ -28,6 +28,7 @@
  **********************************************************************/
 
 #include "sqlstoragebackend.h"
+#include <exception>
 #include <stdexcept>
 #include <QDir>
 #include <QDebug>
@@ -451,6 +452,15 @@ namespace LeechCraft::Aggregator
 		DBRemover_ = Util::MakeScopeGuard ([conn = DB_.connectionName ()] { QSqlDatabase::removeDatabase (conn); });
 	}
 
+	template<typename F>
+	void SQLStorageBackend::Notify (F&& notification)
+	{
+		if (Transaction_)
+			PendingNotifications_ << std::forward<F> (notification);
+		else
+			notification ();
+	}
+
 	void SQLStorageBackend::Prepare ()
 	{
 		if (Type_ == SBSQLite)
@@ -458,6 +468,171 @@ namespace LeechCraft::Aggregator
 			Util::RunTextQuery (DB_, "PRAGMA journal_mode = WAL;");
 			Util::RunTextQuery (DB_, "PRAGMA foreign_keys = ON;");
 		}
+
+		PrepareFTS ();
+	}
+
+	namespace
+	{
+		const QString PGItemsDocument = "to_tsvector ('simple', coalesce (title, '') || ' ' || coalesce (description, ''))";
+
+		bool HasSQLiteTable (const QSqlDatabase& db, const QString& name)
+		{
+			QSqlQuery query { db };
+			query.prepare ("SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = :name;");
+			query.bindValue (":name", name);
+			if (!query.exec ())
+			{
+				Util::DBLock::DumpError (query);
+				return false;
+			}
+			return query.next ();
+		}
+
+		QString MakeFTS5Query (const QString& text)
+		{
+			QStringList terms;
+			for (auto term : text.split (' ', QString::SkipEmptyParts))
+				terms << '"' + term.replace ('"', "\"\"") + '"';
+			return terms.join (' ');
+		}
+	}
+
+	void SQLStorageBackend::PrepareFTS ()
+	{
+		switch (Type_)
+		{
+		case SBSQLite:
+		{
+			if (HasSQLiteTable (DB_, "items_fts"))
+			{
+				HasFTS_ = true;
+				return;
+			}
+
+			try
+			{
+				Util::DBLock lock (DB_);
+				lock.Init ();
+
+				Util::RunTextQuery (DB_,
+						"CREATE VIRTUAL TABLE items_fts USING fts5 "
+						"(title, description, content = 'items', content_rowid = 'item_id');");
+				Util::RunTextQuery (DB_,
+						"CREATE TRIGGER items_fts_insert AFTER INSERT ON items BEGIN "
+						"INSERT INTO items_fts (rowid, title, description) "
+						"VALUES (new.item_id, new.title, new.description); "
+						"END;");
+				Util::RunTextQuery (DB_,
+						"CREATE TRIGGER items_fts_delete AFTER DELETE ON items BEGIN "
+						"INSERT INTO items_fts (items_fts, rowid, title, description) "
+						"VALUES ('delete', old.item_id, old.title, old.description); "
+						"END;");
+				Util::RunTextQuery (DB_,
+						"CREATE TRIGGER items_fts_update AFTER UPDATE OF title, description ON items BEGIN "
+						"INSERT INTO items_fts (items_fts, rowid, title, description) "
+						"VALUES ('delete', old.item_id, old.title, old.description); "
+						"INSERT INTO items_fts (rowid, title, description) "
+						"VALUES (new.item_id, new.title, new.description); "
+						"END;");
+				Util::RunTextQuery (DB_, "INSERT INTO items_fts (items_fts) VALUES ('rebuild');");
+
+				lock.Good ();
+				HasFTS_ = true;
+			}
+			catch (const std::exception& e)
+			{
+				qWarning () << Q_FUNC_INFO
+						<< "unable to create the full-text index, is FTS5 available?"
+						<< e.what ();
+				HasFTS_ = HasSQLiteTable (DB_, "items_fts");
+			}
+			break;
+		}
+		case SBPostgres:
+			try
+			{
+				Util::RunTextQuery (DB_,
+						"CREATE INDEX IF NOT EXISTS items_fts_idx ON items USING GIN (" + PGItemsDocument + ");");
+				HasFTS_ = true;
+			}
+			catch (const std::exception& e)
+			{
+				qWarning () << Q_FUNC_INFO
+						<< "unable to create the full-text index"
+						<< e.what ();
+			}
+			break;
+		case SBMysql:
+			break;
+		}
+	}
+
+	QList<IDType_t> SQLStorageBackend::SearchItems (const QString& text, int limit) const
+	{
+		const auto& trimmed = text.simplified ();
+		if (trimmed.isEmpty () || limit <= 0)
+			return {};
+
+		if (!HasFTS_)
+			return SearchItemsFallback (trimmed, limit);
+
+		QSqlQuery query { DB_ };
+		switch (Type_)
+		{
+		case SBSQLite:
+			query.prepare ("SELECT rowid FROM items_fts WHERE items_fts MATCH :query "
+					"ORDER BY bm25 (items_fts, 10.0, 1.0) LIMIT :limit;");
+			query.bindValue (":query", MakeFTS5Query (trimmed));
+			break;
+		case SBPostgres:
+			query.prepare ("SELECT item_id FROM items, plainto_tsquery ('simple', :query) AS q "
+					"WHERE " + PGItemsDocument + " @@ q "
+					"ORDER BY ts_rank (" + PGItemsDocument + ", q) DESC LIMIT :limit;");
+			query.bindValue (":query", trimmed);
+			break;
+		case SBMysql:
+			return {};
+		}
+		query.bindValue (":limit", limit);
+
+		if (!query.exec ())
+		{
+			Util::DBLock::DumpError (query);
+			return {};
+		}
+
+		QList<IDType_t> result;
+		while (query.next ())
+			result << query.value (0).value<IDType_t> ();
+		return result;
+	}
+
+	QList<IDType_t> SQLStorageBackend::SearchItemsFallback (const QString& text, int limit) const
+	{
+		QStringList conditions;
+		for (const auto& term : text.split (' ', QString::SkipEmptyParts))
+			conditions << QString ("(title LIKE :term%1 OR description LIKE :term%1)").arg (conditions.size ());
+
+		QSqlQuery query { DB_ };
+		query.prepare ("SELECT item_id FROM items WHERE " + conditions.join (" AND ") +
+				" ORDER BY pub_date DESC LIMIT :limit;");
+
+		int i = 0;
+		for (const auto& term : text.split (' ', QString::SkipEmptyParts))
+			query.bindValue (QString (":term%1").arg (i++), '%' + term + '%');
+		query.bindValue (":limit", limit);
+
+		if (!query.exec ())
+		{
+			Util::DBLock::DumpError (query);
+			return {};
+		}
+
+		QList<IDType_t> result;
+		while (query.next ())
+			result << query.value (0).value<IDType_t> ();
+		return result;
 	}
 
 	ids_t SQLStorageBackend::GetFeedsIDs () const
@@ -718,6 +893,18 @@ namespace LeechCraft::Aggregator
 				sph::f<&ItemR::Title_> == title);
 	}
 
+	QList<StorageBackend::ItemKey> SQLStorageBackend::GetItemsKeys (IDType_t channelId) const
+	{
+		constexpr auto keyFields = sph::fields<
+					&ItemR::ItemID_,
+					&ItemR::Title_,
+					&ItemR::URL_
+				>;
+		auto rawTuples = Items_->Select (keyFields, sph::f<&ItemR::ChannelID_> == channelId);
+		return Util::Map (std::move (rawTuples),
+				[] (auto&& tup) { return AggregateFromTuple<ItemKey> (std::forward<decltype (tup)> (tup)); });
+	}
+
 	void SQLStorageBackend::TrimChannel (IDType_t channelId,
 			int days, int number)
 	{
@@ -734,6 +921,8 @@ namespace LeechCraft::Aggregator
 				();
 
 		auto removedIds = QSet<IDType_t>::fromList (removeByDate) + QSet<IDType_t>::fromList (removeByCount);
+		if (removedIds.isEmpty ())
+			return;
 
 		emit itemsRemoved (removedIds);
 
@@ -743,7 +932,7 @@ namespace LeechCraft::Aggregator
 			Items_->DeleteBy (sph::f<&ItemR::ItemID_> == id);
 		lock.Good ();
 
-		emit channelDataUpdated (GetChannel (channelId));
+		Notify ([this, channelId] { emit channelDataUpdated (GetChannel (channelId)); });
 	}
 
 	std::optional<QImage> SQLStorageBackend::GetChannelPixmap (IDType_t channelId) const
@@ -808,6 +997,25 @@ namespace LeechCraft::Aggregator
 		return Items_->Select (sph::count<>, sph::f<&ItemR::ChannelID_> == channelId);
 	}
 
+	QDateTime SQLStorageBackend::GetNewestItemDate (IDType_t feedId) const
+	{
+		QSqlQuery query { DB_ };
+		query.prepare ("SELECT MAX (items.pub_date) FROM items "
+				"INNER JOIN channels ON items.channel_id = channels.channel_id "
+				"WHERE channels.feed_id = :feed_id;");
+		query.bindValue (":feed_id", feedId);
+		if (!query.exec ())
+		{
+			Util::DBLock::DumpError (query);
+			return {};
+		}
+
+		if (!query.next ())
+			return {};
+
+		return oral::FromVariant<QDateTime> {} (query.value (0));
+	}
+
 	std::optional<Item> SQLStorageBackend::GetItem (IDType_t itemId) const
 	{
 		const auto maybeItem = Items_->SelectOne (sph::f<&ItemR::ItemID_> == itemId);
@@ -856,15 +1064,74 @@ namespace LeechCraft::Aggregator
 
 	void SQLStorageBackend::UpdateItem (const Item& item)
 	{
-		Items_->Update (ItemR::FromOrig (item));
+		UpdateItems ({ item });
+	}
 
-		Enclosures_->DeleteBy (sph::f<&ItemR::ItemID_> == item.ItemID_);
-		WriteEnclosures (item.Enclosures_);
-		WriteMRSSEntries (item.MRSSEntries_);
+	void SQLStorageBackend::UpdateItems (const QList<Item>& items)
+	{
+		if (items.isEmpty ())
+			return;
 
-		const auto& channel = GetChannel (item.ChannelID_);
-		emit itemDataUpdated (item, channel);
-		emit channelDataUpdated (channel);
+		Util::DBLock lock (DB_);
+		lock.Init ();
+
+		QList<Enclosure> enclosures;
+		QList<MRSSEntry> entries;
+		for (const auto& item : items)
+		{
+			Items_->Update (ItemR::FromOrig (item));
+			Enclosures_->DeleteBy (sph::f<&EnclosureR::ItemID_> == item.ItemID_);
+
+			enclosures += item.Enclosures_;
+			entries += item.MRSSEntries_;
+		}
+		WriteEnclosures (enclosures);
+		WriteMRSSEntries (entries);
+
+		lock.Good ();
+
+		NotifyItemsChanged (items);
+	}
+
+	Util::DefaultScopeGuard SQLStorageBackend::StartTransaction ()
+	{
+		if (Transaction_)
+			return Util::MakeScopeGuard ([] {});
+
+		Transaction_.emplace (DB_);
+		Transaction_->Init ();
+
+		return Util::MakeScopeGuard ([this, exceptions = std::uncaught_exceptions ()]
+				{
+					const bool isGood = std::uncaught_exceptions () == exceptions;
+					if (isGood)
+						Transaction_->Good ();
+					Transaction_.reset ();
+
+					const auto pending = std::move (PendingNotifications_);
+					PendingNotifications_.clear ();
+					if (isGood)
+						for (const auto& notification : pending)
+							notification ();
+				});
+	}
+
+	void SQLStorageBackend::NotifyItemsChanged (const QList<Item>& items)
+	{
+		Notify ([this, items]
+				{
+					QHash<IDType_t, Channel> channels;
+					for (const auto& item : items)
+					{
+						auto pos = channels.find (item.ChannelID_);
+						if (pos == channels.end ())
+							pos = channels.insert (item.ChannelID_, GetChannel (item.ChannelID_));
+						emit itemDataUpdated (item, *pos);
+					}
+
+					for (const auto& channel : channels)
+						emit channelDataUpdated (channel);
+				});
 	}
 
 	void SQLStorageBackend::SetItemUnread (IDType_t itemId, bool unread)
@@ -882,24 +1149,50 @@ namespace LeechCraft::Aggregator
 
 	void SQLStorageBackend::AddChannel (const Channel& channel)
 	{
+		Util::DBLock lock (DB_);
+		lock.Init ();
+
 		Channels_->Insert (ChannelR::FromOrig (channel));
-		for (const auto& item : channel.Items_)
-			AddItem (*item);
-		emit channelAdded (channel);
+		AddItems (Util::Map (channel.Items_, [] (const Item_ptr& item) { return *item; }));
+
+		lock.Good ();
+
+		Notify ([this, channel] { emit channelAdded (channel); });
 	}
 
 	void SQLStorageBackend::AddItem (const Item& item)
 	{
-		Items_->Insert (ItemR::FromOrig (item));
+		AddItems ({ item });
+	}
+
+	void SQLStorageBackend::AddItems (const QList<Item>& items)
+	{
+		if (items.isEmpty ())
+			return;
 
-		WriteEnclosures (item.Enclosures_);
-		WriteMRSSEntries (item.MRSSEntries_);
+		Util::DBLock lock (DB_);
+		lock.Init ();
 
-		emit hookItemAdded (std::make_shared<Util::DefaultHookProxy> (), item);
+		Items_->Insert.Batch (Util::Map (items, &ItemR::FromOrig));
 
-		const auto& channel = GetChannel (item.ChannelID_);
-		emit itemDataUpdated (item, channel);
-		emit channelDataUpdated (channel);
+		QList<Enclosure> enclosures;
+		QList<MRSSEntry> entries;
+		for (const auto& item : items)
+		{
+			enclosures += item.Enclosures_;
+			entries += item.MRSSEntries_;
+		}
+		WriteEnclosures (enclosures);
+		WriteMRSSEntries (entries);
+
+		lock.Good ();
+
+		Notify ([this, items]
+				{
+					for (const auto& item : items)
+						emit hookItemAdded (std::make_shared<Util::DefaultHookProxy> (), item);
+				});
+		NotifyItemsChanged (items);
 	}
 
 	void SQLStorageBackend::RemoveItems (const QSet<IDType_t>& items)
@@ -986,8 +1279,7 @@ namespace LeechCraft::Aggregator
 
 	void SQLStorageBackend::WriteEnclosures (const QList<Enclosure>& enclosures)
 	{
-		for (const auto& enclosure : enclosures)
-			Enclosures_->Insert (EnclosureR::FromOrig (enclosure));
+		Enclosures_->Insert.Batch (Util::Map (enclosures, &EnclosureR::FromOrig));
 	}
 
 	void SQLStorageBackend::GetEnclosures (IDType_t itemId, QList<Enclosure>& enclosures) const
@@ -1000,22 +1292,37 @@ namespace LeechCraft::Aggregator
 		template<typename RecType, typename OrigType>
 		void InsertList (const oral::ObjectInfo_ptr<RecType>& records, const QList<OrigType>& origs)
 		{
-			for (const auto& orig : origs)
-				records->Insert (RecType::FromOrig (orig), oral::InsertAction::Replace::PKey<RecType>);
+			records->Insert.Batch (Util::Map (origs, &RecType::FromOrig),
+					oral::InsertAction::Replace::PKey<RecType>);
 		}
 	}
 
 	void SQLStorageBackend::WriteMRSSEntries (const QList<MRSSEntry>& entries)
 	{
+		if (entries.isEmpty ())
+			return;
+
+		InsertList (MRSSEntries_, entries);
+
+		QList<MRSSThumbnail> thumbnails;
+		QList<MRSSCredit> credits;
+		QList<MRSSComment> comments;
+		QList<MRSSPeerLink> peerLinks;
+		QList<MRSSScene> scenes;
 		for (const auto& e : entries)
 		{
-			MRSSEntries_->Insert (MRSSEntryR::FromOrig (e), oral::InsertAction::Replace::PKey<MRSSEntryR>);
-			InsertList (MRSSThumbnails_, e.Thumbnails_);
-			InsertList (MRSSCredits_, e.Credits_);
-			InsertList (MRSSComments_, e.Comments_);
-			InsertList (MRSSPeerLinks_, e.PeerLinks_);
-			InsertList (MRSSScenes_, e.Scenes_);
+			thumbnails += e.Thumbnails_;
+			credits += e.Credits_;
+			comments += e.Comments_;
+			peerLinks += e.PeerLinks_;
+			scenes += e.Scenes_;
 		}
+
+		InsertList (MRSSThumbnails_, thumbnails);
+		InsertList (MRSSCredits_, credits);
+		InsertList (MRSSComments_, comments);
+		InsertList (MRSSPeerLinks_, peerLinks);
+		InsertList (MRSSScenes_, scenes);
 	}
 
 	namespace
@@ -29,9 +29,12 @@
 
 #pragma once
 
+#include <functional>
+#include <optional>
 #include <QSqlDatabase>
 #include <QSqlQuery>
 #include <util/sll/util.h>
+#include <util/db/dblock.h>
 #include <util/db/oral/oralfwd.h>
 #include "storagebackend.h"
 
@@ -79,6 +82,11 @@ namespace Aggregator
 		Util::oral::ObjectInfo_ptr<MRSSEntryR> MRSSEntries_;
 		Util::oral::ObjectInfo_ptr<Item2TagsR> Items2Tags_;
 		Util::oral::ObjectInfo_ptr<Feed2TagsR> Feeds2Tags_;
+
+		std::optional<Util::DBLock> Transaction_;
+		QList<std::function<void ()>> PendingNotifications_;
+
+		bool HasFTS_ = false;
 	public:
 		SQLStorageBackend (Type, const QString&);
 
@@ -108,14 +116,20 @@ namespace Aggregator
 		items_shorts_t GetItems (IDType_t) const override;
 		int GetUnreadItemsCount (IDType_t) const override;
 		int GetTotalItemsCount (IDType_t) const override;
+		QDateTime GetNewestItemDate (IDType_t) const override;
 		std::optional<Item> GetItem (IDType_t) const override;
 		std::optional<IDType_t> FindItem (const QString&, const QString&, IDType_t) const override;
 		std::optional<IDType_t> FindItemByLink (const QString&, IDType_t) const override;
 		std::optional<IDType_t> FindItemByTitle (const QString&, IDType_t) const override;
+		QList<ItemKey> GetItemsKeys (IDType_t) const override;
 		items_container_t GetFullItems (IDType_t) const override;
+		QList<IDType_t> SearchItems (const QString&, int) const override;
 
 		void AddFeed (const Feed&) override;
 		void UpdateItem (const Item&) override;
+		void AddItems (const QList<Item>&) override;
+		void UpdateItems (const QList<Item>&) override;
+		Util::DefaultScopeGuard StartTransaction () override;
 		void SetItemUnread (IDType_t, bool) override;
 		void AddChannel (const Channel&) override;
 		void AddItem (const Item&) override;
@@ -133,6 +147,14 @@ namespace Aggregator
 
 		IDType_t GetHighestID (const PoolType&) const override;
 	private:
+		template<typename F>
+		void Notify (F&&);
+
+		void NotifyItemsChanged (const QList<Item>&);
+
+		void PrepareFTS ();
+		QList<IDType_t> SearchItemsFallback (const QString&, int) const;
+
 		void WriteEnclosures (const QList<Enclosure>&);
 		void GetEnclosures (IDType_t, QList<Enclosure>&) const;
 		void WriteMRSSEntries (const QList<MRSSEntry>&);
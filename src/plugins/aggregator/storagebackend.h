@@ -34,6 +34,7 @@
 #include <QSet>
 #include <interfaces/core/ihookproxy.h>
 #include <interfaces/core/itagsmanager.h>
+#include <util/sll/util.h>
 #include "feed.h"
 
 namespace LeechCraft
@@ -56,6 +57,17 @@ namespace Aggregator
 		struct ChannelNotFoundError {};
 		struct ItemNotFoundError {};
 
+		/** @brief The fields identifying an item within its channel.
+		 *
+		 * @sa GetItemsKeys()
+		 */
+		struct ItemKey
+		{
+			IDType_t ItemID_;
+			QString Title_;
+			QString Link_;
+		};
+
 		enum Type
 		{
 			SBSQLite,
@@ -201,6 +213,14 @@ namespace Aggregator
 		 */
 		virtual int GetTotalItemsCount (IDType_t channel) const = 0;
 
+		/** @brief Returns the publication date of the newest item in the \em feed.
+		 *
+		 * @param[in] feed Feed ID.
+		 * @return The date of the newest item among all the channels of
+		 * the feed, or an invalid date if there are no items.
+		 */
+		virtual QDateTime GetNewestItemDate (IDType_t feed) const = 0;
+
 		/** @brief Returns full information about an item.
 		 *
 		 * Returns full information about the item identified by
@@ -266,6 +286,18 @@ namespace Aggregator
 		 */
 		virtual std::optional<IDType_t> FindItemByLink (const QString& link, IDType_t channel) const = 0;
 
+		/** @brief Returns the identifying fields of all the items in the
+		 * channel.
+		 *
+		 * This is the set-based counterpart of FindItem(),
+		 * FindItemByLink() and FindItemByTitle() for matching lots of
+		 * incoming items at once.
+		 *
+		 * @param[in] channel ID of the channel.
+		 * @return The IDs, titles and links of the items in the channel.
+		 */
+		virtual QList<ItemKey> GetItemsKeys (IDType_t channel) const = 0;
+
 		/** @brief Returns all items in the channel.
 		 *
 		 * Returns full information about all the items in the
@@ -279,6 +311,20 @@ namespace Aggregator
 		 */
 		virtual items_container_t GetFullItems (IDType_t id) const = 0;
 
+		/** @brief Searches the items of all channels by their text.
+		 *
+		 * The \em query is matched against the titles and descriptions
+		 * of the items using the full-text index of the storage, if
+		 * any. Each whitespace-separated word of the \em query should
+		 * be present in the item for the item to match.
+		 *
+		 * @param[in] query The text to search for.
+		 * @param[in] limit The maximum number of results to return.
+		 * @return The IDs of the matching items, the most relevant
+		 * ones first.
+		 */
+		virtual QList<IDType_t> SearchItems (const QString& query, int limit) const = 0;
+
 		/** @brief Puts a feed and all its child channels and items into the
 		 * storage.
 		 *
@@ -328,6 +374,44 @@ namespace Aggregator
 		 */
 		virtual void UpdateItem (const Item& item) = 0;
 
+		/** @brief Adds the new items to already existing channels.
+		 *
+		 * This is a batched version of AddItem(): the items and their
+		 * enclosures and MediaRSS entries are inserted by multi-row
+		 * statements where the database supports that, in a single
+		 * transaction.
+		 *
+		 * @param[in] items The items to add.
+		 *
+		 * @sa AddItem()
+		 */
+		virtual void AddItems (const QList<Item>& items) = 0;
+
+		/** @brief Updates already existing items.
+		 *
+		 * This is a batched version of UpdateItem(), doing all the work
+		 * in a single transaction.
+		 *
+		 * @param[in] items The new versions of the items.
+		 *
+		 * @sa UpdateItem()
+		 */
+		virtual void UpdateItems (const QList<Item>& items) = 0;
+
+		/** @brief Starts a transaction spanning several calls.
+		 *
+		 * The transaction is committed when the returned guard is
+		 * destroyed, or rolled back if it is destroyed due to an
+		 * exception. The signals about the changes made during the
+		 * transaction are emitted after it is committed, so that the
+		 * other threads see the changes once they are notified.
+		 *
+		 * Nested transactions are merged into the outermost one.
+		 *
+		 * @return The guard object ending the transaction.
+		 */
+		[[nodiscard]] virtual Util::DefaultScopeGuard StartTransaction () = 0;
+
 		/** @brief Changes the read status of the \em item.
 		 *
 		 * @param[in] item The unique ID of the item.
@@ -0,0 +1,282 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#include "streamparser.h"
+#include <QDomDocument>
+#include <QSet>
+#include <QXmlStreamReader>
+#include <QtDebug>
+#include <util/sll/either.h>
+#include "parser.h"
+#include "parserfactory.h"
+
+namespace LeechCraft::Aggregator
+{
+	namespace
+	{
+		/** After this many consecutive items older than the known newest one
+		 * the rest of the feed is considered to be known as well.
+		 */
+		const int MaxStaleItems = 3;
+
+		QDomElement MakeElement (QDomDocument& doc, const QXmlStreamReader& reader)
+		{
+			auto elem = doc.createElementNS (reader.namespaceUri ().toString (),
+					reader.qualifiedName ().toString ());
+			for (const auto& attr : reader.attributes ())
+				elem.setAttributeNS (attr.namespaceUri ().toString (),
+						attr.qualifiedName ().toString (),
+						attr.value ().toString ());
+			return elem;
+		}
+
+		void AppendCharacters (QDomDocument& doc, QDomNode& parent, const QXmlStreamReader& reader)
+		{
+			// QDomDocument skips whitespace-only text nodes too.
+			if (reader.isWhitespace ())
+				return;
+
+			const auto& text = reader.text ().toString ();
+			if (reader.isCDATA ())
+				parent.appendChild (doc.createCDATASection (text));
+			else
+				parent.appendChild (doc.createTextNode (text));
+		}
+
+		/** Reads the subtree of the element the reader is currently at
+		 * and appends it to the parent, returning the subtree root.
+		 */
+		QDomElement ReadSubtree (QDomDocument& doc, QDomElement parent, QXmlStreamReader& reader)
+		{
+			const auto root = MakeElement (doc, reader);
+			parent.appendChild (root);
+
+			QDomElement current = root;
+			int depth = 1;
+			while (depth && !reader.atEnd ())
+				switch (reader.readNext ())
+				{
+				case QXmlStreamReader::StartElement:
+				{
+					auto elem = MakeElement (doc, reader);
+					current.appendChild (elem);
+					current = elem;
+					++depth;
+					break;
+				}
+				case QXmlStreamReader::EndElement:
+					current = current.parentNode ().toElement ();
+					--depth;
+					break;
+				case QXmlStreamReader::Characters:
+					AppendCharacters (doc, current, reader);
+					break;
+				default:
+					break;
+				}
+
+			return root;
+		}
+
+		bool IsItem (const QDomElement& parent, const QDomElement& root, const QXmlStreamReader& reader)
+		{
+			const auto& name = reader.name ();
+			if (name != QLatin1String ("item") && name != QLatin1String ("entry"))
+				return false;
+
+			return parent == root ||
+					(parent.parentNode () == root && parent.localName () == "channel");
+		}
+
+		class StreamParseContext
+		{
+			const StreamParser::Params& Params_;
+			QXmlStreamReader& Reader_;
+
+			QDomDocument Skeleton_;
+			QDomElement Root_;
+
+			Parser *Parser_ = nullptr;
+
+			int ChannelsCount_ = 0;
+			QMap<int, IDType_t> ChannelIds_;
+			QMap<int, items_container_t> Items_;
+			QSet<int> KeptItems_;
+
+			int StaleItems_ = 0;
+			QDateTime LastPubDate_;
+			bool IsDescending_ = true;
+		public:
+			StreamParseContext (const StreamParser::Params& params, QXmlStreamReader& reader)
+			: Params_ { params }
+			, Reader_ { reader }
+			{
+			}
+
+			StreamParser::Result_t operator() ()
+			{
+				while (!Reader_.atEnd () && !Reader_.isStartElement ())
+					Reader_.readNext ();
+				if (!Reader_.isStartElement ())
+					return StreamParser::Result_t::Left (MakeXmlError ());
+
+				Root_ = MakeElement (Skeleton_, Reader_);
+				Skeleton_.appendChild (Root_);
+
+				Parser_ = ParserFactory::Instance ().Return (Skeleton_);
+				if (!Parser_)
+					return StreamParser::Result_t::Left (StreamParser::NoParserError {});
+
+				if (!ReadBody ())
+					return StreamParser::Result_t::Left (MakeXmlError ());
+
+				return StreamParser::Result_t::Right (CollectChannels ());
+			}
+		private:
+			StreamParser::XmlError MakeXmlError () const
+			{
+				return { Reader_.errorString (), Reader_.lineNumber (), Reader_.columnNumber () };
+			}
+
+			bool ReadBody ()
+			{
+				QDomElement current = Root_;
+				while (!Reader_.atEnd ())
+					switch (Reader_.readNext ())
+					{
+					case QXmlStreamReader::StartElement:
+						if (IsItem (current, Root_, Reader_))
+						{
+							if (!HandleItem (current))
+								return true;
+							break;
+						}
+
+						if (current == Root_ && Reader_.name () == QLatin1String ("channel"))
+							++ChannelsCount_;
+
+						current = current.appendChild (MakeElement (Skeleton_, Reader_)).toElement ();
+						break;
+					case QXmlStreamReader::EndElement:
+						current = current.parentNode ().toElement ();
+						break;
+					case QXmlStreamReader::Characters:
+						AppendCharacters (Skeleton_, current, Reader_);
+						break;
+					default:
+						break;
+					}
+
+				return !Reader_.hasError ();
+			}
+
+			bool HandleItem (QDomElement& parent)
+			{
+				// Items either belong to the last seen channel or are
+				// direct children of the root element (Atom, RSS 1.0),
+				// in which case they belong to the first one.
+				const auto channelIdx = parent == Root_ ? 0 : ChannelsCount_ - 1;
+				auto channelIdPos = ChannelIds_.find (channelIdx);
+				if (channelIdPos == ChannelIds_.end ())
+					channelIdPos = ChannelIds_.insert (channelIdx, Channel::CreateForFeed (Params_.FeedId_).ChannelID_);
+
+				const auto& itemElem = ReadSubtree (Skeleton_, parent, Reader_);
+				const auto& item = Parser_->ParseItem (itemElem, *channelIdPos);
+				item->Title_ = item->Title_.trimmed ().simplified ();
+
+				// Keep the first item of each channel, since the channels
+				// might need it (like RSS 2.0 ones for the last build date).
+				if (KeptItems_.contains (channelIdx))
+					parent.removeChild (itemElem);
+				else
+					KeptItems_ << channelIdx;
+
+				if (Params_.ItemHandler_)
+					Params_.ItemHandler_ (item);
+				else
+					Items_ [channelIdx] << item;
+
+				if (!item->PubDate_.isValid ())
+					return true;
+
+				// Stopping early is only safe for the feeds listing the items
+				// from the newest to the oldest ones, so the order of the
+				// items seen so far is checked as well.
+				if (LastPubDate_.isValid () && item->PubDate_ > LastPubDate_)
+					IsDescending_ = false;
+				LastPubDate_ = item->PubDate_;
+
+				if (!IsDescending_ || !Params_.KnownNewest_.isValid ())
+					return true;
+
+				if (item->PubDate_ < Params_.KnownNewest_)
+					return ++StaleItems_ < MaxStaleItems;
+
+				StaleItems_ = 0;
+				return true;
+			}
+
+			channels_container_t CollectChannels ()
+			{
+				auto channels = Parser_->ParseFeed (Skeleton_, Params_.FeedId_);
+				for (int i = 0; i < static_cast<int> (channels.size ()); ++i)
+				{
+					const auto& channel = channels [i];
+					channel->Items_.clear ();
+
+					if (!ChannelIds_.contains (i))
+						continue;
+
+					channel->ChannelID_ = ChannelIds_ [i];
+					channel->Items_ = Items_.take (i);
+				}
+
+				if (!Items_.isEmpty ())
+					qWarning () << Q_FUNC_INFO
+							<< "dropping the items of"
+							<< Items_.size ()
+							<< "unknown channels";
+
+				return channels;
+			}
+		};
+	}
+
+	StreamParser::Result_t StreamParser::Parse (QIODevice& device, const Params& params)
+	{
+		QXmlStreamReader reader { &device };
+		return StreamParseContext { params, reader } ();
+	}
+
+	StreamParser::Result_t StreamParser::Parse (const QByteArray& data, const Params& params)
+	{
+		QXmlStreamReader reader { data };
+		return StreamParseContext { params, reader } ();
+	}
+}
@@ -0,0 +1,91 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#pragma once
+
+#include <functional>
+#include <variant>
+#include <QDateTime>
+#include <util/sll/eitherfwd.h>
+#include "channel.h"
+
+class QIODevice;
+
+namespace LeechCraft::Aggregator
+{
+	/** @brief Parses feeds without building a DOM tree for the whole document.
+	 *
+	 * The document is read with QXmlStreamReader. Only the channel-level
+	 * elements and the item currently being parsed are kept as DOM
+	 * nodes, and the latter is dropped as soon as it is handed over to
+	 * Parser::ParseItem() of the format-specific parser. Thus the memory
+	 * usage doesn't depend on the number of items in the feed.
+	 *
+	 * The parser to use is selected by the ParserFactory, as usual.
+	 */
+	class StreamParser
+	{
+	public:
+		struct Params
+		{
+			IDType_t FeedId_;
+
+			/** @brief The publication date of the newest item already known.
+			 *
+			 * If it is valid, parsing stops after a few consecutive items
+			 * older than this date, provided that the items seen so far
+			 * are sorted from the newest to the oldest ones. Feeds with any
+			 * other order are always parsed completely.
+			 */
+			QDateTime KnownNewest_;
+
+			/** @brief The function to be invoked for each parsed item.
+			 *
+			 * If it is set, the items are passed to it as soon as they
+			 * are parsed and aren't added to the returned channels.
+			 */
+			std::function<void (Item_ptr)> ItemHandler_;
+		};
+
+		struct XmlError
+		{
+			QString Message_;
+			qint64 Line_;
+			qint64 Column_;
+		};
+
+		struct NoParserError {};
+
+		using Error_t = std::variant<XmlError, NoParserError>;
+		using Result_t = Util::Either<Error_t, channels_container_t>;
+
+		static Result_t Parse (QIODevice&, const Params&);
+		static Result_t Parse (const QByteArray&, const Params&);
+	};
+}
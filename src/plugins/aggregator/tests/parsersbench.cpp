@@ -0,0 +1,307 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#include "parsersbench.h"
+#include <QDir>
+#include <QDomDocument>
+#include <QtTest>
+#include <util/sll/either.h>
+#include "../parser.h"
+#include "../parserfactory.h"
+#include "../poolsmanager.h"
+#include "../streamparser.h"
+
+QTEST_GUILESS_MAIN (LeechCraft::Aggregator::ParsersBench)
+
+namespace LeechCraft::Aggregator
+{
+	// The real pools are reloaded from the storage, which isn't needed here.
+	PoolsManager& PoolsManager::Instance ()
+	{
+		static PoolsManager pm;
+		return pm;
+	}
+
+	Util::IDPool<IDType_t>& PoolsManager::GetPool (PoolType type)
+	{
+		return Pools_ [type];
+	}
+
+	namespace
+	{
+		const IDType_t FeedId = 1;
+
+		QByteArray MakePodcastFeed (int itemsCount, bool oldestFirst = false)
+		{
+			QByteArray result;
+			QTextStream str { &result };
+			str << R"(<?xml version="1.0" encoding="UTF-8"?>
+<rss version="2.0" xmlns:itunes="http://www.itunes.com/dtds/podcast-1.0.dtd" xmlns:content="http://purl.org/rss/1.0/modules/content/">
+<channel>
+<title>Generated podcast</title>
+<link>https://example.org/</link>
+<description>Lots of episodes.</description>
+)";
+			const auto& newest = QDateTime { QDate { 2020, 10, 1 }, QTime { 8, 0 }, Qt::UTC };
+			for (int pos = 0; pos < itemsCount; ++pos)
+			{
+				const auto i = oldestFirst ? itemsCount - 1 - pos : pos;
+				str << "<item><title>Episode " << itemsCount - i << "</title>"
+						<< "<link>https://example.org/" << itemsCount - i << "</link>"
+						<< "<guid>ep-" << itemsCount - i << "</guid>"
+						<< "<pubDate>" << newest.addDays (-i).toString (Qt::RFC2822Date) << "</pubDate>"
+						<< "<description>Episode description.</description>"
+						<< "<content:encoded><![CDATA[<p>Show notes with <b>markup</b>, <a href=\"https://example.org\">links</a> and "
+						<< QByteArray (1024, 'x') << ".</p>]]></content:encoded>"
+						<< "<itunes:duration>45:00</itunes:duration>"
+						<< "<enclosure url=\"https://example.org/" << i << ".mp3\" length=\"1000000\" type=\"audio/mpeg\" />"
+						<< "</item>\n";
+			}
+			str << "</channel></rss>";
+			str.flush ();
+			return result;
+		}
+
+		QByteArray MakeAtomFeed (int entriesCount)
+		{
+			QByteArray result;
+			QTextStream str { &result };
+			str << R"(<?xml version="1.0" encoding="utf-8"?>
+<feed xmlns="http://www.w3.org/2005/Atom">
+<title>Generated blog</title>
+<link href="https://example.org/" />
+<updated>2020-10-01T08:00:00Z</updated>
+)";
+			const auto& newest = QDateTime { QDate { 2020, 10, 1 }, QTime { 8, 0 }, Qt::UTC };
+			for (int i = 0; i < entriesCount; ++i)
+				str << "<entry><title>Post " << i << "</title>"
+						<< "<link href=\"https://example.org/" << i << "\" />"
+						<< "<id>post-" << i << "</id>"
+						<< "<updated>" << newest.addSecs (-3600 * i).toString (Qt::ISODate) << "</updated>"
+						<< "<content type=\"html\">&lt;p&gt;" << QByteArray (512, 'y') << "&lt;/p&gt;</content>"
+						<< "</entry>\n";
+			str << "</feed>";
+			str.flush ();
+			return result;
+		}
+
+		void LoadDir (QMap<QString, QByteArray>& feeds, const QString& path)
+		{
+			const QDir dir { path };
+			for (const auto& name : dir.entryList (QDir::Files))
+			{
+				QFile file { dir.filePath (name) };
+				if (file.open (QIODevice::ReadOnly))
+					feeds [name] = file.readAll ();
+			}
+		}
+
+		channels_container_t ParseDom (const QByteArray& data)
+		{
+			QDomDocument doc;
+			if (!doc.setContent (data, true))
+				return {};
+
+			const auto parser = ParserFactory::Instance ().Return (doc);
+			return parser ? parser->ParseFeed (doc, FeedId) : channels_container_t {};
+		}
+
+		channels_container_t ParseStream (const QByteArray& data, const QDateTime& knownNewest = {},
+				const std::function<void (Item_ptr)>& handler = {})
+		{
+			const auto& result = StreamParser::Parse (data, { FeedId, knownNewest, handler });
+			return result.IsRight () ? result.GetRight () : channels_container_t {};
+		}
+
+		QDateTime GetMedianDate (const channels_container_t& channels)
+		{
+			if (channels.empty () || channels.front ()->Items_.isEmpty ())
+				return {};
+
+			const auto& items = channels.front ()->Items_;
+			return items [items.size () / 2]->PubDate_;
+		}
+	}
+
+	void ParsersBench::initTestCase ()
+	{
+		ParserFactory::Instance ().RegisterDefaultParsers ();
+
+		LoadDir (Feeds_, AGGREGATOR_BENCH_CORPUS);
+		if (const auto& extra = qgetenv ("LC_AGGREGATOR_FEEDS_CORPUS"); !extra.isEmpty ())
+			LoadDir (Feeds_, QString::fromLocal8Bit (extra));
+
+		Feeds_ ["generated-podcast-2000.rss"] = MakePodcastFeed (2000);
+		Feeds_ ["generated-blog-5000.atom"] = MakeAtomFeed (5000);
+	}
+
+	namespace
+	{
+		void AddFeedRows (const QMap<QString, QByteArray>& feeds)
+		{
+			QTest::addColumn<QByteArray> ("data");
+
+			for (auto it = feeds.begin (); it != feeds.end (); ++it)
+				QTest::newRow (it.key ().toUtf8 ().constData ()) << it.value ();
+		}
+	}
+
+	void ParsersBench::testStreamMatchesDom_data ()
+	{
+		AddFeedRows (Feeds_);
+	}
+
+	void ParsersBench::testStreamMatchesDom ()
+	{
+		QFETCH (QByteArray, data);
+
+		const auto& dom = ParseDom (data);
+		const auto& stream = ParseStream (data);
+
+		QVERIFY (!dom.empty ());
+		QVERIFY (!dom.front ()->Items_.isEmpty ());
+		QCOMPARE (stream.size (), dom.size ());
+		for (size_t i = 0; i < dom.size (); ++i)
+		{
+			const auto& domChannel = *dom [i];
+			const auto& streamChannel = *stream [i];
+			QCOMPARE (streamChannel.Title_, domChannel.Title_);
+			QCOMPARE (streamChannel.Link_, domChannel.Link_);
+			QCOMPARE (streamChannel.LastBuild_, domChannel.LastBuild_);
+			QCOMPARE (streamChannel.Items_.size (), domChannel.Items_.size ());
+
+			for (int j = 0; j < domChannel.Items_.size (); ++j)
+			{
+				const auto& domItem = *domChannel.Items_ [j];
+				const auto& streamItem = *streamChannel.Items_ [j];
+				QCOMPARE (streamItem.ChannelID_, streamChannel.ChannelID_);
+				QCOMPARE (streamItem.Title_, domItem.Title_);
+				QCOMPARE (streamItem.Link_, domItem.Link_);
+				QCOMPARE (streamItem.Guid_, domItem.Guid_);
+				QCOMPARE (streamItem.Description_, domItem.Description_);
+				QCOMPARE (streamItem.Categories_, domItem.Categories_);
+				QCOMPARE (streamItem.Enclosures_.size (), domItem.Enclosures_.size ());
+				QCOMPARE (streamItem.MRSSEntries_.size (), domItem.MRSSEntries_.size ());
+				if (domItem.PubDate_.isValid ())
+					QCOMPARE (streamItem.PubDate_, domItem.PubDate_);
+			}
+		}
+	}
+
+	void ParsersBench::testStaleItemsStopParsing ()
+	{
+		const auto& data = MakePodcastFeed (100);
+		const auto& dom = ParseDom (data);
+		QCOMPARE (dom.size (), size_t { 1 });
+		const auto& domItems = dom.front ()->Items_;
+		QCOMPARE (domItems.size (), 100);
+
+		// Items 0 to 10 aren't older than the known newest one, and
+		// parsing stops after the third item older than that.
+		const auto& stream = ParseStream (data, domItems [10]->PubDate_);
+		QCOMPARE (stream.size (), size_t { 1 });
+
+		const auto& items = stream.front ()->Items_;
+		QCOMPARE (items.size (), 14);
+		for (int i = 0; i < items.size (); ++i)
+			QCOMPARE (items [i]->Guid_, domItems [i]->Guid_);
+	}
+
+	void ParsersBench::testAscendingFeedParsedFully ()
+	{
+		const auto& data = MakePodcastFeed (100, true);
+		const auto& dom = ParseDom (data);
+		QCOMPARE (dom.size (), size_t { 1 });
+		const auto& domItems = dom.front ()->Items_;
+		QCOMPARE (domItems.size (), 100);
+
+		const auto& stream = ParseStream (data, domItems [50]->PubDate_);
+		QCOMPARE (stream.size (), size_t { 1 });
+		QCOMPARE (stream.front ()->Items_.size (), domItems.size ());
+	}
+
+	void ParsersBench::testItemHandler ()
+	{
+		const auto& data = MakePodcastFeed (50);
+		const auto& dom = ParseDom (data);
+		QCOMPARE (dom.size (), size_t { 1 });
+		const auto& domItems = dom.front ()->Items_;
+
+		items_container_t handled;
+		const auto& stream = ParseStream (data, {}, [&handled] (const Item_ptr& item) { handled << item; });
+		QCOMPARE (stream.size (), size_t { 1 });
+		QVERIFY (stream.front ()->Items_.isEmpty ());
+
+		QCOMPARE (handled.size (), domItems.size ());
+		for (int i = 0; i < handled.size (); ++i)
+		{
+			QCOMPARE (handled [i]->ChannelID_, stream.front ()->ChannelID_);
+			QCOMPARE (handled [i]->Guid_, domItems [i]->Guid_);
+			QCOMPARE (handled [i]->Title_, domItems [i]->Title_);
+		}
+	}
+
+	void ParsersBench::benchDom_data ()
+	{
+		AddFeedRows (Feeds_);
+	}
+
+	void ParsersBench::benchDom ()
+	{
+		QFETCH (QByteArray, data);
+
+		QBENCHMARK { ParseDom (data); }
+	}
+
+	void ParsersBench::benchStream_data ()
+	{
+		AddFeedRows (Feeds_);
+	}
+
+	void ParsersBench::benchStream ()
+	{
+		QFETCH (QByteArray, data);
+
+		QBENCHMARK { ParseStream (data); }
+	}
+
+	void ParsersBench::benchStreamKnownHalf_data ()
+	{
+		AddFeedRows (Feeds_);
+	}
+
+	void ParsersBench::benchStreamKnownHalf ()
+	{
+		QFETCH (QByteArray, data);
+
+		const auto& knownNewest = GetMedianDate (ParseDom (data));
+
+		QBENCHMARK { ParseStream (data, knownNewest); }
+	}
+}
@@ -0,0 +1,69 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#pragma once
+
+#include <QObject>
+#include <QMap>
+
+namespace LeechCraft::Aggregator
+{
+	/** @brief Compares the DOM-based and the streaming feed parsers.
+	 *
+	 * The corpus consists of the feeds in the \c tests/data directory,
+	 * a couple of generated large feeds and, optionally, the feeds in
+	 * the directory pointed to by the \c LC_AGGREGATOR_FEEDS_CORPUS
+	 * environment variable, which is handy for benchmarking on a dump
+	 * of real subscriptions.
+	 */
+	class ParsersBench : public QObject
+	{
+		Q_OBJECT
+
+		QMap<QString, QByteArray> Feeds_;
+	private slots:
+		void initTestCase ();
+
+		void testStreamMatchesDom_data ();
+		void testStreamMatchesDom ();
+
+		void testStaleItemsStopParsing ();
+		void testAscendingFeedParsedFully ();
+		void testItemHandler ();
+
+		void benchDom_data ();
+		void benchDom ();
+
+		void benchStream_data ();
+		void benchStream ();
+
+		void benchStreamKnownHalf_data ();
+		void benchStreamKnownHalf ();
+	};
+}
@@ -28,8 +28,13 @@
  **********************************************************************/
 
 #include "updatesmanager.h"
+#include <algorithm>
 #include <QDateTime>
 #include <QDomDocument>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QSettings>
+#include <QCoreApplication>
 #include <QTimer>
 #include <interfaces/idownload.h>
 #include <interfaces/core/ientitymanager.h>
@@ -43,6 +48,7 @@
 #include "dbupdatethreadworker.h"
 #include "parser.h"
 #include "parserfactory.h"
+#include "streamparser.h"
 #include "storagebackend.h"
 #include "storagebackendmanager.h"
 #include "xmlsettingsmanager.h"
@@ -54,24 +60,22 @@ namespace LeechCraft::Aggregator
 	{
 		using ParseResult = Util::Either<QString, channels_container_t>;
 
-		ParseResult ParseChannels (const QString& path, const QString& url, IDType_t feedId)
+		QString SaveFailedCopy (const QByteArray& data)
 		{
-			QFile file { path };
-			if (!file.open (QIODevice::ReadOnly))
-			{
-				qWarning () << Q_FUNC_INFO
-						<< "unable to open the local file"
-						<< path;
-				return ParseResult::Left (UpdatesManager::tr ("Unable to open the temporary file."));
-			}
+			const auto& copyPath = Util::GetTemporaryName ("lc_aggregator_failed.XXXXXX");
+			QFile copy { copyPath };
+			if (copy.open (QIODevice::WriteOnly))
+				copy.write (data);
+			return copyPath;
+		}
 
+		ParseResult ParseChannelsDom (const QByteArray& data, const QString& url, IDType_t feedId)
+		{
 			QDomDocument doc;
 			QString errorMsg;
 			int errorLine, errorColumn;
-			if (!doc.setContent (&file, true, &errorMsg, &errorLine, &errorColumn))
+			if (!doc.setContent (data, true, &errorMsg, &errorLine, &errorColumn))
 			{
-				const auto& copyPath = Util::GetTemporaryName ("lc_aggregator_failed.XXXXXX");
-				file.copy (copyPath);
 				qWarning () << Q_FUNC_INFO
 						<< "error parsing XML for"
 						<< url
@@ -79,7 +83,7 @@ namespace LeechCraft::Aggregator
 						<< errorLine
 						<< errorColumn
 						<< "; copy at"
-						<< file.fileName ();
+						<< SaveFailedCopy (data);
 				return ParseResult::Left (UpdatesManager::tr ("XML parse error for the feed %1.")
 						.arg (url));
 			}
@@ -87,137 +91,421 @@ namespace LeechCraft::Aggregator
 			auto parser = ParserFactory::Instance ().Return (doc);
 			if (!parser)
 			{
-				const auto& copyPath = Util::GetTemporaryName ("lc_aggregator_failed.XXXXXX");
-				file.copy (copyPath);
 				qWarning () << Q_FUNC_INFO
 						<< "no parser for"
 						<< url
 						<< "; copy at"
-						<< copyPath;
+						<< SaveFailedCopy (data);
 				return ParseResult::Left (UpdatesManager::tr ("Could not find parser to parse %1.")
 						.arg (url));
 			}
 
 			return ParseResult::Right (parser->ParseFeed (doc, feedId));
 		}
+
+		ParseResult ParseChannelsStream (const QByteArray& data, const QString& url,
+				IDType_t feedId, const QDateTime& knownNewest)
+		{
+			const auto& result = StreamParser::Parse (data, { feedId, knownNewest, {} });
+			if (result.IsRight ())
+				return ParseResult::Right (result.GetRight ());
+
+			return Util::Visit (result.GetLeft (),
+					[&] (const StreamParser::XmlError& error)
+					{
+						qWarning () << Q_FUNC_INFO
+								<< "error parsing XML for"
+								<< url
+								<< error.Message_
+								<< error.Line_
+								<< error.Column_
+								<< "; copy at"
+								<< SaveFailedCopy (data);
+						return ParseResult::Left (UpdatesManager::tr ("XML parse error for the feed %1.")
+								.arg (url));
+					},
+					[&] (StreamParser::NoParserError)
+					{
+						qWarning () << Q_FUNC_INFO
+								<< "no parser for"
+								<< url
+								<< "; copy at"
+								<< SaveFailedCopy (data);
+						return ParseResult::Left (UpdatesManager::tr ("Could not find parser to parse %1.")
+								.arg (url));
+					});
+		}
+
+		int GetSetting (const char *name, int min)
+		{
+			return std::max (XmlSettingsManager::Instance ()->property (name).toInt (), min);
+		}
+
+		/** Returns the update interval of the given feed in seconds,
+		 * or 0 if the feed shouldn't be updated automatically.
+		 */
+		qint64 GetUpdateInterval (const StorageBackend& sb, IDType_t id, int globalMins)
+		{
+			using Util::operator*;
+
+			const auto custom = (sb.GetFeedSettings (id) * &Feed::FeedSettings::UpdateTimeout_).value_or (0);
+			return (custom ? custom : globalMins) * 60;
+		}
+
+		/** Spreads the given interval by ±10% so that the feeds added
+		 * or updated together don't keep hitting the network together.
+		 */
+		qint64 Jitter (qint64 secs)
+		{
+			const auto spread = secs / 10;
+			if (!spread)
+				return secs;
+			return secs - spread + qrand () % (2 * spread + 1);
+		}
+
+		qint64 GetBackoff (qint64 interval, int failures)
+		{
+			const qint64 maxBackoff = std::max<qint64> (interval, 24 * 60 * 60);
+			return std::min (interval << std::min (failures, 8), maxBackoff);
+		}
+
+		struct Validators
+		{
+			QByteArray ETag_;
+			QByteArray LastModified_;
+		};
+
+		class ValidatorsStorage
+		{
+			QSettings Settings_;
+		public:
+			ValidatorsStorage ()
+			: Settings_ { QCoreApplication::organizationName (), QCoreApplication::applicationName () + "_Aggregator" }
+			{
+				Settings_.beginGroup ("FetchValidators");
+			}
+
+			Validators Load (IDType_t id) const
+			{
+				const auto& prefix = QString::number (id) + '/';
+				return
+				{
+					Settings_.value (prefix + "ETag").toByteArray (),
+					Settings_.value (prefix + "LastModified").toByteArray ()
+				};
+			}
+
+			void Save (IDType_t id, const Validators& validators)
+			{
+				if (validators.ETag_.isEmpty () && validators.LastModified_.isEmpty ())
+				{
+					Settings_.remove (QString::number (id));
+					return;
+				}
+
+				const auto& prefix = QString::number (id) + '/';
+				Settings_.setValue (prefix + "ETag", validators.ETag_);
+				Settings_.setValue (prefix + "LastModified", validators.LastModified_);
+			}
+		};
+
+		IDownload::Error::Type GetErrorType (QNetworkReply::NetworkError error)
+		{
+			switch (error)
+			{
+			case QNetworkReply::NoError:
+				return IDownload::Error::Type::NoError;
+			case QNetworkReply::HostNotFoundError:
+			case QNetworkReply::ContentNotFoundError:
+				return IDownload::Error::Type::NotFound;
+			case QNetworkReply::ContentGoneError:
+				return IDownload::Error::Type::Gone;
+			case QNetworkReply::ContentAccessDenied:
+				return IDownload::Error::Type::AccessDenied;
+			case QNetworkReply::AuthenticationRequiredError:
+				return IDownload::Error::Type::AuthRequired;
+			default:
+				break;
+			}
+
+			// See the QNetworkReply::NetworkError docs for the ranges.
+			if (error < QNetworkReply::ProxyConnectionRefusedError)
+				return IDownload::Error::Type::NetworkError;
+			if (error < QNetworkReply::ContentAccessDenied)
+				return IDownload::Error::Type::ProxyError;
+			if (error < QNetworkReply::ProtocolUnknownError)
+				return IDownload::Error::Type::ContentError;
+			if (error < QNetworkReply::InternalServerError)
+				return IDownload::Error::Type::ProtocolError;
+			if (error < QNetworkReply::UnknownNetworkError)
+				return IDownload::Error::Type::ServerError;
+			return IDownload::Error::Type::Unknown;
+		}
 	}
 
 	UpdatesManager::UpdatesManager (const InitParams& initParams, QObject *parent)
 	: QObject { parent }
 	, EntityManager_ { initParams.EntityManager_ }
+	, NAM_ { initParams.NAM_ }
 	, DBUpThread_ { initParams.DBUpThread_ }
 	, FeedsErrorManager_ { initParams.FeedsErrorManager_ }
 	, StorageBackend_ { StorageBackendManager::Instance ().MakeStorageBackendForThread () }
-	, UpdateTimer_ { new QTimer { this } }
-	, CustomUpdateTimer_ { new QTimer { this } }
+	, ScheduleTimer_ { new QTimer { this } }
 	{
 		ParserFactory::Instance ().RegisterDefaultParsers ();
 
-		UpdateTimer_->setSingleShot (true);
-		connect (UpdateTimer_,
+		ScheduleInitial ();
+
+		ScheduleTimer_->start (60 * 1000);
+		connect (ScheduleTimer_,
 				&QTimer::timeout,
 				this,
-				&UpdatesManager::UpdateFeeds);
+				&UpdatesManager::HandleScheduleTimer);
 
-		CustomUpdateTimer_->start (60 * 1000);
-		connect (CustomUpdateTimer_,
-				&QTimer::timeout,
+		connect (&StorageBackendManager::Instance (),
+				&StorageBackendManager::feedRemoved,
 				this,
-				&UpdatesManager::HandleCustomUpdates);
+				[] (IDType_t feedId) { ValidatorsStorage {}.Save (feedId, {}); });
 
-		auto now = QDateTime::currentDateTime ();
-		auto lastUpdated = XmlSettingsManager::Instance ()->Property ("LastUpdateDateTime", now).toDateTime ();
-		if (auto interval = XmlSettingsManager::Instance ()->property ("UpdateInterval").toInt ())
+		XmlSettingsManager::Instance ()->RegisterObject ("UpdateInterval", this, "updateIntervalChanged");
+
+		XmlSettingsManager::Instance ()->RegisterObject ("StreamingFeedParser", this,
+				[] (const QVariant& value) { ParserFactory::Instance ().SetStreaming (value.toBool ()); });
+	}
+
+	void UpdatesManager::UpdateFeeds ()
+	{
+		for (const auto id : StorageBackend_->GetFeedsIDs ())
+			UpdateFeed (id);
+
+		XmlSettingsManager::Instance ()->setProperty ("LastUpdateDateTime", QDateTime::currentDateTime ());
+	}
+
+	void UpdatesManager::UpdateFeed (IDType_t id)
+	{
+		if (Queued_.contains (id) || InFlight_.contains (id))
+			return;
+
+		QString url;
+		try
 		{
-			auto updateDiff = lastUpdated.secsTo (now);
-			if (XmlSettingsManager::Instance ()->property ("UpdateOnStartup").toBool () ||
-					updateDiff > interval * 60)
-				QTimer::singleShot (7000,
-						this,
-						&UpdatesManager::UpdateFeeds);
-			else
-				UpdateTimer_->start (updateDiff * 1000);
+			url = StorageBackend_->GetFeed (id).URL_;
+		}
+		catch (const StorageBackend::FeedNotFoundError&)
+		{
+			NextUpdates_.remove (id);
+			return;
 		}
 
-		XmlSettingsManager::Instance ()->RegisterObject ("UpdateInterval", this, "updateIntervalChanged");
+		UpdatesQueue_.append ({ id, url });
+		Queued_ << id;
+
+		SchedulePump ();
 	}
 
-	void UpdatesManager::UpdateFeeds ()
+	void UpdatesManager::ScheduleInitial ()
 	{
+		const auto& now = QDateTime::currentDateTime ();
+
+		const auto globalMins = XmlSettingsManager::Instance ()->property ("UpdateInterval").toInt ();
+		const auto& lastUpdated = XmlSettingsManager::Instance ()->Property ("LastUpdateDateTime", now).toDateTime ();
+		const bool isGlobalDue = XmlSettingsManager::Instance ()->property ("UpdateOnStartup").toBool () ||
+				lastUpdated.secsTo (now) > globalMins * 60;
+
 		for (const auto id : StorageBackend_->GetFeedsIDs ())
 		{
-			// It's handled by custom timer.
-			if (StorageBackend_->GetFeedSettings (id).value_or (Feed::FeedSettings {}).UpdateTimeout_)
+			const auto interval = GetUpdateInterval (*StorageBackend_, id, 0);
+			if (interval)
+				NextUpdates_ [id] = now.addSecs (Jitter (60));
+			else if (globalMins)
+				NextUpdates_ [id] = isGlobalDue ?
+						now.addSecs (7) :
+						lastUpdated.addSecs (Jitter (globalMins * 60));
+		}
+	}
+
+	void UpdatesManager::HandleScheduleTimer ()
+	{
+		const auto& now = QDateTime::currentDateTime ();
+		const auto globalMins = XmlSettingsManager::Instance ()->property ("UpdateInterval").toInt ();
+
+		QHash<IDType_t, QDateTime> nextUpdates;
+		bool hasGlobalDue = false;
+		for (const auto id : StorageBackend_->GetFeedsIDs ())
+		{
+			const auto interval = GetUpdateInterval (*StorageBackend_, id, globalMins);
+			if (!interval)
+				continue;
+
+			const auto pos = NextUpdates_.find (id);
+			if (pos == NextUpdates_.end ())
+			{
+				nextUpdates [id] = now.addSecs (Jitter (interval));
+				continue;
+			}
+
+			nextUpdates [id] = *pos;
+			if (*pos > now)
 				continue;
 
 			UpdateFeed (id);
+			hasGlobalDue = hasGlobalDue || interval == globalMins * 60;
 		}
 
-		XmlSettingsManager::Instance ()->setProperty ("LastUpdateDateTime", QDateTime::currentDateTime ());
-		if (int interval = XmlSettingsManager::Instance ()->property ("UpdateInterval").toInt ())
-			UpdateTimer_->start (interval * 60 * 1000);
+		NextUpdates_ = std::move (nextUpdates);
+
+		if (hasGlobalDue)
+			XmlSettingsManager::Instance ()->setProperty ("LastUpdateDateTime", now);
 	}
 
-	void UpdatesManager::UpdateFeed (IDType_t id)
+	void UpdatesManager::RescheduleFeed (IDType_t id, bool failed)
 	{
-		if (UpdatesQueue_.isEmpty ())
-			QTimer::singleShot (500,
-					this,
-					&UpdatesManager::RotateUpdatesQueue);
+		const auto failures = failed ? ++FailuresCount_ [id] : 0;
+		if (!failed)
+			FailuresCount_.remove (id);
 
-		UpdatesQueue_ << id;
+		const auto globalMins = XmlSettingsManager::Instance ()->property ("UpdateInterval").toInt ();
+		const auto interval = GetUpdateInterval (*StorageBackend_, id, globalMins);
+		if (!interval)
+		{
+			NextUpdates_.remove (id);
+			return;
+		}
+
+		NextUpdates_ [id] = QDateTime::currentDateTime ().addSecs (Jitter (GetBackoff (interval, failures)));
 	}
 
 	void UpdatesManager::updateIntervalChanged ()
 	{
-		if (int min = XmlSettingsManager::Instance ()->property ("UpdateInterval").toInt ())
+		const auto globalMins = XmlSettingsManager::Instance ()->property ("UpdateInterval").toInt ();
+		const auto& now = QDateTime::currentDateTime ();
+
+		for (auto it = NextUpdates_.begin (); it != NextUpdates_.end (); )
 		{
-			if (UpdateTimer_->isActive ())
-				UpdateTimer_->setInterval (min * 60 * 1000);
+			if (GetUpdateInterval (*StorageBackend_, it.key (), 0))
+			{
+				++it;
+				continue;
+			}
+
+			if (!globalMins)
+				it = NextUpdates_.erase (it);
 			else
-				UpdateTimer_->start (min * 60 * 1000);
+			{
+				*it = now.addSecs (Jitter (GetBackoff (globalMins * 60, FailuresCount_.value (it.key ()))));
+				++it;
+			}
 		}
-		else
-			UpdateTimer_->stop ();
 	}
 
-	void UpdatesManager::HandleCustomUpdates ()
+	void UpdatesManager::SchedulePump ()
 	{
-		using Util::operator*;
+		if (IsPumpScheduled_)
+			return;
 
-		QDateTime current = QDateTime::currentDateTime ();
-		for (const auto id : StorageBackend_->GetFeedsIDs ())
-		{
-			const auto ut = (StorageBackend_->GetFeedSettings (id) * &Feed::FeedSettings::UpdateTimeout_).value_or (0);
+		IsPumpScheduled_ = true;
+		QTimer::singleShot (0,
+				this,
+				&UpdatesManager::PumpQueue);
+	}
 
-			// It's handled by normal timer.
-			if (!ut)
-				continue;
+	void UpdatesManager::PumpQueue ()
+	{
+		IsPumpScheduled_ = false;
 
-			if (!Updates_.contains (id) ||
-					(Updates_ [id].isValid () &&
-						Updates_ [id].secsTo (current) / 60 > ut))
+		const auto maxInFlight = GetSetting ("MaxConcurrentFetches", 1);
+		const auto maxPerHost = GetSetting ("MaxFetchesPerHost", 1);
+
+		for (auto it = UpdatesQueue_.begin ();
+				it != UpdatesQueue_.end () && InFlight_.size () < maxInFlight; )
+		{
+			const auto& host = QUrl { it->URL_ }.host ();
+			if (HostInFlight_.value (host) >= maxPerHost)
 			{
-				UpdateFeed (id);
-				Updates_ [id] = QDateTime::currentDateTime ();
+				++it;
+				continue;
 			}
+
+			const auto fetch = *it;
+			it = UpdatesQueue_.erase (it);
+			Queued_.remove (fetch.FeedId_);
+
+			StartFetch (fetch, host);
 		}
 	}
 
-	void UpdatesManager::RotateUpdatesQueue ()
+	void UpdatesManager::StartFetch (const PendingFetch& fetch, const QString& host)
 	{
-		if (UpdatesQueue_.isEmpty ())
-			return;
+		InFlight_ [fetch.FeedId_] = host;
+		++HostInFlight_ [host];
+
+		const auto& scheme = QUrl { fetch.URL_ }.scheme ();
+		if (NAM_ && (scheme == "http" || scheme == "https"))
+			FetchDirectly (fetch.FeedId_, fetch.URL_);
+		else
+			FetchDelegated (fetch.FeedId_, fetch.URL_);
+	}
 
-		const auto feedId = UpdatesQueue_.takeFirst ();
+	void UpdatesManager::FetchDirectly (IDType_t feedId, const QString& url)
+	{
+		const auto& validators = ValidatorsStorage {}.Load (feedId);
 
-		if (!UpdatesQueue_.isEmpty ())
-			QTimer::singleShot (2000,
-					this,
-					&UpdatesManager::RotateUpdatesQueue);
+		QNetworkRequest req { QUrl { url } };
+		req.setAttribute (QNetworkRequest::FollowRedirectsAttribute, true);
+		// We handle the conditional requests ourselves, don't let the cache interfere.
+		req.setAttribute (QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::AlwaysNetwork);
+		req.setAttribute (QNetworkRequest::CacheSaveControlAttribute, false);
+		if (!validators.ETag_.isEmpty ())
+			req.setRawHeader ("If-None-Match", validators.ETag_);
+		if (!validators.LastModified_.isEmpty ())
+			req.setRawHeader ("If-Modified-Since", validators.LastModified_);
 
-		const auto& url = StorageBackend_->GetFeed (feedId).URL_;
+		const auto reply = NAM_->get (req);
+
+		const auto timedOut = std::make_shared<bool> (false);
+		QTimer::singleShot (GetSetting ("FetchTimeout", 5) * 1000,
+				reply,
+				[reply, timedOut]
+				{
+					*timedOut = true;
+					reply->abort ();
+				});
+
+		connect (reply,
+				&QNetworkReply::finished,
+				this,
+				[=]
+				{
+					reply->deleteLater ();
+
+					const auto status = reply->attribute (QNetworkRequest::HttpStatusCodeAttribute).toInt ();
+					if (status == 304)
+					{
+						FeedsErrorManager_->ClearFeedErrors (feedId);
+						FinishFetch (feedId, false);
+						return;
+					}
+
+					if (const auto error = reply->error ())
+					{
+						const auto& message = *timedOut ?
+								tr ("Timed out fetching %1.").arg (url) :
+								reply->errorString ();
+						FeedsErrorManager_->AddFeedError (feedId, IDownload::Error { GetErrorType (error), message });
+						FinishFetch (feedId, true);
+						return;
+					}
+
+					// Saving the validators before the items are stored would lose the items if storing fails.
+					const Validators newValidators { reply->rawHeader ("ETag"), reply->rawHeader ("Last-Modified") };
+					const bool ok = HandleFetched (feedId, url, reply->readAll (),
+							[feedId, newValidators] { ValidatorsStorage {}.Save (feedId, newValidators); });
+					FinishFetch (feedId, !ok);
+				});
+	}
 
+	void UpdatesManager::FetchDelegated (IDType_t feedId, const QString& url)
+	{
 		auto filename = Util::GetTemporaryName ();
 
 		auto e = Util::MakeEntity (QUrl (url),
@@ -228,16 +516,14 @@ namespace LeechCraft::Aggregator
 					NotPersistent |
 					DoNotAnnounceEntity);
 
-		auto emitError = [this] (const QString& body)
-		{
-			EntityManager_->HandleEntity (Util::MakeNotification (tr ("Feed error"), body, Priority::Critical));
-		};
-
 		const auto& delegateResult = EntityManager_->DelegateEntity (e);
 		if (!delegateResult)
 		{
-			emitError (tr ("Could not find plugin for feed with URL %1")
-					.arg (url));
+			EntityManager_->HandleEntity (Util::MakeNotification (tr ("Feed error"),
+					tr ("Could not find plugin for feed with URL %1")
+						.arg (url),
+					Priority::Critical));
+			FinishFetch (feedId, true);
 			return;
 		}
 
@@ -246,18 +532,64 @@ namespace LeechCraft::Aggregator
 				{
 					[=] (IDownload::Success)
 					{
-						Util::Visit (ParseChannels (filename, url, feedId),
-								[&] (const channels_container_t& channels)
-								{
-									FeedsErrorManager_->ClearFeedErrors (feedId);
-									DBUpThread_->ScheduleImpl (&DBUpdateThreadWorker::updateFeed, channels, url);
-								},
-								[&] (const QString& error)
-								{
-									FeedsErrorManager_->AddFeedError (feedId, FeedsErrorManager::ParseError { error });
-								});
+						QFile file { filename };
+						if (!file.open (QIODevice::ReadOnly))
+						{
+							qWarning () << Q_FUNC_INFO
+									<< "unable to open the local file"
+									<< filename;
+							FeedsErrorManager_->AddFeedError (feedId,
+									FeedsErrorManager::ParseError { tr ("Unable to open the temporary file.") });
+							FinishFetch (feedId, true);
+							return;
+						}
+
+						FinishFetch (feedId, !HandleFetched (feedId, url, file.readAll ()));
 					},
-					[=] (const IDownload::Error& error) { FeedsErrorManager_->AddFeedError (feedId, error); }
+					[=] (const IDownload::Error& error)
+					{
+						FeedsErrorManager_->AddFeedError (feedId, error);
+						FinishFetch (feedId, true);
+					}
 				}.Finally ([filename] { QFile::remove (filename); });
 	}
+
+	bool UpdatesManager::HandleFetched (IDType_t feedId, const QString& url, const QByteArray& data,
+			const std::function<void ()>& onStored)
+	{
+		const auto& parseResult = ParserFactory::Instance ().IsStreaming () ?
+				ParseChannelsStream (data, url, feedId, StorageBackend_->GetNewestItemDate (feedId)) :
+				ParseChannelsDom (data, url, feedId);
+		return Util::Visit (parseResult,
+				[&] (const channels_container_t& channels)
+				{
+					FeedsErrorManager_->ClearFeedErrors (feedId);
+					// Let the user-initiated DB updates go ahead of the feed storms.
+					const auto& stored = DBUpThread_->ScheduleImpl ({ Util::TaskPriority::Low },
+							&DBUpdateThreadWorker::updateFeed, channels, url);
+					if (onStored)
+						Util::Sequence (this, stored) >>
+								[onStored] (bool ok)
+								{
+									if (ok)
+										onStored ();
+								};
+					return true;
+				},
+				[&] (const QString& error)
+				{
+					FeedsErrorManager_->AddFeedError (feedId, FeedsErrorManager::ParseError { error });
+					return false;
+				});
+	}
+
+	void UpdatesManager::FinishFetch (IDType_t feedId, bool failed)
+	{
+		const auto& host = InFlight_.take (feedId);
+		if (!--HostInFlight_ [host])
+			HostInFlight_.remove (host);
+
+		RescheduleFeed (feedId, failed);
+		SchedulePump ();
+	}
 }
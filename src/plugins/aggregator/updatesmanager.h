@@ -29,12 +29,17 @@
 
 #pragma once
 
+#include <functional>
 #include <memory>
 #include <QObject>
+#include <QHash>
+#include <QSet>
+#include <QDateTime>
 #include "common.h"
 #include "dbupdatethread.h"
 
 class QTimer;
+class QNetworkAccessManager;
 
 class IEntityManager;
 
@@ -48,31 +53,63 @@ namespace LeechCraft::Aggregator
 		Q_OBJECT
 
 		IEntityManager * const EntityManager_;
+		QNetworkAccessManager * const NAM_;
 
 		const DBUpdateThread_ptr DBUpThread_;
 		const std::shared_ptr<FeedsErrorManager> FeedsErrorManager_;
 		const std::shared_ptr<StorageBackend> StorageBackend_;
 
-		QTimer * const UpdateTimer_;
-		QTimer * const CustomUpdateTimer_;
+		QTimer * const ScheduleTimer_;
 
-		QList<IDType_t> UpdatesQueue_;
-		QMap<IDType_t, QDateTime> Updates_;
+		struct PendingFetch
+		{
+			IDType_t FeedId_;
+			QString URL_;
+		};
+		QList<PendingFetch> UpdatesQueue_;
+		QSet<IDType_t> Queued_;
+
+		QHash<IDType_t, QDateTime> NextUpdates_;
+		QHash<IDType_t, int> FailuresCount_;
+
+		QHash<IDType_t, QString> InFlight_;
+		QHash<QString, int> HostInFlight_;
+
+		bool IsPumpScheduled_ = false;
 	public:
 		struct InitParams
 		{
 			const DBUpdateThread_ptr DBUpThread_;
 			const std::shared_ptr<FeedsErrorManager>& FeedsErrorManager_;
 			IEntityManager *EntityManager_;
+			QNetworkAccessManager *NAM_;
 		};
 		explicit UpdatesManager (const InitParams&, QObject* = nullptr);
 
+		/** @brief Queues the given feed for an immediate update.
+		 *
+		 * The feed is fetched as soon as the global and per-host
+		 * concurrency limits allow. Does nothing if the feed is
+		 * already queued or being fetched.
+		 */
 		void UpdateFeed (IDType_t);
 
+		/** @brief Queues all the feeds for an immediate update.
+		 */
 		void UpdateFeeds ();
 	private:
-		void HandleCustomUpdates ();
-		void RotateUpdatesQueue ();
+		void ScheduleInitial ();
+		void HandleScheduleTimer ();
+		void RescheduleFeed (IDType_t, bool failed);
+
+		void SchedulePump ();
+		void PumpQueue ();
+
+		void StartFetch (const PendingFetch&, const QString&);
+		void FetchDirectly (IDType_t, const QString&);
+		void FetchDelegated (IDType_t, const QString&);
+		bool HandleFetched (IDType_t, const QString&, const QByteArray&, const std::function<void ()>& onStored = {});
+		void FinishFetch (IDType_t, bool failed);
 	private slots:
 		void updateIntervalChanged ();
 	};
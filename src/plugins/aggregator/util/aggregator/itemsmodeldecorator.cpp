@@ -50,6 +50,14 @@ namespace Aggregator
 				Q_ARG (IDType_t, feedId));
 	}
 
+	void ItemsModelDecorator::ResetItems (const QList<IDType_t>& items)
+	{
+		QMetaObject::invokeMethod (Model_,
+				"resetItems",
+				Qt::QueuedConnection,
+				Q_ARG (QList<IDType_t>, items));
+	}
+
 	void ItemsModelDecorator::Selected (const QModelIndex& index)
 	{
 		QMetaObject::invokeMethod (Model_,
@@ -44,6 +44,7 @@ namespace Aggregator
 		ItemsModelDecorator (QObject*);
 
 		void Reset (IDType_t, IDType_t);
+		void ResetItems (const QList<IDType_t>&);
 		void Selected (const QModelIndex&);
 	};
 }
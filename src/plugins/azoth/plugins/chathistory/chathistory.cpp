@@ -97,6 +97,7 @@ namespace ChatHistory
 
 	void Plugin::Release ()
 	{
+		StorageMgr_->FlushSync ();
 	}
 
 	QString Plugin::GetName () const
@@ -255,7 +255,7 @@ namespace ChatHistory
 	}
 
 	void ChatHistoryWidget::HandleGotChatLogs (const QString& accountId,
-			const QString& entryId, const ChatLogsResult_t& result)
+			const QString& entryId, const ChatLogsPageResult_t& result)
 	{
 		const auto& selEntry = Ui_.Contacts_->selectionModel ()->
 				currentIndex ().data (MRIDRole).toString ();
@@ -264,7 +264,6 @@ namespace ChatHistory
 				entryId != selEntry)
 			return;
 
-		Amount_ = 0;
 		Ui_.HistView_->clear ();
 
 		auto& formatter = Params_.PluginProxy_->GetFormatterProxy ();
@@ -298,7 +297,13 @@ namespace ChatHistory
 
 		int scrollPos = -1;
 
-		for (const auto& logItem : result.GetRight ())
+		const auto& page = result.GetRight ();
+		ShownFirstSeq_ = page.FirstSeq_;
+		ShownLastSeq_ = page.FirstSeq_ + page.Items_.size () - 1;
+		ShownTotal_ = page.Total_;
+
+		auto seq = page.FirstSeq_;
+		for (const auto& logItem : page.Items_)
 		{
 			const bool isChat = logItem.Type_ == IMessage::Type::ChatMessage;
 			const bool isIncoming = logItem.Dir_ == IMessage::Direction::In;
@@ -352,7 +357,7 @@ namespace ChatHistory
 
 			html += postNick + ' ' + msgText;
 
-			const bool isSearchRes = SearchResultPosition_ == PerPageAmount_ - ++Amount_;
+			const bool isSearchRes = HighlightSeq_ && seq++ == HighlightSeq_;
 			if (isChat && !isSearchRes)
 			{
 				const auto& color = formatter.GetNickColor (isIncoming ? remoteName : ourName, colors);
@@ -394,9 +399,9 @@ namespace ChatHistory
 			return;
 		}
 
-		const auto position = result.GetRight ();
+		const auto seq = result.GetRight ();
 
-		if (!position)
+		if (!seq)
 		{
 			if (!(FindBox_->GetFlags () & ChatFindBox::FindWrapsAround) || !SearchShift_)
 				QMessageBox::warning (this,
@@ -446,8 +451,8 @@ namespace ChatHistory
 				}
 		}
 
-		Backpages_ = *position / PerPageAmount_;
-		SearchResultPosition_ = *position % PerPageAmount_;
+		HighlightSeq_ = *seq;
+		PageLastSeq_ = *seq + PerPageAmount_ / 2;
 		RequestLogs ();
 	}
 
@@ -495,8 +500,8 @@ namespace ChatHistory
 		{
 			SearchShift_ = 0;
 			PreviousSearchText_.clear ();
-			Backpages_ = 0;
-			SearchResultPosition_ = -1;
+			PageLastSeq_ = 0;
+			HighlightSeq_ = 0;
 		}
 		ContactSelectedAsGlobSearch_ = false;
 
@@ -534,8 +539,8 @@ namespace ChatHistory
 		if (text.isEmpty ())
 		{
 			PreviousSearchText_.clear ();
-			Backpages_ = 0;
-			SearchResultPosition_ = -1;
+			PageLastSeq_ = 0;
+			HighlightSeq_ = 0;
 			RequestLogs ();
 			return;
 		}
@@ -555,21 +560,21 @@ namespace ChatHistory
 
 	void ChatHistoryWidget::previousHistory ()
 	{
-		if (Amount_ < PerPageAmount_)
+		if (ShownFirstSeq_ <= 1)
 			return;
 
-		++Backpages_;
-		SearchResultPosition_ = -1;
+		PageLastSeq_ = ShownFirstSeq_ - 1;
+		HighlightSeq_ = 0;
 		RequestLogs ();
 	}
 
 	void ChatHistoryWidget::nextHistory ()
 	{
-		if (Backpages_ <= 0)
+		if (ShownLastSeq_ >= ShownTotal_)
 			return;
 
-		--Backpages_;
-		SearchResultPosition_ = -1;
+		PageLastSeq_ = ShownLastSeq_ + PerPageAmount_;
+		HighlightSeq_ = 0;
 		RequestLogs ();
 	}
 
@@ -594,7 +599,8 @@ namespace ChatHistory
 			ContactsModel_->removeRow (item->row ());
 		}
 
-		Backpages_ = 0;
+		PageLastSeq_ = 0;
+		HighlightSeq_ = 0;
 		RequestLogs ();
 	}
 
@@ -652,8 +658,8 @@ namespace ChatHistory
 
 	void ChatHistoryWidget::RequestLogs ()
 	{
-		const auto& future = Params_.StorageMgr_->GetChatLogs (CurrentAccount_,
-				CurrentEntry_, Backpages_, PerPageAmount_);
+		const auto& future = Params_.StorageMgr_->GetChatLogsPage (CurrentAccount_,
+				CurrentEntry_, PageLastSeq_, PerPageAmount_);
 		Util::Sequence (this, future) >>
 				std::bind (&ChatHistoryWidget::HandleGotChatLogs, this, CurrentAccount_, CurrentEntry_, _1);
 	}
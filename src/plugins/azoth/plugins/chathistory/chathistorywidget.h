@@ -77,10 +77,12 @@ namespace ChatHistory
 
 		QStandardItemModel *ContactsModel_;
 		QSortFilterProxyModel *SortFilter_;
-		int Backpages_ = 0;
-		int Amount_ = 0;
+		HistorySeq_t PageLastSeq_ = 0;
+		HistorySeq_t ShownFirstSeq_ = 0;
+		HistorySeq_t ShownLastSeq_ = 0;
+		HistorySeq_t ShownTotal_ = 0;
+		HistorySeq_t HighlightSeq_ = 0;
 		int SearchShift_ = 0;
-		int SearchResultPosition_ = -1;
 		bool ContactSelectedAsGlobSearch_ = false;
 		QString CurrentAccount_;
 		QString CurrentEntry_;
@@ -108,7 +110,7 @@ namespace ChatHistory
 	private:
 		void HandleGotOurAccounts (const QStringList&);
 		void HandleGotUsersForAccount (const QString&, const UsersForAccountResult_t&);
-		void HandleGotChatLogs (const QString&, const QString&, const ChatLogsResult_t&);
+		void HandleGotChatLogs (const QString&, const QString&, const ChatLogsPageResult_t&);
 		void HandleGotSearchPosition (const QString&, const QString&, const SearchResult_t&);
 		void HandleGotDaysForSheet (const QString&, const QString&, int, int, const DaysResult_t&);
 	private slots:
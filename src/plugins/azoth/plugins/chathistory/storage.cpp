@@ -124,13 +124,13 @@ namespace ChatHistory
 		AccountInserter_.prepare ("INSERT INTO azoth_accounts (AccountID) VALUES (:account_id);");
 
 		MessageDumper_ = QSqlQuery (*DB_);
-		MessageDumper_.prepare ("INSERT INTO azoth_history (Id, AccountID, Date, Direction, Message, Variant, Type, RichMessage, EscapePolicy) "
-				"VALUES (:id, :account_id, :date, :direction, :message, :variant, :type, :rich_message, :escape_policy);");
+		MessageDumper_.prepare ("INSERT INTO azoth_history (Id, AccountID, Date, Direction, Message, Variant, Type, RichMessage, EscapePolicy, Seq) "
+				"VALUES (:id, :account_id, :date, :direction, :message, :variant, :type, :rich_message, :escape_policy, :seq);");
 
 		MessageDumperFuzzy_ = QSqlQuery (*DB_);
 		MessageDumperFuzzy_.prepare (R"(
-				INSERT INTO azoth_history (Id, AccountID, Date, Direction, Message, Variant, Type, RichMessage, EscapePolicy)
-				SELECT :id, :account_id, :date, :direction, :message, :variant, :type, :rich_message, :escape_policy
+				INSERT INTO azoth_history (Id, AccountID, Date, Direction, Message, Variant, Type, RichMessage, EscapePolicy, Seq)
+				SELECT :id, :account_id, :date, :direction, :message, :variant, :type, :rich_message, :escape_policy, :seq
 				WHERE NOT EXISTS (
 					SELECT 1 FROM azoth_history
 					WHERE Id = :id_inner
@@ -145,17 +145,16 @@ namespace ChatHistory
 		UsersForAccountGetter_.prepare ("SELECT DISTINCT azoth_acc2users2.UserId, EntryID FROM azoth_users, azoth_acc2users2 "
 				"WHERE azoth_acc2users2.UserId = azoth_users.Id AND azoth_acc2users2.AccountID = :account_id;");
 
-		RowID2Pos_ = QSqlQuery (*DB_);
-		RowID2Pos_.prepare ("SELECT COUNT(1) FROM azoth_history "
-				"WHERE Id = :entry_id "
-				"AND AccountID = :account_id "
-				"AND rowid > :rowid");
+		RowID2Seq_ = QSqlQuery (*DB_);
+		RowID2Seq_.prepare ("SELECT Seq FROM azoth_history WHERE rowid = :rowid");
 
-		Date2Pos_ = QSqlQuery (*DB_);
-		Date2Pos_.prepare ("SELECT COUNT(1) FROM azoth_history "
+		Date2Seq_ = QSqlQuery (*DB_);
+		Date2Seq_.prepare ("SELECT Seq FROM azoth_history "
 				"WHERE Id = :entry_id "
 				"AND AccountID = :account_id "
-				"AND Date >= :date");
+				"AND Date >= :date "
+				"ORDER BY Date ASC "
+				"LIMIT 1");
 
 		GetMonthDates_ = QSqlQuery (*DB_);
 		GetMonthDates_.prepare ("SELECT Date FROM azoth_history "
@@ -173,27 +172,28 @@ namespace ChatHistory
 				"LIMIT 1 OFFSET :offset;");
 
 		LogsSearcherWOContact_ = QSqlQuery (*DB_);
-		LogsSearcherWOContact_.prepare ("SELECT Date, Id FROM azoth_history "
-				"WHERE AccountID = :account_id "
-				"AND Date = (SELECT Date FROM azoth_history "
-				"	WHERE AccountID = :inner_account_id "
-				"	AND ((Message LIKE :text AND :insensitive) OR (Message GLOB :ctext AND :sensitive)) "
-				"	ORDER BY Rowid DESC "
-				"	LIMIT 1 OFFSET :offset);");
+		LogsSearcherWOContact_.prepare ("SELECT Rowid, Id FROM azoth_history "
+				"WHERE AccountID = :inner_account_id "
+				"AND ((Message LIKE :text AND :insensitive) OR (Message GLOB :ctext AND :sensitive)) "
+				"ORDER BY Rowid DESC "
+				"LIMIT 1 OFFSET :offset;");
 
 		LogsSearcherWOContactAccount_ = QSqlQuery (*DB_);
-		LogsSearcherWOContactAccount_.prepare ("SELECT Date, Id, AccountID FROM azoth_history "
-				"WHERE Date = (SELECT Date FROM azoth_history "
-				"	WHERE ((Message LIKE :text AND :insensitive) OR (Message GLOB :ctext AND :sensitive)) "
-				"	ORDER BY Rowid DESC "
-				"	LIMIT 1 OFFSET :offset);");
+		LogsSearcherWOContactAccount_.prepare ("SELECT Rowid, Id, AccountID FROM azoth_history "
+				"WHERE ((Message LIKE :text AND :insensitive) OR (Message GLOB :ctext AND :sensitive)) "
+				"ORDER BY Rowid DESC "
+				"LIMIT 1 OFFSET :offset;");
+
+		if (HasFTS_)
+			PrepareFTSQueries ();
 
 		HistoryGetter_ = QSqlQuery (*DB_);
 		HistoryGetter_.prepare ("SELECT Date, Direction, Message, Variant, Type, RichMessage, EscapePolicy "
 				"FROM azoth_history "
 				"WHERE Id = :entry_id "
 				"AND AccountID = :account_id "
-				"ORDER BY Rowid DESC LIMIT :limit OFFSET :offset;");
+				"AND Seq <= :last_seq "
+				"ORDER BY Seq DESC LIMIT :limit;");
 
 		HistoryClearer_ = QSqlQuery (*DB_);
 		HistoryClearer_.prepare ("DELETE FROM azoth_history WHERE Id = :entry_id AND AccountID = :account_id;");
@@ -211,6 +211,13 @@ namespace ChatHistory
 		EntryCacheClearer_ = QSqlQuery (*DB_);
 		EntryCacheClearer_.prepare ("DELETE FROM azoth_entrycache WHERE Id = :user_id;");
 
+		MessageCountSetter_ = QSqlQuery (*DB_);
+		MessageCountSetter_.prepare ("INSERT OR REPLACE INTO azoth_history_counts (AccountId, Id, Count) "
+				"VALUES (:account_id, :entry_id, :count);");
+
+		MessageCountClearer_ = QSqlQuery (*DB_);
+		MessageCountClearer_.prepare ("DELETE FROM azoth_history_counts WHERE AccountId = :account_id AND Id = :entry_id;");
+
 		try
 		{
 			Users_ = GetUsers ();
@@ -234,6 +241,7 @@ namespace ChatHistory
 		}
 
 		PrepareEntryCache ();
+		PrepareMessageCounts ();
 
 		return InitializationResult_t::Right ({});
 	}
@@ -281,6 +289,7 @@ namespace ChatHistory
 						"Type INTEGER, "
 						"RichMessage TEXT, "
 						"EscapePolicy VARCHAR(3), "
+						"Seq INTEGER, "
 						"UNIQUE (Id, AccountId, Date, Direction, Message, Variant, Type) ON CONFLICT IGNORE);"
 				});
 		table2query.append ({
@@ -290,6 +299,15 @@ namespace ChatHistory
 						"VisibleName TEXT "
 						");"
 				});
+		table2query.append ({
+					"azoth_history_counts",
+					"CREATE TABLE azoth_history_counts ("
+						"AccountId INTEGER, "
+						"Id INTEGER, "
+						"Count INTEGER NOT NULL, "
+						"PRIMARY KEY (AccountId, Id)"
+						");"
+				});
 		table2query.append ({
 					"azoth_acc2users2",
 					"CREATE TABLE azoth_acc2users2 ("
@@ -320,11 +338,18 @@ namespace ChatHistory
 
 		UpdateTables ();
 
-		if (!query.exec ("CREATE INDEX IF NOT EXISTS azoth_history_id_accountid ON azoth_history (Id, AccountId);"))
+		const QStringList indexQueries
 		{
-			Util::DBLock::DumpError (query);
-			throw std::runtime_error ("Unable to index `azoth_history`.");
-		}
+			"DROP INDEX IF EXISTS azoth_history_id_accountid;",
+			"CREATE INDEX IF NOT EXISTS azoth_history_id_accountid_seq ON azoth_history (Id, AccountId, Seq);",
+			"CREATE INDEX IF NOT EXISTS azoth_history_id_accountid_date ON azoth_history (Id, AccountId, Date);"
+		};
+		for (const auto& indexQuery : indexQueries)
+			if (!query.exec (indexQuery))
+			{
+				Util::DBLock::DumpError (query);
+				throw std::runtime_error ("Unable to index `azoth_history`.");
+			}
 
 		if (!hadAcc2User)
 			RegenUsersCache ();
@@ -365,6 +390,241 @@ namespace ChatHistory
 					<< columns;
 			throw std::runtime_error ("Unable to add column `EscapePolicy` to `azoth_history`.");
 		}
+
+		if (!columns.contains ("Seq"))
+			MigrateMessageSeqs ();
+
+		if (!DB_->tables ().contains ("azoth_history_fts") && !CreateFTSIndex ())
+			qWarning () << Q_FUNC_INFO
+					<< "unable to create the full-text index, is FTS5 available? Falling back to plain search.";
+
+		LoadFTSState ();
+	}
+
+	void Storage::MigrateMessageSeqs ()
+	{
+		qDebug () << Q_FUNC_INFO
+				<< "numbering the messages, this may take a while...";
+
+		const QStringList queries
+		{
+			"ALTER TABLE azoth_history ADD COLUMN Seq INTEGER;",
+			"CREATE TEMP TABLE azoth_history_seqs (RowId INTEGER PRIMARY KEY, Seq INTEGER);",
+			"INSERT INTO azoth_history_seqs (RowId, Seq) "
+				"SELECT rowid, ROW_NUMBER () OVER (PARTITION BY Id, AccountId ORDER BY rowid) FROM azoth_history;",
+			"UPDATE azoth_history SET Seq = "
+				"(SELECT s.Seq FROM azoth_history_seqs s WHERE s.RowId = azoth_history.rowid);",
+			"DROP TABLE azoth_history_seqs;",
+			"DELETE FROM azoth_history_counts;",
+			"INSERT INTO azoth_history_counts (AccountId, Id, Count) "
+				"SELECT AccountId, Id, COUNT(1) FROM azoth_history GROUP BY AccountId, Id;"
+		};
+
+		QSqlQuery query { *DB_ };
+		for (const auto& queryStr : queries)
+			if (!query.exec (queryStr))
+			{
+				Util::DBLock::DumpError (query);
+				throw std::runtime_error ("Unable to number the messages in `azoth_history`.");
+			}
+	}
+
+	bool Storage::CreateFTSIndex ()
+	{
+		const QStringList queries
+		{
+			"CREATE VIRTUAL TABLE azoth_history_fts USING fts5 (Message, content = 'azoth_history');",
+			"CREATE TABLE azoth_history_fts_state ("
+				"LastRowId INTEGER NOT NULL, "
+				"UpperRowId INTEGER NOT NULL"
+				");",
+			"INSERT INTO azoth_history_fts_state (LastRowId, UpperRowId) "
+				"SELECT 0, coalesce (max (rowid), 0) FROM azoth_history;",
+			"CREATE TRIGGER azoth_history_fts_insert AFTER INSERT ON azoth_history "
+				"WHEN NOT EXISTS (SELECT 1 FROM azoth_history_fts_state "
+				"	WHERE new.rowid > LastRowId AND new.rowid <= UpperRowId) "
+				"BEGIN "
+				"INSERT INTO azoth_history_fts (rowid, Message) VALUES (new.rowid, new.Message); "
+				"END;",
+			"CREATE TRIGGER azoth_history_fts_delete AFTER DELETE ON azoth_history "
+				"WHEN NOT EXISTS (SELECT 1 FROM azoth_history_fts_state "
+				"	WHERE old.rowid > LastRowId AND old.rowid <= UpperRowId) "
+				"BEGIN "
+				"INSERT INTO azoth_history_fts (azoth_history_fts, rowid, Message) VALUES ('delete', old.rowid, old.Message); "
+				"END;"
+		};
+
+		QSqlQuery query { *DB_ };
+		for (const auto& queryStr : queries)
+			if (!query.exec (queryStr))
+			{
+				Util::DBLock::DumpError (query);
+				return false;
+			}
+
+		return true;
+	}
+
+	void Storage::LoadFTSState ()
+	{
+		HasFTS_ = DB_->tables ().contains ("azoth_history_fts");
+		FTSReady_ = false;
+		if (!HasFTS_)
+			return;
+
+		QSqlQuery query { *DB_ };
+		if (!query.exec ("SELECT LastRowId >= UpperRowId FROM azoth_history_fts_state;"))
+		{
+			Util::DBLock::DumpError (query);
+			HasFTS_ = false;
+			return;
+		}
+
+		FTSReady_ = query.next () && query.value (0).toBool ();
+	}
+
+	void Storage::PrepareFTSQueries ()
+	{
+		FTSLogsSearcher_ = QSqlQuery (*DB_);
+		FTSLogsSearcher_.prepare ("SELECT azoth_history.rowid FROM azoth_history_fts "
+				"JOIN azoth_history ON azoth_history.rowid = azoth_history_fts.rowid "
+				"WHERE azoth_history_fts MATCH :fts_query "
+				"AND azoth_history.Id = :inner_entry_id "
+				"AND azoth_history.AccountID = :inner_account_id "
+				"AND ((azoth_history.Message LIKE :text AND :insensitive) OR (azoth_history.Message GLOB :ctext AND :sensitive)) "
+				"ORDER BY azoth_history_fts.rowid DESC "
+				"LIMIT 1 OFFSET :offset;");
+
+		FTSLogsSearcherWOContact_ = QSqlQuery (*DB_);
+		FTSLogsSearcherWOContact_.prepare ("SELECT azoth_history.rowid, azoth_history.Id FROM azoth_history_fts "
+				"JOIN azoth_history ON azoth_history.rowid = azoth_history_fts.rowid "
+				"WHERE azoth_history_fts MATCH :fts_query "
+				"AND azoth_history.AccountID = :inner_account_id "
+				"AND ((azoth_history.Message LIKE :text AND :insensitive) OR (azoth_history.Message GLOB :ctext AND :sensitive)) "
+				"ORDER BY azoth_history_fts.rowid DESC "
+				"LIMIT 1 OFFSET :offset;");
+
+		FTSLogsSearcherWOContactAccount_ = QSqlQuery (*DB_);
+		FTSLogsSearcherWOContactAccount_.prepare ("SELECT azoth_history.rowid, azoth_history.Id, azoth_history.AccountID "
+				"FROM azoth_history_fts "
+				"JOIN azoth_history ON azoth_history.rowid = azoth_history_fts.rowid "
+				"WHERE azoth_history_fts MATCH :fts_query "
+				"AND ((azoth_history.Message LIKE :text AND :insensitive) OR (azoth_history.Message GLOB :ctext AND :sensitive)) "
+				"ORDER BY azoth_history_fts.rowid DESC "
+				"LIMIT 1 OFFSET :offset;");
+
+		FTSRankedSearcher_ = QSqlQuery (*DB_);
+		FTSRankedSearcher_.prepare ("SELECT azoth_history.rowid, azoth_history.Id, azoth_history.AccountID, "
+				"azoth_history.Date, azoth_history.Message "
+				"FROM azoth_history_fts "
+				"JOIN azoth_history ON azoth_history.rowid = azoth_history_fts.rowid "
+				"WHERE azoth_history_fts MATCH :fts_query "
+				"AND (:any_account OR azoth_history.AccountID = :account_id) "
+				"AND (:any_entry OR azoth_history.Id = :entry_id) "
+				"ORDER BY bm25 (azoth_history_fts) "
+				"LIMIT :limit;");
+	}
+
+	bool Storage::BackfillFTSIndex ()
+	{
+		if (!HasFTS_ || FTSReady_)
+			return false;
+
+		Util::DBLock lock (*DB_);
+		try
+		{
+			lock.Init ();
+		}
+		catch (const std::exception& e)
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "unable to start transaction:"
+					<< e.what ();
+			return false;
+		}
+
+		QSqlQuery query { *DB_ };
+		if (!query.exec ("SELECT LastRowId, UpperRowId FROM azoth_history_fts_state;") ||
+				!query.next ())
+		{
+			Util::DBLock::DumpError (query);
+			return false;
+		}
+
+		const auto lastRowId = query.value (0).value<qint64> ();
+		const auto upperRowId = query.value (1).value<qint64> ();
+		query.finish ();
+
+		const qint64 chunkSize = 20000;
+		const auto chunkEnd = std::min (lastRowId + chunkSize, upperRowId);
+
+		query.prepare ("INSERT INTO azoth_history_fts (rowid, Message) "
+				"SELECT rowid, Message FROM azoth_history WHERE rowid > :last_rowid AND rowid <= :chunk_end;");
+		query.bindValue (":last_rowid", lastRowId);
+		query.bindValue (":chunk_end", chunkEnd);
+		if (!query.exec ())
+		{
+			Util::DBLock::DumpError (query);
+			return false;
+		}
+
+		query.prepare ("UPDATE azoth_history_fts_state SET LastRowId = :chunk_end;");
+		query.bindValue (":chunk_end", chunkEnd);
+		if (!query.exec ())
+		{
+			Util::DBLock::DumpError (query);
+			return false;
+		}
+
+		lock.Good ();
+
+		FTSReady_ = chunkEnd >= upperRowId;
+		if (FTSReady_)
+			qDebug () << Q_FUNC_INFO
+					<< "finished building the full-text index";
+
+		return !FTSReady_;
+	}
+
+	void Storage::ResetFTSIndex ()
+	{
+		Util::DBLock lock (*DB_);
+		try
+		{
+			lock.Init ();
+		}
+		catch (const std::exception& e)
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "unable to start transaction:"
+					<< e.what ();
+			return;
+		}
+
+		const QStringList queries
+		{
+			"DROP TRIGGER IF EXISTS azoth_history_fts_insert;",
+			"DROP TRIGGER IF EXISTS azoth_history_fts_delete;",
+			"DROP TABLE IF EXISTS azoth_history_fts;",
+			"DROP TABLE IF EXISTS azoth_history_fts_state;"
+		};
+
+		QSqlQuery query { *DB_ };
+		for (const auto& queryStr : queries)
+			if (!query.exec (queryStr))
+			{
+				Util::DBLock::DumpError (query);
+				return;
+			}
+
+		if (!CreateFTSIndex ())
+			return;
+
+		lock.Good ();
+
+		LoadFTSState ();
+		if (HasFTS_)
+			PrepareFTSQueries ();
 	}
 
 	QHash<QString, qint32> Storage::GetUsers ()
@@ -451,6 +711,19 @@ namespace ChatHistory
 		qDebug () << Q_FUNC_INFO << "loaded" << EntryCache_.size () << "entries";
 	}
 
+	void Storage::PrepareMessageCounts ()
+	{
+		QSqlQuery query { *DB_ };
+		if (!query.exec ("SELECT AccountId, Id, Count FROM azoth_history_counts;"))
+		{
+			Util::DBLock::DumpError (query);
+			return;
+		}
+
+		while (query.next ())
+			MessageCounts_ [{ query.value (0).toInt (), query.value (1).toInt () }] = query.value (2).value<HistorySeq_t> ();
+	}
+
 	QHash<QString, qint32> Storage::GetAccounts()
 	{
 		if (!AccountSelector_.exec ())
@@ -514,6 +787,20 @@ namespace ChatHistory
 		{
 			return Util::MakeScopeGuard ([&query] { query.finish (); });
 		}
+
+		/* The full-text index only narrows down the candidate rows: each
+		 * word of the text is matched as a prefix of some token, and the
+		 * usual LIKE/GLOB check on the candidates keeps the semantics
+		 * of the search intact.
+		 */
+		QString MakeFTSQuery (const QString& text)
+		{
+			QStringList terms;
+			for (auto term : text.split (' ', QString::SkipEmptyParts))
+				if (std::any_of (term.begin (), term.end (), [] (QChar c) { return c.isLetterOrNumber (); }))
+					terms << '"' + term.replace ('"', "\"\"") + "\"*";
+			return terms.join (' ');
+		}
 	}
 
 	Storage::RawSearchResult Storage::SearchImpl (const QString& accountId,
@@ -538,33 +825,38 @@ namespace ChatHistory
 			return {};
 		}
 
+		const auto& ftsQuery = FTSReady_ ? MakeFTSQuery (text) : QString {};
+		auto& searcher = ftsQuery.isEmpty () ? LogsSearcher_ : FTSLogsSearcher_;
+
 		const qint32 intEntryId = Users_ [entryId];
 		const qint32 intAccId = Accounts_ [accountId];
-		LogsSearcher_.bindValue (":entry_id", intEntryId);
-		LogsSearcher_.bindValue (":account_id", intAccId);
-		LogsSearcher_.bindValue (":inner_entry_id", intEntryId);
-		LogsSearcher_.bindValue (":inner_account_id", intAccId);
-		LogsSearcher_.bindValue (":text", '%' + text + '%');
-		LogsSearcher_.bindValue (":ctext", '*' + text + '*');
-		LogsSearcher_.bindValue (":sensitive", static_cast<int> (cs));
-		LogsSearcher_.bindValue (":insensitive", static_cast<int> (!cs));
-		LogsSearcher_.bindValue (":offset", shift);
-		if (!LogsSearcher_.exec ())
-		{
-			Util::DBLock::DumpError (LogsSearcher_);
+		searcher.bindValue (":entry_id", intEntryId);
+		searcher.bindValue (":account_id", intAccId);
+		searcher.bindValue (":inner_entry_id", intEntryId);
+		searcher.bindValue (":inner_account_id", intAccId);
+		searcher.bindValue (":text", '%' + text + '%');
+		searcher.bindValue (":ctext", '*' + text + '*');
+		searcher.bindValue (":sensitive", static_cast<int> (cs));
+		searcher.bindValue (":insensitive", static_cast<int> (!cs));
+		searcher.bindValue (":offset", shift);
+		if (!ftsQuery.isEmpty ())
+			searcher.bindValue (":fts_query", ftsQuery);
+		if (!searcher.exec ())
+		{
+			Util::DBLock::DumpError (searcher);
 			return {};
 		}
-		auto guard = CleanupQueryGuard (LogsSearcher_);
+		auto guard = CleanupQueryGuard (searcher);
 
-		if (!LogsSearcher_.next ())
+		if (!searcher.next ())
 		{
 			qWarning () << Q_FUNC_INFO
 					<< "unable to move to the next entry";
-			Util::DBLock::DumpError (LogsSearcher_);
+			Util::DBLock::DumpError (searcher);
 			return {};
 		}
 
-		return { intEntryId, intAccId, LogsSearcher_.value (0).value<qint64> () };
+		return { intEntryId, intAccId, searcher.value (0).value<qint64> () };
 	}
 
 	Storage::RawSearchResult Storage::SearchImpl (const QString& accountId,
@@ -580,109 +872,118 @@ namespace ChatHistory
 			return {};
 		}
 
+		const auto& ftsQuery = FTSReady_ ? MakeFTSQuery (text) : QString {};
+		auto& searcher = ftsQuery.isEmpty () ? LogsSearcherWOContact_ : FTSLogsSearcherWOContact_;
+
 		const qint32 intAccId = Accounts_ [accountId];
-		LogsSearcherWOContact_.bindValue (":account_id", intAccId);
-		LogsSearcherWOContact_.bindValue (":inner_account_id", intAccId);
-		LogsSearcherWOContact_.bindValue (":text", '%' + text + '%');
-		LogsSearcherWOContact_.bindValue (":ctext", '*' + text + '*');
-		LogsSearcherWOContact_.bindValue (":sensitive", static_cast<int> (cs));
-		LogsSearcherWOContact_.bindValue (":insensitive", static_cast<int> (!cs));
-		LogsSearcherWOContact_.bindValue (":offset", shift);
-		if (!LogsSearcherWOContact_.exec ())
-		{
-			Util::DBLock::DumpError (LogsSearcherWOContact_);
+		searcher.bindValue (":account_id", intAccId);
+		searcher.bindValue (":inner_account_id", intAccId);
+		searcher.bindValue (":text", '%' + text + '%');
+		searcher.bindValue (":ctext", '*' + text + '*');
+		searcher.bindValue (":sensitive", static_cast<int> (cs));
+		searcher.bindValue (":insensitive", static_cast<int> (!cs));
+		searcher.bindValue (":offset", shift);
+		if (!ftsQuery.isEmpty ())
+			searcher.bindValue (":fts_query", ftsQuery);
+		if (!searcher.exec ())
+		{
+			Util::DBLock::DumpError (searcher);
 			return RawSearchResult ();
 		}
 
-		if (!LogsSearcherWOContact_.next ())
+		if (!searcher.next ())
 		{
 			qWarning () << Q_FUNC_INFO
 					<< "unable to move to the next entry";
 			return RawSearchResult ();
 		}
 
-		auto guard = CleanupQueryGuard (LogsSearcherWOContact_);
+		auto guard = CleanupQueryGuard (searcher);
 
 		return
 		{
-			LogsSearcherWOContact_.value (1).toInt (),
+			searcher.value (1).toInt (),
 			intAccId,
-			LogsSearcherWOContact_.value (0).value<qint64> ()
+			searcher.value (0).value<qint64> ()
 		};
 	}
 
 	Storage::RawSearchResult Storage::SearchImpl (const QString& text, int shift, bool cs)
 	{
-		LogsSearcherWOContactAccount_.bindValue (":text", '%' + text + '%');
-		LogsSearcherWOContactAccount_.bindValue (":ctext", '*' + text + '*');
-		LogsSearcherWOContactAccount_.bindValue (":sensitive", static_cast<int> (cs));
-		LogsSearcherWOContactAccount_.bindValue (":insensitive", static_cast<int> (!cs));
-		LogsSearcherWOContactAccount_.bindValue (":offset", shift);
-		if (!LogsSearcherWOContactAccount_.exec ())
-		{
-			Util::DBLock::DumpError (LogsSearcherWOContactAccount_);
+		const auto& ftsQuery = FTSReady_ ? MakeFTSQuery (text) : QString {};
+		auto& searcher = ftsQuery.isEmpty () ? LogsSearcherWOContactAccount_ : FTSLogsSearcherWOContactAccount_;
+
+		searcher.bindValue (":text", '%' + text + '%');
+		searcher.bindValue (":ctext", '*' + text + '*');
+		searcher.bindValue (":sensitive", static_cast<int> (cs));
+		searcher.bindValue (":insensitive", static_cast<int> (!cs));
+		searcher.bindValue (":offset", shift);
+		if (!ftsQuery.isEmpty ())
+			searcher.bindValue (":fts_query", ftsQuery);
+		if (!searcher.exec ())
+		{
+			Util::DBLock::DumpError (searcher);
 			return RawSearchResult ();
 		}
 
-		if (!LogsSearcherWOContactAccount_.next ())
+		if (!searcher.next ())
 		{
 			qWarning () << Q_FUNC_INFO
 					<< "unable to move to the next entry";
 			return RawSearchResult ();
 		}
 
-		auto guard = CleanupQueryGuard (LogsSearcherWOContactAccount_);
+		auto guard = CleanupQueryGuard (searcher);
 
 		return
 		{
-			LogsSearcherWOContactAccount_.value (1).toInt (),
-			LogsSearcherWOContactAccount_.value (2).toInt (),
-			LogsSearcherWOContactAccount_.value (0).value<qint64> ()
+			searcher.value (1).toInt (),
+			searcher.value (2).toInt (),
+			searcher.value (0).value<qint64> ()
 		};
 	}
 
-	SearchResult_t Storage::SearchRowIdImpl (qint32 accountId, qint32 entryId, qint64 rowId)
+	SearchResult_t Storage::SearchRowIdImpl (qint64 rowId)
 	{
-		RowID2Pos_.bindValue (":rowid", rowId);
-		RowID2Pos_.bindValue (":account_id", accountId);
-		RowID2Pos_.bindValue (":entry_id", entryId);
-		if (!RowID2Pos_.exec ())
+		RowID2Seq_.bindValue (":rowid", rowId);
+		if (!RowID2Seq_.exec ())
 		{
-			Util::DBLock::DumpError (RowID2Pos_);
+			Util::DBLock::DumpError (RowID2Seq_);
 			return SearchResult_t::Left ("Unable to execute search query.");
 		}
 
-		if (!RowID2Pos_.next ())
+		if (!RowID2Seq_.next ())
 			return SearchResult_t::Right ({});
 
-		const int index = RowID2Pos_.value (0).toInt ();
-		RowID2Pos_.finish ();
+		const auto seq = RowID2Seq_.value (0).value<HistorySeq_t> ();
+		RowID2Seq_.finish ();
 
-		return SearchResult_t::Right (index);
+		return SearchResult_t::Right (seq);
 	}
 
 	SearchResult_t Storage::SearchDateImpl (qint32 accountId, qint32 entryId, const QDateTime& dt)
 	{
-		Date2Pos_.bindValue (":date", dt);
-		Date2Pos_.bindValue (":account_id", accountId);
-		Date2Pos_.bindValue (":entry_id", entryId);
-		if (!Date2Pos_.exec ())
+		Date2Seq_.bindValue (":date", dt);
+		Date2Seq_.bindValue (":account_id", accountId);
+		Date2Seq_.bindValue (":entry_id", entryId);
+		if (!Date2Seq_.exec ())
 		{
-			Util::DBLock::DumpError (Date2Pos_);
+			Util::DBLock::DumpError (Date2Seq_);
 			return SearchResult_t::Left ("Unable to execute search query.");
 		}
 
-		if (!Date2Pos_.next ())
+		if (!Date2Seq_.next ())
 		{
-			qWarning () << Q_FUNC_INFO
-					<< "unable to navigate to next record";
-			return SearchResult_t::Left ("Unable to navigate to the search results.");
+			const auto total = MessageCounts_.value ({ accountId, entryId });
+			if (!total)
+				return SearchResult_t::Right ({});
+			return SearchResult_t::Right (total);
 		}
 
-		const int index = Date2Pos_.value (0).toInt ();
-		Date2Pos_.finish ();
+		const auto seq = Date2Seq_.value (0).value<HistorySeq_t> ();
+		Date2Seq_.finish ();
 
-		return SearchResult_t::Right (index);
+		return SearchResult_t::Right (seq);
 	}
 
 	boost::optional<int> Storage::GetAllHistoryCount ()
@@ -808,6 +1109,74 @@ namespace ChatHistory
 			return;
 		}
 
+		MessageCounts_t counts;
+		if (!AddMessagesImpl (accountID, entryID, visibleName, items, fuzzy, counts) ||
+				!lock.Commit ())
+			return;
+
+		for (auto i = counts.begin (); i != counts.end (); ++i)
+			MessageCounts_ [i.key ()] = i.value ();
+	}
+
+	void Storage::AddMessagesBatch (const QList<PendingLogItems>& batch)
+	{
+		Util::DBLock lock (*DB_);
+		try
+		{
+			lock.Init ();
+		}
+		catch (const std::exception& e)
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "unable to start transaction:"
+					<< e.what ();
+			return;
+		}
+
+		MessageCounts_t counts;
+
+		QSqlQuery savepoint { *DB_ };
+		for (const auto& pending : batch)
+		{
+			if (!savepoint.exec ("SAVEPOINT azoth_history_batch;"))
+			{
+				Util::DBLock::DumpError (savepoint);
+				return;
+			}
+
+			if (!AddMessagesImpl (pending.AccountId_, pending.EntryId_,
+					pending.VisibleName_, pending.Items_, pending.Fuzzy_, counts))
+			{
+				qWarning () << Q_FUNC_INFO
+						<< "dropping"
+						<< pending.Items_.size ()
+						<< "messages for"
+						<< pending.EntryId_;
+				if (!savepoint.exec ("ROLLBACK TO azoth_history_batch;"))
+				{
+					Util::DBLock::DumpError (savepoint);
+					return;
+				}
+			}
+
+			if (!savepoint.exec ("RELEASE azoth_history_batch;"))
+			{
+				Util::DBLock::DumpError (savepoint);
+				return;
+			}
+		}
+
+		if (!lock.Commit ())
+			return;
+
+		for (auto i = counts.begin (); i != counts.end (); ++i)
+			MessageCounts_ [i.key ()] = i.value ();
+	}
+
+	bool Storage::AddMessagesImpl (const QString& accountID,
+			const QString& entryID, const QString& visibleName,
+			const QList<LogItem>& items, bool fuzzy, MessageCounts_t& counts)
+	{
 		if (!Accounts_.contains (accountID))
 			try
 			{
@@ -819,7 +1188,7 @@ namespace ChatHistory
 						<< accountID
 						<< "unable to add account ID to the DB:"
 						<< e.what ();
-				return;
+				return false;
 			}
 
 		if (!Users_.contains (entryID))
@@ -833,7 +1202,7 @@ namespace ChatHistory
 						<< entryID
 						<< "unable to add the user to the DB:"
 						<< e.what ();
-				return;
+				return false;
 			}
 
 		auto userId = Users_ [entryID];
@@ -847,23 +1216,41 @@ namespace ChatHistory
 			EntryCache_ [userId] = visibleName;
 		}
 
+		const auto accId = Accounts_ [accountID];
+		const QPair<qint32, qint32> key { accId, userId };
+		auto count = counts.value (key, MessageCounts_.value (key));
+
 		for (const auto& logItem : items)
 		{
 			auto& query = fuzzy ? MessageDumperFuzzy_ : MessageDumper_;
 
 			if (fuzzy)
-				BindFuzzy (query, userId, Accounts_ [accountID], logItem);
+				BindFuzzy (query, userId, accId, logItem);
 			else
-				BindStrict (query, userId, Accounts_ [accountID], logItem);
+				BindStrict (query, userId, accId, logItem);
+			query.bindValue (":seq", count + 1);
 
 			if (!query.exec ())
 			{
 				Util::DBLock::DumpError (query);
-				return;
+				return false;
 			}
+
+			if (query.numRowsAffected () > 0)
+				++count;
 		}
 
-		lock.Good ();
+		MessageCountSetter_.bindValue (":account_id", accId);
+		MessageCountSetter_.bindValue (":entry_id", userId);
+		MessageCountSetter_.bindValue (":count", count);
+		if (!MessageCountSetter_.exec ())
+		{
+			Util::DBLock::DumpError (MessageCountSetter_);
+			return false;
+		}
+
+		counts [key] = count;
+		return true;
 	}
 
 	IHistoryPlugin::MaxTimestampResult_t Storage::GetMaxTimestamp (const QString& accountId)
@@ -968,10 +1355,57 @@ namespace ChatHistory
 			return ChatLogsResult_t::Left ("Unknown user.");
 		}
 
-		HistoryGetter_.bindValue (":entry_id", Users_ [entryId]);
-		HistoryGetter_.bindValue (":account_id", Accounts_ [accountId]);
+		const auto intEntryId = Users_ [entryId];
+		const auto intAccId = Accounts_ [accountId];
+		const auto total = MessageCounts_.value ({ intAccId, intEntryId });
+		return GetChatLogsImpl (intAccId, intEntryId, total - static_cast<HistorySeq_t> (amount) * backpages, amount);
+	}
+
+	ChatLogsPageResult_t Storage::GetChatLogsPage (const QString& accountId,
+			const QString& entryId, HistorySeq_t lastSeq, int amount)
+	{
+		if (!Accounts_.contains (accountId))
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "Accounts_ doesn't contain"
+					<< accountId
+					<< "; raw contents"
+					<< Accounts_;
+			return ChatLogsPageResult_t::Left ("Unknown account.");
+		}
+		if (!Users_.contains (entryId))
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "Users_ doesn't contain"
+					<< entryId
+					<< "; raw contents"
+					<< Users_;
+			return ChatLogsPageResult_t::Left ("Unknown user.");
+		}
+
+		const auto intEntryId = Users_ [entryId];
+		const auto intAccId = Accounts_ [accountId];
+		const auto total = MessageCounts_.value ({ intAccId, intEntryId });
+		if (lastSeq <= 0 || lastSeq > total)
+			lastSeq = total;
+
+		const auto& logs = GetChatLogsImpl (intAccId, intEntryId, lastSeq, amount);
+		if (const auto err = logs.MaybeLeft ())
+			return ChatLogsPageResult_t::Left (*err);
+
+		const auto& items = logs.GetRight ();
+		return ChatLogsPageResult_t::Right ({ items, lastSeq - items.size () + 1, total });
+	}
+
+	ChatLogsResult_t Storage::GetChatLogsImpl (qint32 accountId, qint32 entryId, HistorySeq_t lastSeq, int amount)
+	{
+		if (lastSeq <= 0)
+			return ChatLogsResult_t::Right ({});
+
+		HistoryGetter_.bindValue (":entry_id", entryId);
+		HistoryGetter_.bindValue (":account_id", accountId);
+		HistoryGetter_.bindValue (":last_seq", lastSeq);
 		HistoryGetter_.bindValue (":limit", amount);
-		HistoryGetter_.bindValue (":offset", amount * backpages);
 
 		if (!HistoryGetter_.exec ())
 		{
@@ -1010,7 +1444,73 @@ namespace ChatHistory
 		if (res.IsEmpty ())
 			return SearchResult_t::Right ({});
 
-		return SearchRowIdImpl (res.AccountID_, res.EntryID_, res.RowID_);
+		return SearchRowIdImpl (res.RowID_);
+	}
+
+	RankedSearchResult_t Storage::SearchRanked (const QString& accountId,
+			const QString& entryId, const QString& text, int limit)
+	{
+		if (!FTSReady_)
+			return RankedSearchResult_t::Left ("The full-text index is not ready yet.");
+
+		if (!accountId.isEmpty () && !Accounts_.contains (accountId))
+			return RankedSearchResult_t::Left ("Unknown account.");
+		if (!entryId.isEmpty () && !Users_.contains (entryId))
+			return RankedSearchResult_t::Left ("Unknown user.");
+
+		const auto& ftsQuery = MakeFTSQuery (text);
+		if (ftsQuery.isEmpty ())
+			return RankedSearchResult_t::Right ({});
+
+		FTSRankedSearcher_.bindValue (":fts_query", ftsQuery);
+		FTSRankedSearcher_.bindValue (":any_account", static_cast<int> (accountId.isEmpty ()));
+		FTSRankedSearcher_.bindValue (":account_id", Accounts_.value (accountId, -1));
+		FTSRankedSearcher_.bindValue (":any_entry", static_cast<int> (entryId.isEmpty ()));
+		FTSRankedSearcher_.bindValue (":entry_id", Users_.value (entryId, -1));
+		FTSRankedSearcher_.bindValue (":limit", limit);
+		if (!FTSRankedSearcher_.exec ())
+		{
+			Util::DBLock::DumpError (FTSRankedSearcher_);
+			return RankedSearchResult_t::Left ("Unable to execute search query.");
+		}
+
+		struct RawHit
+		{
+			qint64 RowID_;
+			qint32 EntryID_;
+			qint32 AccountID_;
+			QDateTime Date_;
+			QString Message_;
+		};
+		QList<RawHit> rawHits;
+		while (FTSRankedSearcher_.next ())
+			rawHits.push_back ({
+					FTSRankedSearcher_.value (0).value<qint64> (),
+					FTSRankedSearcher_.value (1).toInt (),
+					FTSRankedSearcher_.value (2).toInt (),
+					FTSRankedSearcher_.value (3).toDateTime (),
+					FTSRankedSearcher_.value (4).toString ()
+				});
+		FTSRankedSearcher_.finish ();
+
+		QList<SearchHit> result;
+		for (const auto& raw : rawHits)
+		{
+			const auto& seq = SearchRowIdImpl (raw.RowID_);
+			if (seq.IsLeft ())
+				return RankedSearchResult_t::Left (seq.GetLeft ());
+
+			const auto total = MessageCounts_.value ({ raw.AccountID_, raw.EntryID_ });
+			result.push_back ({
+					Accounts_.key (raw.AccountID_),
+					Users_.key (raw.EntryID_),
+					raw.Date_,
+					raw.Message_,
+					static_cast<int> (total - seq.GetRight ().get_value_or (total))
+				});
+		}
+
+		return RankedSearchResult_t::Right (result);
 	}
 
 	SearchResult_t Storage::SearchDate (const QString& account, const QString& entry, const QDateTime& dt)
@@ -1104,12 +1604,19 @@ namespace ChatHistory
 		lock.Init ();
 
 		const auto userId = Users_.take (entryId);
+		const auto accId = Accounts_ [accountId];
 		HistoryClearer_.bindValue (":entry_id", userId);
-		HistoryClearer_.bindValue (":account_id", Accounts_ [accountId]);
+		HistoryClearer_.bindValue (":account_id", accId);
 
 		if (!HistoryClearer_.exec ())
 			Util::DBLock::DumpError (HistoryClearer_);
 
+		MessageCountClearer_.bindValue (":entry_id", userId);
+		MessageCountClearer_.bindValue (":account_id", accId);
+		if (!MessageCountClearer_.exec ())
+			Util::DBLock::DumpError (MessageCountClearer_);
+		MessageCounts_.remove ({ accId, userId });
+
 		EntryCacheClearer_.bindValue (":user_id", userId);
 		if (!EntryCacheClearer_.exec ())
 			Util::DBLock::DumpError (EntryCacheClearer_);
@@ -63,24 +63,36 @@ namespace ChatHistory
 		QSqlQuery MessageDumper_;
 		QSqlQuery MessageDumperFuzzy_;
 		QSqlQuery UsersForAccountGetter_;
-		QSqlQuery RowID2Pos_;
-		QSqlQuery Date2Pos_;
+		QSqlQuery RowID2Seq_;
+		QSqlQuery Date2Seq_;
 		QSqlQuery GetMonthDates_;
 		QSqlQuery LogsSearcher_;
 		QSqlQuery LogsSearcherWOContact_;
 		QSqlQuery LogsSearcherWOContactAccount_;
+		QSqlQuery FTSLogsSearcher_;
+		QSqlQuery FTSLogsSearcherWOContact_;
+		QSqlQuery FTSLogsSearcherWOContactAccount_;
+		QSqlQuery FTSRankedSearcher_;
 		QSqlQuery HistoryGetter_;
 		QSqlQuery HistoryClearer_;
 		QSqlQuery UserClearer_;
 		QSqlQuery EntryCacheSetter_;
 		QSqlQuery EntryCacheGetter_;
 		QSqlQuery EntryCacheClearer_;
+		QSqlQuery MessageCountSetter_;
+		QSqlQuery MessageCountClearer_;
 
 		QHash<QString, qint32> Users_;
 		QHash<QString, qint32> Accounts_;
 
 		QHash<qint32, QString> EntryCache_;
 
+		using MessageCounts_t = QHash<QPair<qint32, qint32>, HistorySeq_t>;
+		MessageCounts_t MessageCounts_;
+
+		bool HasFTS_ = false;
+		bool FTSReady_ = false;
+
 		struct RawSearchResult
 		{
 			qint32 EntryID_ = 0;
@@ -116,29 +128,87 @@ namespace ChatHistory
 		ChatLogsResult_t GetChatLogs (const QString& accountId,
 				const QString& entryId, int backpages, int amount);
 
+		/** @brief Returns up to \em amount messages ending with \em lastSeq.
+		 *
+		 * If \em lastSeq is not positive or exceeds the number of
+		 * messages in the conversation, the newest messages are
+		 * returned.
+		 */
+		ChatLogsPageResult_t GetChatLogsPage (const QString& accountId,
+				const QString& entryId, HistorySeq_t lastSeq, int amount);
+
 		void AddMessages (const QString& accountId, const QString& entryId,
 				const QString& visibleName, const QList<LogItem>&, bool fuzzy);
 
+		/** @brief Stores several AddMessages() requests in a single
+		 * transaction.
+		 *
+		 * A failing element is rolled back alone, without affecting
+		 * the rest of the batch.
+		 */
+		void AddMessagesBatch (const QList<PendingLogItems>&);
+
 		SearchResult_t Search (const QString& accountId, const QString& entryId,
 				const QString& text, int shift, bool cs);
 		SearchResult_t SearchDate (const QString& accountId,
 				const QString& entryId, const QDateTime& dt);
 
+		/** @brief Returns the messages matching the \em text, the most
+		 * relevant ones first.
+		 *
+		 * If \em accountId or \em entryId are empty, the search spans
+		 * all the accounts or all the entries of the account,
+		 * respectively.
+		 *
+		 * The search is only available once the full-text index is
+		 * built, an error is returned otherwise.
+		 */
+		RankedSearchResult_t SearchRanked (const QString& accountId,
+				const QString& entryId, const QString& text, int limit);
+
 		DaysResult_t GetDaysForSheet (const QString& accountId, const QString& entryId, int year, int month);
 
 		boost::optional<int> GetAllHistoryCount ();
 
 		void RegenUsersCache ();
 		void ClearHistory (const QString& accountId, const QString& entryId);
+
+		/** @brief Indexes the next chunk of the messages predating the
+		 * full-text index.
+		 *
+		 * @return Whether there are still messages left to index.
+		 */
+		bool BackfillFTSIndex ();
+
+		/** @brief Drops the full-text index and starts building it anew.
+		 */
+		void ResetFTSIndex ();
 	private:
 		void InitializeTables ();
 		void UpdateTables ();
+		void MigrateMessageSeqs ();
+
+		bool CreateFTSIndex ();
+		void LoadFTSState ();
+		void PrepareFTSQueries ();
 
 		QHash<QString, qint32> GetUsers ();
 		qint32 GetUserID (const QString&);
 		void AddUser (const QString& id, const QString& accountId);
 
+		/** Adds the messages within the current transaction.
+		 *
+		 * The new message count of the entry is stored in \em counts
+		 * instead of MessageCounts_, which is only to be updated once
+		 * the transaction is committed. The previous count is taken
+		 * from \em counts as well if it's there.
+		 */
+		bool AddMessagesImpl (const QString& accountId, const QString& entryId,
+				const QString& visibleName, const QList<LogItem>&, bool fuzzy,
+				MessageCounts_t& counts);
+
 		void PrepareEntryCache ();
+		void PrepareMessageCounts ();
 
 		QHash<QString, qint32> GetAccounts ();
 		qint32 GetAccountID (const QString&);
@@ -148,7 +218,9 @@ namespace ChatHistory
 		RawSearchResult SearchImpl (const QString& accountId, const QString& text, int shift, bool cs);
 		RawSearchResult SearchImpl (const QString& text, int shift, bool cs);
 
-		SearchResult_t SearchRowIdImpl (qint32, qint32, qint64);
+		ChatLogsResult_t GetChatLogsImpl (qint32 accountId, qint32 entryId, HistorySeq_t lastSeq, int amount);
+
+		SearchResult_t SearchRowIdImpl (qint64);
 		SearchResult_t SearchDateImpl (qint32, qint32, const QDateTime&);
 	};
 }
@@ -28,8 +28,11 @@
  **********************************************************************/
 
 #include "storagemanager.h"
+#include <algorithm>
 #include <cmath>
+#include <QElapsedTimer>
 #include <QMessageBox>
+#include <QTimer>
 #include <util/util.h>
 #include <util/threads/futures.h>
 #include <util/threads/workerthreadbase.h>
@@ -41,6 +44,7 @@
 #include <interfaces/azoth/irichtextmessage.h>
 #include "storage.h"
 #include "loggingstatekeeper.h"
+#include "xmlsettingsmanager.h"
 
 namespace LeechCraft
 {
@@ -51,7 +55,14 @@ namespace ChatHistory
 	StorageManager::StorageManager (LoggingStateKeeper *keeper)
 	: StorageThread_ { std::make_shared<StorageThread> () }
 	, LoggingStateKeeper_ { keeper }
+	, FlushTimer_ { new QTimer { this } }
 	{
+		FlushTimer_->setSingleShot (true);
+		connect (FlushTimer_,
+				&QTimer::timeout,
+				this,
+				&StorageManager::Flush);
+
 		StorageThread_->SetPaused (true);
 		StorageThread_->SetAutoQuit (true);
 
@@ -61,6 +72,7 @@ namespace ChatHistory
 					if (res.IsRight ())
 					{
 						StorageThread_->SetPaused (false);
+						ScheduleFTSBackfill ();
 						return;
 					}
 
@@ -162,16 +174,95 @@ namespace ChatHistory
 	void StorageManager::AddLogItems (const QString& accountId, const QString& entryId,
 			const QString& visibleName, const QList<LogItem>& items, bool fuzzy)
 	{
-		StorageThread_->ScheduleImpl (&Storage::AddMessages,
-				accountId,
-				entryId,
-				visibleName,
-				items,
-				fuzzy);
+		if (items.isEmpty ())
+			return;
+
+		if (!Pending_.isEmpty ())
+		{
+			auto& last = Pending_.last ();
+			if (last.AccountId_ == accountId &&
+					last.EntryId_ == entryId &&
+					last.Fuzzy_ == fuzzy)
+			{
+				last.VisibleName_ = visibleName;
+				last.Items_ += items;
+			}
+			else
+				Pending_.append ({ accountId, entryId, visibleName, items, fuzzy });
+		}
+		else
+			Pending_.append ({ accountId, entryId, visibleName, items, fuzzy });
+
+		Stats_.QueueDepth_ += items.size ();
+
+		const auto& xsm = XmlSettingsManager::Instance ();
+		const auto interval = xsm.property ("WriteBehindInterval").toInt ();
+		const auto maxItems = xsm.property ("WriteBehindMaxItems").toInt ();
+		if (interval <= 0 || Stats_.QueueDepth_ >= maxItems)
+			Flush ();
+		else if (!FlushTimer_->isActive ())
+			FlushTimer_->start (interval);
+	}
+
+	QFuture<void> StorageManager::Flush ()
+	{
+		FlushTimer_->stop ();
+
+		if (Pending_.isEmpty ())
+			return {};
+
+		const auto itemsCount = Stats_.QueueDepth_;
+		Stats_.QueueDepth_ = 0;
+
+		QElapsedTimer timer;
+		timer.start ();
+		const auto future = StorageThread_->ScheduleImpl (&Storage::AddMessagesBatch, Pending_);
+		Util::Sequence (this, future) >>
+				[this, timer, itemsCount]
+				{
+					const auto latency = timer.elapsed ();
+					++Stats_.FlushCount_;
+					Stats_.FlushedItems_ += itemsCount;
+					Stats_.LastFlushLatency_ = latency;
+					Stats_.MaxFlushLatency_ = std::max (Stats_.MaxFlushLatency_, latency);
+					Stats_.TotalFlushLatency_ += latency;
+				};
+
+		Pending_.clear ();
+
+		return future;
+	}
+
+	void StorageManager::FlushSync ()
+	{
+		const auto future = Flush ();
+
+		// The thread isn't started until the DB passes the consistency
+		// check, and nothing would ever finish the future then.
+		if (StorageThread_->isRunning ())
+			future.waitForFinished ();
+	}
+
+	WriteBehindStats StorageManager::GetWriteBehindStats () const
+	{
+		return Stats_;
+	}
+
+	void StorageManager::FlushFor (const QString& accountId, const QString& entryId)
+	{
+		const auto pos = std::find_if (Pending_.begin (), Pending_.end (),
+				[&] (const PendingLogItems& pending)
+				{
+					return (accountId.isEmpty () || pending.AccountId_ == accountId) &&
+							(entryId.isEmpty () || pending.EntryId_ == entryId);
+				});
+		if (pos != Pending_.end ())
+			Flush ();
 	}
 
 	QFuture<IHistoryPlugin::MaxTimestampResult_t> StorageManager::GetMaxTimestamp (const QString& accId)
 	{
+		FlushFor (accId, {});
 		return StorageThread_->ScheduleImpl (&Storage::GetMaxTimestamp, accId);
 	}
 
@@ -188,27 +279,46 @@ namespace ChatHistory
 	QFuture<ChatLogsResult_t> StorageManager::GetChatLogs (const QString& accountId,
 			const QString& entryId, int backpages, int amount)
 	{
+		FlushFor (accountId, entryId);
 		return StorageThread_->ScheduleImpl (&Storage::GetChatLogs, accountId, entryId, backpages, amount);
 	}
 
+	QFuture<ChatLogsPageResult_t> StorageManager::GetChatLogsPage (const QString& accountId,
+			const QString& entryId, HistorySeq_t lastSeq, int amount)
+	{
+		FlushFor (accountId, entryId);
+		return StorageThread_->ScheduleImpl (&Storage::GetChatLogsPage, accountId, entryId, lastSeq, amount);
+	}
+
 	QFuture<SearchResult_t> StorageManager::Search (const QString& accountId, const QString& entryId,
 			const QString& text, int shift, bool cs)
 	{
+		FlushFor (accountId, entryId);
 		return StorageThread_->ScheduleImpl (&Storage::Search, accountId, entryId, text, shift, cs);
 	}
 
 	QFuture<SearchResult_t> StorageManager::Search (const QString& accountId, const QString& entryId, const QDateTime& dt)
 	{
+		FlushFor (accountId, entryId);
 		return StorageThread_->ScheduleImpl (&Storage::SearchDate, accountId, entryId, dt);
 	}
 
+	QFuture<RankedSearchResult_t> StorageManager::SearchRanked (const QString& accountId,
+			const QString& entryId, const QString& text, int limit)
+	{
+		FlushFor (accountId, entryId);
+		return StorageThread_->ScheduleImpl (&Storage::SearchRanked, accountId, entryId, text, limit);
+	}
+
 	QFuture<DaysResult_t> StorageManager::GetDaysForSheet (const QString& accountId, const QString& entryId, int year, int month)
 	{
+		FlushFor (accountId, entryId);
 		return StorageThread_->ScheduleImpl (&Storage::GetDaysForSheet, accountId, entryId, year, month);
 	}
 
 	void StorageManager::ClearHistory (const QString& accountId, const QString& entryId)
 	{
+		FlushFor (accountId, entryId);
 		StorageThread_->ScheduleImpl (&Storage::ClearHistory, accountId, entryId);
 	}
 
@@ -223,6 +333,17 @@ namespace ChatHistory
 		StorageThread_->start (QThread::LowestPriority);
 	}
 
+	void StorageManager::ScheduleFTSBackfill ()
+	{
+		Util::Sequence (this,
+				StorageThread_->ScheduleImpl (Util::TaskParams { Util::TaskPriority::Low }, &Storage::BackfillFTSIndex)) >>
+				[this] (bool hasMore)
+				{
+					if (hasMore)
+						ScheduleFTSBackfill ();
+				};
+	}
+
 	void StorageManager::HandleStorageError (const Storage::InitializationError_t& error)
 	{
 		Util::Visit (error,
@@ -239,6 +360,9 @@ namespace ChatHistory
 	{
 		StartStorage ();
 
+		// the restored rows don't necessarily keep their rowids
+		StorageThread_->ScheduleImpl (&Storage::ResetFTSIndex);
+
 		Util::Sequence (this, StorageThread_->ScheduleImpl (&Storage::GetAllHistoryCount)) >>
 				[=] (const boost::optional<int>& count)
 				{
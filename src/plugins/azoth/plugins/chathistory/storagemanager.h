@@ -32,6 +32,8 @@
 #include "storage.h"
 #include <util/threads/workerthreadbasefwd.h>
 
+class QTimer;
+
 namespace LeechCraft
 {
 namespace Azoth
@@ -43,16 +45,77 @@ namespace ChatHistory
 
 	class LoggingStateKeeper;
 
+	/** @brief Statistics of the write-behind message queue.
+	 */
+	struct WriteBehindStats
+	{
+		/** @brief The number of messages waiting to be flushed.
+		 */
+		int QueueDepth_ = 0;
+
+		/** @brief The number of flushes completed so far.
+		 */
+		quint64 FlushCount_ = 0;
+
+		/** @brief The number of messages flushed so far.
+		 */
+		quint64 FlushedItems_ = 0;
+
+		/** @brief The latency of the last flush, in milliseconds.
+		 *
+		 * This is the time between scheduling the flush and it being
+		 * committed by the storage thread.
+		 */
+		qint64 LastFlushLatency_ = 0;
+
+		/** @brief The maximum flush latency seen so far, in milliseconds.
+		 */
+		qint64 MaxFlushLatency_ = 0;
+
+		/** @brief The sum of all flush latencies, in milliseconds.
+		 */
+		qint64 TotalFlushLatency_ = 0;
+	};
+
 	class StorageManager : public QObject
 	{
 		const std::shared_ptr<StorageThread> StorageThread_;
 		LoggingStateKeeper * const LoggingStateKeeper_;
+
+		QTimer * const FlushTimer_;
+		QList<PendingLogItems> Pending_;
+		WriteBehindStats Stats_;
 	public:
 		StorageManager (LoggingStateKeeper*);
 
 		void Process (QObject*);
 		void AddLogItems (const QString&, const QString&, const QString&, const QList<LogItem>&, bool);
 
+		/** @brief Schedules storing all the queued messages.
+		 *
+		 * The messages passed to Process() and AddLogItems() are
+		 * buffered for up to the configured interval or count and then
+		 * written in a single transaction. This function writes them
+		 * immediately. Since the storage thread executes the tasks in
+		 * order, any request scheduled after this call sees the
+		 * flushed messages.
+		 *
+		 * @return The future finishing when the messages are written,
+		 * or a finished future if there was nothing to write.
+		 */
+		QFuture<void> Flush ();
+
+		/** @brief Writes the buffered messages and waits for them.
+		 *
+		 * This function is like Flush(), but it blocks until the
+		 * messages are written. It is meant to be called on shutdown,
+		 * since the storage thread doesn't run the tasks left in its
+		 * queue when it's stopped.
+		 */
+		void FlushSync ();
+
+		WriteBehindStats GetWriteBehindStats () const;
+
 		QFuture<IHistoryPlugin::MaxTimestampResult_t> GetMaxTimestamp (const QString&);
 
 		QFuture<QStringList> GetOurAccounts ();
@@ -61,17 +124,24 @@ namespace ChatHistory
 
 		QFuture<ChatLogsResult_t> GetChatLogs (const QString& accountId, const QString& entryId,
 				int backpages, int amount);
+		QFuture<ChatLogsPageResult_t> GetChatLogsPage (const QString& accountId, const QString& entryId,
+				HistorySeq_t lastSeq, int amount);
 
 		QFuture<SearchResult_t> Search (const QString& accountId, const QString& entryId,
 				const QString& text, int shift, bool cs);
 		QFuture<SearchResult_t> Search (const QString& accountId, const QString& entryId, const QDateTime& dt);
+		QFuture<RankedSearchResult_t> SearchRanked (const QString& accountId, const QString& entryId,
+				const QString& text, int limit);
 
 		QFuture<DaysResult_t> GetDaysForSheet (const QString& accountId, const QString& entryId, int year, int month);
 		void ClearHistory (const QString& accountId, const QString& entryId);
 
 		void RegenUsersCache ();
 	private:
+		void FlushFor (const QString& accountId, const QString& entryId);
+
 		void StartStorage ();
+		void ScheduleFTSBackfill ();
 		void HandleStorageError (const Storage::InitializationError_t&);
 		void HandleDumpFinished (qint64, qint64);
 	};
@@ -54,7 +54,67 @@ namespace ChatHistory
 
 	using ChatLogsResult_t = Util::Either<QString, LogList_t>;
 
-	using SearchResult_t = Util::Either<QString, boost::optional<int>>;
+	/** @brief Messages waiting to be stored for a single entry.
+	 */
+	struct PendingLogItems
+	{
+		QString AccountId_;
+		QString EntryId_;
+		QString VisibleName_;
+		LogList_t Items_;
+		bool Fuzzy_;
+	};
+
+	/** @brief The sequence number of a message in its conversation.
+	 *
+	 * The messages of each (account, entry) pair are numbered from 1 in
+	 * the order they are stored in, without gaps. Thus, there are
+	 * exactly <code>Total - seq</code> messages after the message with
+	 * the sequence number \em seq, where \em Total is the number of
+	 * messages in the conversation.
+	 */
+	using HistorySeq_t = qint64;
+
+	/** @brief A page of the history of a conversation.
+	 */
+	struct ChatLogsPage
+	{
+		/** @brief The messages, the oldest one first.
+		 */
+		LogList_t Items_;
+
+		/** @brief The sequence number of the first message in Items_.
+		 */
+		HistorySeq_t FirstSeq_ = 0;
+
+		/** @brief The total number of messages in the conversation.
+		 */
+		HistorySeq_t Total_ = 0;
+	};
+
+	using ChatLogsPageResult_t = Util::Either<QString, ChatLogsPage>;
+
+	using SearchResult_t = Util::Either<QString, boost::optional<HistorySeq_t>>;
+
+	/** @brief A single message found by the full-text search.
+	 */
+	struct SearchHit
+	{
+		QString AccountID_;
+		QString EntryID_;
+		QDateTime Date_;
+		QString Message_;
+
+		/** @brief The number of messages after this one in the history
+		 * of this entry.
+		 *
+		 * This is the same kind of position as returned by the
+		 * Storage::Search() family of functions.
+		 */
+		int Position_;
+	};
+
+	using RankedSearchResult_t = Util::Either<QString, QList<SearchHit>>;
 
 	using DaysResult_t = Util::Either<QString, QList<int>>;
 }
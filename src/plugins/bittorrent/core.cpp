@@ -57,6 +57,8 @@
 #include <QDataStream>
 #include <QDesktopServices>
 #include <QUrlQuery>
+#include <QtAlgorithms>
+#include <QtConcurrentMap>
 #include <libtorrent/bencode.hpp>
 #include <libtorrent/entry.hpp>
 #include <libtorrent/create_torrent.hpp>
@@ -98,6 +100,8 @@
 #include "cachedstatuskeeper.h"
 #include "geoip.h"
 #include "sessionstats.h"
+#include "resumestore.h"
+#include "statussnapshot.h"
 
 Q_DECLARE_METATYPE (QMenu*)
 Q_DECLARE_METATYPE (QToolBar*)
@@ -120,6 +124,7 @@ namespace BitTorrent
 	, FinishedTimer_ { new QTimer }
 	, WarningWatchdog_ { new QTimer }
 	, GeoIP_ { std::make_shared<GeoIP> () }
+	, Snapshot_ { std::make_shared<StatusSnapshot> () }
 	{
 		setObjectName ("BitTorrent Core");
 		ExternalAddress_ = tr ("Unknown");
@@ -177,6 +182,8 @@ namespace BitTorrent
 
 	void Core::DoDelayedInit ()
 	{
+		ResumeStore_ = new ResumeStore { this };
+
 		try
 		{
 			libtorrent::settings_pack pack;
@@ -246,6 +253,10 @@ namespace BitTorrent
 		Session_->pause ();
 		writeSettings ();
 
+		Session_->wait_for_alert (libtorrent::time_duration (5));
+		queryLibtorrent ();
+		ResumeStore_->WaitForDone ();
+
 		FinishedTimer_.reset ();
 		WarningWatchdog_.reset ();
 
@@ -414,30 +425,31 @@ namespace BitTorrent
 			return "Uninitialized?!";
 		}
 
-		QString GetStringForStatus (const libtorrent::torrent_status& status)
+		QString GetStringForStatus (libtorrent::torrent_status::state_t state, bool paused, bool hasError,
+				qint64 wanted, qint64 wantedDone, int downloadRate)
 		{
-			const auto& stateStr = GetStringForState (status.state);
-			if (status.state == libtorrent::torrent_status::downloading)
+			const auto& stateStr = GetStringForState (state);
+			if (state == libtorrent::torrent_status::downloading)
 			{
-				if (!status.error.empty ())
+				if (hasError)
 				{
 					static const auto errorStr = Core::tr ("Error");
 					return errorStr;
 				}
 
-				if (status.paused)
+				if (paused)
 				{
 					static const auto pausedStr = Core::tr ("Paused");
 					return pausedStr;
 				}
 
-				const auto remaining = status.total_wanted - status.total_wanted_done;
-				const auto time = static_cast<double> (remaining) / status.download_rate;
+				const auto remaining = wanted - wantedDone;
+				const auto time = static_cast<double> (remaining) / downloadRate;
 				return QString ("%1 (ETA: %2)")
 					.arg (stateStr)
 					.arg (Util::MakeTimeFromLong (time));
 			}
-			else if (status.paused)
+			else if (paused)
 			{
 				static const auto idleStr = Core::tr ("Idle");
 				return idleStr;
@@ -445,6 +457,33 @@ namespace BitTorrent
 			else
 				return stateStr;
 		}
+
+		QString GetStringForStatus (const libtorrent::torrent_status& status)
+		{
+			return GetStringForStatus (status.state, status.paused, !status.error.empty (),
+					status.total_wanted, status.total_wanted_done, status.download_rate);
+		}
+
+		QString GetStringForStatus (const StatusSnapshot::Row& status)
+		{
+			return GetStringForStatus (status.State_, status.Paused_, !status.Error_.isEmpty (),
+					status.TotalWanted_, status.TotalWantedDone_, status.DownloadRate_);
+		}
+	}
+
+	namespace
+	{
+		QVariant MakeProcessState (bool hasError, bool paused,
+				qint64 done, qint64 total, TaskParameters params)
+		{
+			ProcessStateInfo::State state = ProcessStateInfo::State::Running;
+			if (hasError)
+				state = ProcessStateInfo::State::Error;
+			else if (paused)
+				state = ProcessStateInfo::State::Paused;
+
+			return QVariant::fromValue<ProcessStateInfo> ({ done, total, params, state });
+		}
 	}
 
 	QVariant Core::data (const QModelIndex& index, int role) const
@@ -462,10 +501,41 @@ namespace BitTorrent
 		if (!CheckValidity (row))
 			return QVariant ();
 
-		const auto& h = Handles_.at (row).Handle_;
-		const auto& status = StatusKeeper_->GetStatus (h,
-				libtorrent::torrent_handle::query_name |
-				libtorrent::torrent_handle::query_save_path);
+		const auto& torrent = Handles_.at (row);
+
+		// These don't depend on the torrent status, so they are served even if the torrent isn't in the snapshot yet.
+		switch (role)
+		{
+		case RoleTags:
+			return torrent.Tags_;
+		case CustomDataRoles::RoleJobHolderRow:
+			return QVariant::fromValue<JobHolderRow> (JobHolderRow::DownloadProgress);
+		default:
+			break;
+		}
+
+		const auto slot = Snapshot_->GetSlot (torrent.Handle_);
+
+		if (role == JobHolderRole::ProcessState)
+		{
+			if (slot >= 0)
+			{
+				const auto& status = Snapshot_->GetRow (slot);
+				return MakeProcessState (!status.Error_.isEmpty (), status.Paused_,
+						status.TotalWantedDone_, status.TotalWanted_, torrent.Parameters_);
+			}
+
+			const auto& status = StatusKeeper_->GetStatus (torrent.Handle_);
+			return MakeProcessState (!status.error.empty (), status.paused,
+					status.total_wanted_done, status.total_wanted, torrent.Parameters_);
+		}
+
+		if (slot < 0)
+			return column == ColumnID && (role == Qt::DisplayRole || role == Roles::SortRole) ?
+					QVariant { row + 1 } :
+					QVariant {};
+
+		const auto& status = Snapshot_->GetRow (slot);
 
 		switch (role)
 		{
@@ -473,13 +543,13 @@ namespace BitTorrent
 			if (column != ColumnName)
 				return {};
 
-			if (!status.error.empty ())
+			if (!status.Error_.isEmpty ())
 				return QIcon::fromTheme ("dialog-error");
 
-			if (status.paused)
+			if (status.Paused_)
 				return QIcon::fromTheme ("media-playback-stop");
 
-			switch (status.state)
+			switch (status.State_)
 			{
 			case libtorrent::torrent_status::queued_for_checking:
 			case libtorrent::torrent_status::checking_files:
@@ -503,32 +573,32 @@ namespace BitTorrent
 			case ColumnID:
 				return row + 1;
 			case ColumnName:
-				return QString::fromStdString (status.name);
+				return status.Name_;
 			case ColumnState:
-				return status.paused ?
+				return status.Paused_ ?
 						-1 :
-						static_cast<int> (status.state);
+						static_cast<int> (status.State_);
 			case ColumnProgress:
-				return status.progress;
+				return status.Progress_;
 			case ColumnDownSpeed:
-				return status.download_payload_rate;
+				return status.DownloadPayloadRate_;
 			case ColumnUpSpeed:
-				return status.upload_payload_rate;
+				return status.UploadPayloadRate_;
 			case ColumnLeechers:
-				return status.num_peers - status.num_seeds;
+				return status.NumPeers_ - status.NumSeeds_;
 			case ColumnSeeders:
-				return status.num_seeds;
+				return status.NumSeeds_;
 			case ColumnDownloaded:
-				return static_cast<quint64> (status.all_time_download);
+				return static_cast<quint64> (status.AllTimeDownload_);
 			case ColumnSize:
-				return static_cast<quint64> (status.total_wanted);
+				return static_cast<quint64> (status.TotalWanted_);
 			case ColumnUploaded:
-				return static_cast<quint64> (status.all_time_upload);
+				return static_cast<quint64> (status.AllTimeUpload_);
 			case ColumnRatio:
-				if (status.all_time_download)
-					return static_cast<double> (status.all_time_upload) / status.all_time_download;
+				if (status.AllTimeDownload_)
+					return static_cast<double> (status.AllTimeUpload_) / status.AllTimeDownload_;
 
-				return status.all_time_upload ?
+				return status.AllTimeUpload_ ?
 						std::numeric_limits<double>::max () :
 						0;
 			default:
@@ -541,96 +611,96 @@ namespace BitTorrent
 			case ColumnID:
 				return row + 1;
 			case ColumnName:
-				return QString::fromStdString (status.name);
+				return status.Name_;
 			case ColumnState:
 				return GetStringForStatus (status);
 			case ColumnProgress:
 				if (role == Roles::FullLengthText)
 				{
-					if (status.state == libtorrent::torrent_status::downloading)
+					if (status.State_ == libtorrent::torrent_status::downloading)
 					{
 						static const auto templ = tr ("%1% (%2 of %3 at %4 from %5 peers)");
 						return templ
-								.arg (status.progress * 100, 0, 'f', 2)
-								.arg (Util::MakePrettySize (status.total_wanted_done))
-								.arg (Util::MakePrettySize (status.total_wanted))
-								.arg (Util::MakePrettySize (status.download_payload_rate) +
+								.arg (status.Progress_ * 100, 0, 'f', 2)
+								.arg (Util::MakePrettySize (status.TotalWantedDone_))
+								.arg (Util::MakePrettySize (status.TotalWanted_))
+								.arg (Util::MakePrettySize (status.DownloadPayloadRate_) +
 										tr ("/s"))
-								.arg (status.num_peers);
+								.arg (status.NumPeers_);
 					}
-					else if (!status.paused &&
-								(status.state == libtorrent::torrent_status::finished ||
-								status.state == libtorrent::torrent_status::seeding))
+					else if (!status.Paused_ &&
+								(status.State_ == libtorrent::torrent_status::finished ||
+								status.State_ == libtorrent::torrent_status::seeding))
 					{
-						auto total = status.num_incomplete;
+						auto total = status.NumIncomplete_;
 						if (total <= 0)
-							total = status.list_peers - status.list_seeds;
+							total = status.ListPeers_ - status.ListSeeds_;
 						static const auto templ = tr ("%1, seeding at %2 to %3 leechers (of around %4)");
 						return templ
-								.arg (Util::MakePrettySize (status.total_wanted))
-								.arg (Util::MakePrettySize (status.upload_payload_rate) +
+								.arg (Util::MakePrettySize (status.TotalWanted_))
+								.arg (Util::MakePrettySize (status.UploadPayloadRate_) +
 										tr ("/s"))
-								.arg (status.num_peers - status.num_seeds)
+								.arg (status.NumPeers_ - status.NumSeeds_)
 								.arg (total);
 					}
 					else
 					{
 						static const auto templ = tr ("%1% (%2 of %3)");
 						return templ
-								.arg (status.progress * 100, 0, 'f', 2)
-								.arg (Util::MakePrettySize (status.total_wanted_done))
-								.arg (Util::MakePrettySize (status.total_wanted));
+								.arg (status.Progress_ * 100, 0, 'f', 2)
+								.arg (Util::MakePrettySize (status.TotalWantedDone_))
+								.arg (Util::MakePrettySize (status.TotalWanted_));
 					}
 				}
 				else
 				{
-					if (status.state == libtorrent::torrent_status::downloading)
+					if (status.State_ == libtorrent::torrent_status::downloading)
 					{
 						static const auto templ = tr ("%1% (%2 of %3)");
 						return templ
-								.arg (status.progress * 100, 0, 'f', 2)
-								.arg (Util::MakePrettySize (status.total_wanted_done))
-								.arg (Util::MakePrettySize (status.total_wanted));
+								.arg (status.Progress_ * 100, 0, 'f', 2)
+								.arg (Util::MakePrettySize (status.TotalWantedDone_))
+								.arg (Util::MakePrettySize (status.TotalWanted_));
 					}
-					else if (!status.paused &&
-								(status.state == libtorrent::torrent_status::finished ||
-								status.state == libtorrent::torrent_status::seeding))
+					else if (!status.Paused_ &&
+								(status.State_ == libtorrent::torrent_status::finished ||
+								status.State_ == libtorrent::torrent_status::seeding))
 					{
 						static const auto templ = tr ("100% (%1)");
 						return templ
-								.arg (Util::MakePrettySize (status.total_wanted));
+								.arg (Util::MakePrettySize (status.TotalWanted_));
 					}
 					else
 					{
 						static const auto templ = tr ("%1% (%2 of %3)");
 						return templ
-								.arg (status.progress * 100, 0, 'f', 2)
-								.arg (Util::MakePrettySize (status.total_wanted_done))
-								.arg (Util::MakePrettySize (status.total_wanted));
+								.arg (status.Progress_ * 100, 0, 'f', 2)
+								.arg (Util::MakePrettySize (status.TotalWantedDone_))
+								.arg (Util::MakePrettySize (status.TotalWanted_));
 					}
 				}
 			case ColumnDownSpeed:
-				return Util::MakePrettySize (status.download_payload_rate) + tr ("/s");
+				return Util::MakePrettySize (status.DownloadPayloadRate_) + tr ("/s");
 			case ColumnUpSpeed:
-				return Util::MakePrettySize (status.upload_payload_rate) + tr ("/s");
+				return Util::MakePrettySize (status.UploadPayloadRate_) + tr ("/s");
 			case ColumnLeechers:
-				return QString::number (status.num_peers - status.num_seeds);
+				return QString::number (status.NumPeers_ - status.NumSeeds_);
 			case ColumnSeeders:
-				return QString::number (status.num_seeds);
+				return QString::number (status.NumSeeds_);
 			case ColumnDownloaded:
-				return Util::MakePrettySize (status.all_time_download);
+				return Util::MakePrettySize (status.AllTimeDownload_);
 			case ColumnSize:
-				return Util::MakePrettySize (status.total_wanted);
+				return Util::MakePrettySize (status.TotalWanted_);
 			case ColumnUploaded:
-				return Util::MakePrettySize (status.all_time_upload);
+				return Util::MakePrettySize (status.AllTimeUpload_);
 			case ColumnRatio:
-				if (status.all_time_download)
+				if (status.AllTimeDownload_)
 				{
-					const auto ratio = static_cast<double> (status.all_time_upload) / status.all_time_download;
+					const auto ratio = static_cast<double> (status.AllTimeUpload_) / status.AllTimeDownload_;
 					return QString::number (ratio, 'f', 2);
 				}
 
-				return status.all_time_upload ?
+				return status.AllTimeUpload_ ?
 						QString::fromUtf8 ("∞") :
 						"0";
 			default:
@@ -639,46 +709,27 @@ namespace BitTorrent
 		case Qt::ToolTipRole:
 		{
 			QString result;
-			const auto& name = QString::fromStdString (status.name);
+			const auto& name = status.Name_;
 			result += tr ("Name:") + " " + name + "\n";
 			result += tr ("Destination:") + " " +
-				QString::fromStdString (status.save_path) + "\n";
+				status.SavePath_ + "\n";
 			result += tr ("Progress:") + " " +
 				QString (tr ("%1% (%2 of %3)")
-						.arg (status.progress * 100, 0, 'f', 2)
-						.arg (Util::MakePrettySize (status.total_wanted_done))
-						.arg (Util::MakePrettySize (status.total_wanted))) + "\n";
+						.arg (status.Progress_ * 100, 0, 'f', 2)
+						.arg (Util::MakePrettySize (status.TotalWantedDone_))
+						.arg (Util::MakePrettySize (status.TotalWanted_))) + "\n";
 			result += tr ("Status:") + " " + GetStringForStatus (status);
-			if (!status.error.empty ())
-				result += " (" + QString::fromUtf8 (status.error.c_str ()) + ")";
+			if (!status.Error_.isEmpty ())
+				result += " (" + status.Error_ + ")";
 			result += "\n";
 
 			result += tr ("Downloading speed:") + " " +
-				Util::MakePrettySize (status.download_payload_rate) + tr ("/s") +
+				Util::MakePrettySize (status.DownloadPayloadRate_) + tr ("/s") +
 				tr ("; uploading speed:") + " " +
-				Util::MakePrettySize (status.upload_payload_rate) + tr ("/s") + "\n";
-			result += tr ("Peers/seeds: %1/%2").arg (status.num_peers).arg (status.num_seeds);
+				Util::MakePrettySize (status.UploadPayloadRate_) + tr ("/s") + "\n";
+			result += tr ("Peers/seeds: %1/%2").arg (status.NumPeers_).arg (status.NumSeeds_);
 			return result;
 		}
-		case RoleTags:
-			return Handles_.at (row).Tags_;
-		case CustomDataRoles::RoleJobHolderRow:
-			return QVariant::fromValue<JobHolderRow> (JobHolderRow::DownloadProgress);
-		case JobHolderRole::ProcessState:
-		{
-			ProcessStateInfo::State state = ProcessStateInfo::State::Running;
-			if (!status.error.empty ())
-				state = ProcessStateInfo::State::Error;
-			else if (status.paused)
-				state = ProcessStateInfo::State::Paused;
-
-			return QVariant::fromValue<ProcessStateInfo> ({
-					status.total_wanted_done,
-					status.total_wanted,
-					Handles_.at (row).Parameters_,
-					state
-				});
-		}
 		default:
 			return QVariant ();
 		}
@@ -1060,6 +1111,7 @@ namespace BitTorrent
 			options |= libtorrent::session::delete_files;
 #endif
 		Session_->remove_torrent (Handles_.at (pos).Handle_, options);
+		Snapshot_->Remove (Handles_.at (pos).Handle_);
 
 		Handles_.removeAt (pos);
 
@@ -1358,12 +1410,14 @@ namespace BitTorrent
 					0);
 		Session_->set_ip_filter (filter);
 
+		IPFilterDirty_ = true;
 		ScheduleSave ();
 	}
 
 	void Core::ClearFilter ()
 	{
 		Session_->set_ip_filter (libtorrent::ip_filter ());
+		IPFilterDirty_ = true;
 		ScheduleSave ();
 	}
 
@@ -1418,23 +1472,9 @@ namespace BitTorrent
 			return;
 		}
 
-		const auto& filePath = Util::CreateIfNotExists ("bittorrent")
-				.filePath (torrent->TorrentFileName_ + ".resume");
-		QFile file { filePath };
-
-		if (!file.open (QIODevice::WriteOnly))
-		{
-			qWarning () << QString ("Could not open file %1 for write: %2")
-				.arg (file.fileName ())
-				.arg (file.errorString ());
-			return;
-		}
-
-		std::deque<char> outbuf;
+		QByteArray outbuf;
 		libtorrent::bencode (std::back_inserter (outbuf), *a.resume_data.get ());
-
-		for (size_t i = 0; i < outbuf.size (); ++i)
-			file.write (&outbuf.at (i), 1);
+		ResumeStore_->WriteResumeData (torrent->TorrentFileName_, outbuf);
 	}
 
 	void Core::HandleMetadata (const libtorrent::metadata_received_alert& a)
@@ -1479,21 +1519,66 @@ namespace BitTorrent
 		LiveStreamManager_->PieceRead (a);
 	}
 
+	namespace
+	{
+		quint32 GetChangedColumns (quint32 fields)
+		{
+			using F = StatusSnapshot::Field;
+
+			auto col = [] (Core::Columns column) { return 1u << column; };
+
+			const std::initializer_list<std::pair<quint32, quint32>> field2cols
+			{
+				{ F::FName, col (Core::ColumnName) },
+				{ F::FError, col (Core::ColumnName) | col (Core::ColumnState) },
+				{ F::FState, col (Core::ColumnName) | col (Core::ColumnState) | col (Core::ColumnProgress) },
+				{ F::FPaused, col (Core::ColumnName) | col (Core::ColumnState) | col (Core::ColumnProgress) },
+				{ F::FProgress, col (Core::ColumnProgress) | col (Core::ColumnState) },
+				{ F::FDownRate, col (Core::ColumnDownSpeed) | col (Core::ColumnProgress) | col (Core::ColumnState) },
+				{ F::FUpRate, col (Core::ColumnUpSpeed) | col (Core::ColumnProgress) },
+				{ F::FPeers, col (Core::ColumnLeechers) | col (Core::ColumnProgress) },
+				{ F::FSeeds, col (Core::ColumnLeechers) | col (Core::ColumnSeeders) | col (Core::ColumnProgress) },
+				{ F::FSwarm, col (Core::ColumnProgress) },
+				{ F::FWanted, col (Core::ColumnSize) | col (Core::ColumnProgress) | col (Core::ColumnState) },
+				{ F::FAllTimeDownload, col (Core::ColumnDownloaded) | col (Core::ColumnRatio) },
+				{ F::FAllTimeUpload, col (Core::ColumnUploaded) | col (Core::ColumnRatio) }
+			};
+
+			quint32 result = 0;
+			for (const auto& pair : field2cols)
+				if (fields & pair.first)
+					result |= pair.second;
+			return result;
+		}
+	}
+
 	void Core::UpdateStatus (const std::vector<libtorrent::torrent_status>& statuses)
 	{
+		QMap<libtorrent::torrent_handle, int> handle2row;
+
 		for (const auto& status : statuses)
 		{
 			StatusKeeper_->HandleStatusUpdatePosted (status);
-			const auto pos = FindHandle (status.handle);
-			if (pos == Handles_.end ())
+
+			const auto columns = GetChangedColumns (Snapshot_->Update (status));
+			if (!columns)
+				continue;
+
+			if (handle2row.isEmpty ())
+				for (int i = 0; i < Handles_.size (); ++i)
+					handle2row [Handles_.at (i).Handle_] = i;
+
+			const auto row = handle2row.value (status.handle, -1);
+			if (row < 0)
 			{
 				qWarning () << Q_FUNC_INFO
 						<< "unknown handle";
 				continue;
 			}
 
-			const auto row = std::distance (Handles_.begin (), pos);
-			emit dataChanged (index (row, 0), index (row, columnCount () - 1));
+			const auto first = qCountTrailingZeroBits (columns);
+			const auto last = 31 - qCountLeadingZeroBits (columns);
+			emit dataChanged (index (row, first), index (row, last));
 		}
 	}
 
@@ -1668,6 +1753,85 @@ namespace BitTorrent
 		endInsertRows ();
 	}
 
+	namespace
+	{
+		struct PreparedTorrent
+		{
+			ResumeRecord Record_;
+			QString Path_;
+
+			QByteArray Data_;
+			QByteArray ResumeData_;
+			lt_lib::shared_ptr<libtorrent::torrent_info> Info_;
+		};
+
+		void PrepareTorrent (PreparedTorrent& torrent)
+		{
+			QFile file { torrent.Path_ };
+			if (!file.open (QIODevice::ReadOnly))
+			{
+				qWarning () << Q_FUNC_INFO
+						<< "could not open saved torrent"
+						<< file.fileName ()
+						<< file.errorString ();
+				return;
+			}
+			torrent.Data_ = file.readAll ();
+			if (torrent.Data_.isEmpty ())
+				return;
+
+			QFile resumeFile { torrent.Path_ + ".resume" };
+			if (resumeFile.open (QIODevice::ReadOnly))
+				torrent.ResumeData_ = resumeFile.readAll ();
+
+			libtorrent::bdecode_node e;
+			if (!DecodeEntry (torrent.Data_, e))
+				return;
+
+			try
+			{
+				torrent.Info_ = lt_lib::make_shared<libtorrent::torrent_info> (e);
+			}
+			catch (const std::exception& ex)
+			{
+				qWarning () << Q_FUNC_INFO
+						<< torrent.Record_.Filename_
+						<< ex.what ();
+			}
+		}
+
+		QList<ResumeRecord> LoadLegacyRecords (QSettings& settings)
+		{
+			QList<ResumeRecord> result;
+
+			const int torrents = settings.beginReadArray ("AddedTorrents");
+			for (int i = 0; i < torrents; ++i)
+			{
+				settings.setArrayIndex (i);
+				result.append ({
+						settings.value ("Filename").toString (),
+						settings.value ("SavePath").toString (),
+						settings.value ("Tags").toStringList (),
+						settings.value ("Parameters").toInt (),
+						settings.value ("AutoManaged", true).toBool (),
+						settings.value ("Priorities").toByteArray ()
+					});
+			}
+			settings.endArray ();
+
+			return result;
+		}
+
+		void RemoveLegacyRecords ()
+		{
+			QSettings settings (QCoreApplication::organizationName (),
+					QCoreApplication::applicationName () + "_Torrent");
+			settings.beginGroup ("Core");
+			settings.remove ("AddedTorrents");
+			settings.endGroup ();
+		}
+	}
+
 	void Core::RestoreTorrents ()
 	{
 		const auto& torrentsDir = Util::CreateIfNotExists ("bittorrent");
@@ -1675,44 +1839,45 @@ namespace BitTorrent
 		QSettings settings (QCoreApplication::organizationName (),
 				QCoreApplication::applicationName () + "_Torrent");
 		settings.beginGroup ("Core");
-		int torrents = settings.beginReadArray ("AddedTorrents");
-		qDebug () << Q_FUNC_INFO << "gonna restore" << torrents << "torrents";
-		for (int i = 0; i < torrents; ++i)
+
+		auto records = ResumeStore_->Load ();
+		if (!records)
 		{
-			settings.setArrayIndex (i);
-			const auto& pathStr = settings.value ("SavePath").toString ();
-			const auto& path = std::string (pathStr.toUtf8 ().constData ());
-			QString filename = settings.value ("Filename").toString ();
-			QFile torrent (torrentsDir.filePath (filename));
-			if (!torrent.open (QIODevice::ReadOnly))
+			records = LoadLegacyRecords (settings);
+			HasLegacyRecords_ = true;
+		}
+		else
+			settings.remove ("AddedTorrents");
+
+		qDebug () << Q_FUNC_INFO << "gonna restore" << records->size () << "torrents";
+
+		QList<PreparedTorrent> prepared;
+		for (const auto& record : *records)
+			prepared.append ({ record, torrentsDir.filePath (record.Filename_), {}, {}, {} });
+		QtConcurrent::blockingMap (prepared, PrepareTorrent);
+
+		for (const auto& torrent : prepared)
+		{
+			const auto& filename = torrent.Record_.Filename_;
+			if (torrent.Data_.isEmpty ())
 			{
 				ShowError (tr ("Could not open saved torrent %1 for read.").arg (filename));
 				continue;
 			}
-			QByteArray data = torrent.readAll ();
-			torrent.close ();
-			if (data.isEmpty ())
-			{
-				qWarning () << Q_FUNC_INFO
-						<< "empty torrent data for"
-						<< filename;
+			if (!torrent.Info_)
 				continue;
-			}
 
-			QFile resumeDataFile (torrentsDir.filePath (filename + ".resume"));
-			QByteArray resumed;
-			if (resumeDataFile.open (QIODevice::ReadOnly))
-			{
-				resumed = resumeDataFile.readAll ();
-				resumeDataFile.close ();
-			}
+			const auto& path = std::string (torrent.Record_.SavePath_.toUtf8 ().constData ());
+			const auto automanaged = torrent.Record_.AutoManaged_;
+			const auto taskParameters = static_cast<TaskParameters> (torrent.Record_.Parameters_);
 
-			bool automanaged = settings.value ("AutoManaged", true).toBool ();
-			TaskParameters taskParameters = static_cast<TaskParameters> (settings
-						.value ("Parameters").toInt ());
+			libtorrent::add_torrent_params atp;
+			atp.ti = torrent.Info_;
+			std::copy (torrent.ResumeData_.constData (),
+					torrent.ResumeData_.constData () + torrent.ResumeData_.size (),
+					std::back_inserter (atp.resume_data));
 
-			auto handle = RestoreSingleTorrent (data,
-					resumed,
+			auto handle = RestoreSingleTorrent (std::move (atp),
 					path,
 					automanaged,
 					taskParameters & NoAutostart);
@@ -1724,19 +1889,11 @@ namespace BitTorrent
 				continue;
 			}
 
-			std::vector<int> priorities;
-			QByteArray prioritiesLine = settings.value ("Priorities").toByteArray ();
-			std::copy (prioritiesLine.begin (), prioritiesLine.end (),
-					std::back_inserter (priorities));
+			const auto& prioritiesLine = torrent.Record_.Priorities_;
+			std::vector<int> priorities { prioritiesLine.begin (), prioritiesLine.end () };
 
 			if (priorities.empty ())
-			{
-				const auto& infoPtr = StatusKeeper_->GetStatus (handle,
-							libtorrent::torrent_handle::query_torrent_file).torrent_file.lock ();
-				const auto numFiles = infoPtr ? infoPtr->num_files () : 0;
-				priorities.resize (numFiles);
-				std::fill (priorities.begin (), priorities.end (), 1);
-			}
+				priorities.resize (torrent.Info_->num_files (), 1);
 
 			handle.prioritize_files (priorities);
 
@@ -1744,16 +1901,15 @@ namespace BitTorrent
 			Handles_.append ({
 					priorities,
 					handle,
-					data,
+					torrent.Data_,
 					filename,
-					settings.value ("Tags").toStringList (),
+					torrent.Record_.Tags_,
 					automanaged,
 					taskParameters
 				});
+			Handles_.last ().TorrentFileSaved_ = true;
 			endInsertRows ();
-			qDebug () << "restored a torrent";
 		}
-		settings.endArray ();
 
 		int filters = settings.beginReadArray ("IPFilter");
 		for (int i = 0; i < filters; ++i)
@@ -1766,24 +1922,19 @@ namespace BitTorrent
 		}
 		settings.endArray ();
 		settings.endGroup ();
+
+		IPFilterDirty_ = false;
 	}
 
-	libtorrent::torrent_handle Core::RestoreSingleTorrent (const QByteArray& data,
-			const QByteArray& resumeData,
+	libtorrent::torrent_handle Core::RestoreSingleTorrent (libtorrent::add_torrent_params atp,
 			const boost::filesystem::path& path,
 			bool automanaged,
 			bool pause)
 	{
 		libtorrent::torrent_handle handle;
 
-		libtorrent::bdecode_node e;
-		if (!DecodeEntry (data, e))
-			return handle;
-
 		try
 		{
-			libtorrent::add_torrent_params atp;
-			atp.ti = lt_lib::make_shared<libtorrent::torrent_info> (e);
 			atp.storage_mode = GetCurrentStorageMode ();
 			atp.save_path = path.string ();
 			if (!automanaged)
@@ -1792,10 +1943,6 @@ namespace BitTorrent
 				atp.flags |= libtorrent::add_torrent_params::flag_paused;
 			atp.flags |= libtorrent::add_torrent_params::flag_duplicate_is_error;
 
-			std::copy (resumeData.constData (),
-					resumeData.constData () + resumeData.size (),
-					std::back_inserter (atp.resume_data));
-
 			handle = Session_->add_torrent (atp);
 		}
 		catch (const std::exception& e)
@@ -1925,7 +2072,7 @@ namespace BitTorrent
 
 		QTimer::singleShot (500,
 				this,
-				SLOT (writeSettings ()));
+				SLOT (saveTorrents ()));
 
 		SaveScheduled_ = true;
 	}
@@ -1942,19 +2089,35 @@ namespace BitTorrent
 		Proxy_->GetEntityManager ()->HandleEntity (e);
 	}
 
+	void Core::SaveSessionState ()
+	{
+#if LIBTORRENT_VERSION_NUM >= 10200
+		constexpr auto saveflags = libtorrent::save_state_flags_t::all ();
+#else
+		boost::uint32_t saveflags = 0xffffffff;
+#endif
+		libtorrent::entry sessionState;
+		Session_->save_state (sessionState, saveflags);
+
+		QByteArray sessionStateBA;
+		libtorrent::bencode (std::back_inserter (sessionStateBA), sessionState);
+		XmlSettingsManager::Instance ()->setProperty ("SessionState", sessionStateBA);
+	}
+
 	void Core::writeSettings ()
 	{
-		SaveScheduled_ = false;
+		saveTorrents ();
+		SaveSessionState ();
+	}
 
-		const auto& torrentsDir = Util::CreateIfNotExists ("bittorrent");
+	void Core::saveTorrents ()
+	{
+		SaveScheduled_ = false;
 
-		QSettings settings (QCoreApplication::organizationName (),
-				QCoreApplication::applicationName () + "_Torrent");
-		settings.beginGroup ("Core");
-		settings.beginWriteArray ("AddedTorrents");
+		QList<ResumeRecord> records;
+		records.reserve (Handles_.size ());
 		for (int i = 0; i < Handles_.size (); ++i)
 		{
-			settings.setArrayIndex (i);
 			if (!CheckValidity (i))
 			{
 				qWarning () << Q_FUNC_INFO
@@ -1962,45 +2125,44 @@ namespace BitTorrent
 					<< i;
 				continue;
 			}
-			if (Handles_.at (i).TorrentFileName_.isEmpty ())
+
+			auto& torrent = Handles_ [i];
+			if (torrent.TorrentFileName_.isEmpty ())
 			{
 				qWarning () << Q_FUNC_INFO
 					<< "empty file name"
 					<< i;
 				continue;
 			}
-			int oldCurrent = CurrentTorrent_;
-			CurrentTorrent_ = i;
+
 			try
 			{
-				QFile file_info (torrentsDir.filePath (Handles_.at (i).TorrentFileName_));
-				if (!file_info.open (QIODevice::WriteOnly))
-					ShowError (QString ("Cannot write settings! "
-								"Cannot open file %1 for write!")
-							.arg (Handles_.at (i).TorrentFileName_));
-				else
+				if (!torrent.TorrentFileSaved_)
 				{
-					file_info.write (Handles_.at (i).TorrentFileContents_);
-					file_info.close ();
-
-					const auto& handle = Handles_.at (i).Handle_;
-					if (handle.need_save_resume_data ())
-						handle.save_resume_data ();
-
-					const auto& savePath = StatusKeeper_->GetStatus (handle,
-								libtorrent::torrent_handle::query_save_path).save_path;
-					settings.setValue ("SavePath", QString::fromUtf8 (savePath.c_str ()));
-					settings.setValue ("Filename", Handles_.at (i).TorrentFileName_);
-					settings.setValue ("Tags", Handles_.at (i).Tags_);
-					settings.setValue ("Parameters", static_cast<int> (Handles_.at (i).Parameters_));
-					settings.setValue ("AutoManaged", Handles_.at (i).AutoManaged_);
-
-					QByteArray prioritiesLine;
-					std::copy (Handles_.at (i).FilePriorities_.begin (),
-							Handles_.at (i).FilePriorities_.end (),
-							std::back_inserter (prioritiesLine));
-					settings.setValue ("Priorities", prioritiesLine);
+					ResumeStore_->WriteTorrentFile (torrent.TorrentFileName_, torrent.TorrentFileContents_);
+					torrent.TorrentFileSaved_ = true;
 				}
+
+				const auto& handle = torrent.Handle_;
+				if (handle.need_save_resume_data ())
+					handle.save_resume_data ();
+
+				const auto& savePath = StatusKeeper_->GetStatus (handle,
+							libtorrent::torrent_handle::query_save_path).save_path;
+
+				QByteArray prioritiesLine;
+				std::copy (torrent.FilePriorities_.begin (),
+						torrent.FilePriorities_.end (),
+						std::back_inserter (prioritiesLine));
+
+				records.append ({
+						torrent.TorrentFileName_,
+						QString::fromUtf8 (savePath.c_str ()),
+						torrent.Tags_,
+						static_cast<int> (torrent.Parameters_),
+						torrent.AutoManaged_,
+						prioritiesLine
+					});
 			}
 			catch (const std::exception& e)
 			{
@@ -2010,10 +2172,28 @@ namespace BitTorrent
 			{
 				qWarning () << Q_FUNC_INFO << "unknown exception";
 			}
-			CurrentTorrent_ = oldCurrent;
 		}
-		settings.endArray ();
 
+		const auto& saved = ResumeStore_->Save (records);
+		if (HasLegacyRecords_)
+			Util::Sequence (this, saved) >>
+					[this] (bool ok)
+					{
+						if (!ok || !HasLegacyRecords_)
+							return;
+
+						HasLegacyRecords_ = false;
+						RemoveLegacyRecords ();
+					};
+
+		if (!IPFilterDirty_)
+			return;
+
+		IPFilterDirty_ = false;
+
+		QSettings settings (QCoreApplication::organizationName (),
+				QCoreApplication::applicationName () + "_Torrent");
+		settings.beginGroup ("Core");
 		settings.beginWriteArray ("IPFilter");
 		settings.remove ("");
 		int i = 0;
@@ -2026,22 +2206,6 @@ namespace BitTorrent
 		}
 		settings.endArray ();
 		settings.endGroup ();
-
-#if LIBTORRENT_VERSION_NUM >= 10200
-		constexpr auto saveflags = libtorrent::save_state_flags_t::all ();
-#else
-		boost::uint32_t saveflags = 0xffffffff;
-#endif
-		libtorrent::entry sessionState;
-		Session_->save_state (sessionState, saveflags);
-
-		QByteArray sessionStateBA;
-		libtorrent::bencode (std::back_inserter (sessionStateBA), sessionState);
-		XmlSettingsManager::Instance ()->setProperty ("SessionState", sessionStateBA);
-
-		Session_->wait_for_alert (libtorrent::time_duration (5));
-
-		queryLibtorrent ();
 	}
 
 	void Core::checkFinished ()
@@ -2051,10 +2215,14 @@ namespace BitTorrent
 			if (Handles_.at (i).State_ == TSSeeding)
 				continue;
 
-			const auto& status = Handles_.at (i).Handle_.status ({});
-			libtorrent::torrent_status::state_t state = status.state;
+			const auto slot = Snapshot_->GetSlot (Handles_.at (i).Handle_);
+			if (slot < 0)
+				continue;
+
+			const auto& status = Snapshot_->GetRow (slot);
+			libtorrent::torrent_status::state_t state = status.State_;
 
-			if (status.paused)
+			if (status.Paused_)
 			{
 				Handles_ [i].State_ = TSIdle;
 				continue;
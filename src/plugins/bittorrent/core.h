@@ -40,6 +40,7 @@
 #include <QIcon>
 #include <QFutureInterface>
 #include <libtorrent/alert_types.hpp>
+#include <libtorrent/add_torrent_params.hpp>
 #include <libtorrent/torrent_info.hpp>
 #include <libtorrent/torrent_handle.hpp>
 #include <libtorrent/session_status.hpp>
@@ -81,6 +82,8 @@ namespace BitTorrent
 	class SessionSettingsManager;
 	class CachedStatusKeeper;
 	class GeoIP;
+	class ResumeStore;
+	class StatusSnapshot;
 	struct SessionStats;
 	struct NewTorrentParams;
 
@@ -117,6 +120,11 @@ namespace BitTorrent
 
 			bool PauseAfterCheck_ = false;
 
+			/** Whether TorrentFileContents_ has already been written
+				* to disk.
+				*/
+			bool TorrentFileSaved_ = false;
+
 			TorrentStruct (const libtorrent::torrent_handle& handle,
 					const QStringList& tags,
 					TaskParameters params)
@@ -163,6 +171,7 @@ namespace BitTorrent
 
 		libtorrent::session *Session_ = nullptr;
 		SessionSettingsManager *SessionSettingsMgr_ = nullptr;
+		ResumeStore *ResumeStore_ = nullptr;
 
 		typedef QList<TorrentStruct> HandleDict_t;
 		HandleDict_t Handles_;
@@ -172,6 +181,8 @@ namespace BitTorrent
 		std::shared_ptr<LiveStreamManager> LiveStreamManager_;
 		QString ExternalAddress_;
 		bool SaveScheduled_ = false;
+		bool IPFilterDirty_ = false;
+		bool HasLegacyRecords_ = false;
 		QToolBar *Toolbar_ = nullptr;
 		QWidget *TabWidget_ = nullptr;
 		ICoreProxy_ptr Proxy_;
@@ -179,6 +190,7 @@ namespace BitTorrent
 		Util::ShortcutManager *ShortcutMgr_ = nullptr;
 
 		std::shared_ptr<GeoIP> GeoIP_;
+		const std::shared_ptr<StatusSnapshot> Snapshot_;
 
 		const QIcon TorrentIcon_ { "lcicons:/resources/images/bittorrent.svg" };
 
@@ -350,8 +362,7 @@ namespace BitTorrent
 		void MoveToTop (int);
 		void MoveToBottom (int);
 		void RestoreTorrents ();
-		libtorrent::torrent_handle RestoreSingleTorrent (const QByteArray&,
-				const QByteArray&,
+		libtorrent::torrent_handle RestoreSingleTorrent (libtorrent::add_torrent_params,
 				const boost::filesystem::path&,
 				bool,
 				bool);
@@ -372,11 +383,13 @@ namespace BitTorrent
 		 */
 		void UpdateTagsImpl (const QStringList& tags, int torrent);
 		void ScheduleSave ();
+		void SaveSessionState ();
 		void HandleLibtorrentException (const std::exception&);
 
 		void ShowError (const QString&);
 	private slots:
 		void writeSettings ();
+		void saveTorrents ();
 		void checkFinished ();
 		void scrape ();
 		void queryLibtorrent ();
@@ -29,6 +29,7 @@
 
 #include "piecesmodel.h"
 #include "core.h"
+#include <algorithm>
 #include <QTimer>
 
 namespace LeechCraft
@@ -121,10 +122,12 @@ namespace BitTorrent
 
 	void PiecesModel::update ()
 	{
-		Clear ();
 		const auto& handle = Core::Instance ()->GetTorrentHandle (Index_);
 		if (!handle.is_valid ())
+		{
+			Clear ();
 			return;
+		}
 
 		std::vector<libtorrent::partial_piece_info> queue;
 		handle.get_download_queue (queue);
@@ -138,60 +141,93 @@ namespace BitTorrent
 
 		beginRemoveRows (QModelIndex (), 0, Pieces_.size () - 1);
 		Pieces_.clear ();
+		PieceIndex2Row_.clear ();
 		endRemoveRows ();
 	}
 
 	void PiecesModel::Update (const std::vector<libtorrent::partial_piece_info>& queue)
 	{
 		QList<Info> pieces2Insert;
-		QMap<int, int> index2position;
+		std::vector<char> keep (Pieces_.size (), 0);
 
-		const int initSize = Pieces_.size ();
-		for (int i = 0; i < initSize; ++i)
-			index2position [Pieces_.at (i).Index_] = i;
+		int firstChanged = Pieces_.size ();
+		int lastChanged = -1;
 
-		// Update
-		for (size_t i = 0, size = queue.size (); i < size; ++i)
+		for (const auto& ppi : queue)
 		{
-			const auto& ppi = queue [i];
-
-			bool found = false;
-			for (int j = 0; j < initSize; ++j)
-				if (Pieces_.at (j).Index_ == ppi.piece_index)
-				{
-					index2position.remove (Pieces_.at (j).Index_);
-					Pieces_ [j].FinishedBlocks_ = ppi.finished;
-					found = true;
-					emit dataChanged (index (j, 1), index (j, 2));
-					break;
-				}
-			if (found)
+			const auto pos = PieceIndex2Row_.constFind (ppi.piece_index);
+			if (pos == PieceIndex2Row_.constEnd ())
+			{
+				pieces2Insert.append ({ ppi.piece_index, ppi.finished, ppi.blocks_in_piece });
+				continue;
+			}
+
+			const auto row = *pos;
+			keep [row] = 1;
+
+			auto& info = Pieces_ [row];
+			if (info.FinishedBlocks_ == ppi.finished &&
+					info.TotalBlocks_ == ppi.blocks_in_piece)
 				continue;
 
-			Info info;
-			info.Index_ = ppi.piece_index;
-			info.TotalBlocks_ = ppi.blocks_in_piece;
 			info.FinishedBlocks_ = ppi.finished;
-			pieces2Insert << info;
+			info.TotalBlocks_ = ppi.blocks_in_piece;
+			firstChanged = std::min (firstChanged, row);
+			lastChanged = std::max (lastChanged, row);
 		}
 
-		// Remove
-		QList<int> values = index2position.values ();
-		qSort (values.begin (), values.end (), qGreater<int> ());
-		for (int i = 0; i < values.size (); ++i)
+		if (lastChanged >= 0)
+			emit dataChanged (index (firstChanged, 1), index (lastChanged, 1));
+
+		RemoveRows (keep);
+
+		if (pieces2Insert.isEmpty ())
+			return;
+
+		beginInsertRows (QModelIndex (), Pieces_.size (), Pieces_.size () + pieces2Insert.size () - 1);
+		for (const auto& info : pieces2Insert)
 		{
-			beginRemoveRows (QModelIndex (), values.at (i), values.at (i));
-			Pieces_.removeAt (values.at (i));
-			endRemoveRows ();
+			PieceIndex2Row_ [info.Index_] = Pieces_.size ();
+			Pieces_ << info;
 		}
+		endInsertRows ();
+	}
+
+	void PiecesModel::RemoveRows (const std::vector<char>& keep)
+	{
+		bool removed = false;
 
-		// Insert new
-		if (pieces2Insert.size ())
+		// go from the end so that the rows before the removed range keep their numbers
+		for (int last = static_cast<int> (keep.size ()) - 1; last >= 0; )
 		{
-			beginInsertRows (QModelIndex (), Pieces_.size (), Pieces_.size () + pieces2Insert.size () - 1);
-			Pieces_ += pieces2Insert;
-			endInsertRows ();
+			if (keep [last])
+			{
+				--last;
+				continue;
+			}
+
+			auto first = last;
+			while (first > 0 && !keep [first - 1])
+				--first;
+
+			beginRemoveRows (QModelIndex (), first, last);
+			Pieces_.erase (Pieces_.begin () + first, Pieces_.begin () + last + 1);
+			endRemoveRows ();
+
+			removed = true;
+			last = first - 1;
 		}
+
+		if (removed)
+			ReindexRows ();
+	}
+
+	void PiecesModel::ReindexRows ()
+	{
+		PieceIndex2Row_.clear ();
+		PieceIndex2Row_.reserve (Pieces_.size ());
+		for (int i = 0; i < Pieces_.size (); ++i)
+			PieceIndex2Row_ [Pieces_.at (i).Index_] = i;
 	}
 }
 }
@@ -32,6 +32,7 @@
 #include <QAbstractItemModel>
 #include <QStringList>
 #include <QList>
+#include <QHash>
 #include <vector>
 #include <libtorrent/torrent_handle.hpp>
 
@@ -53,6 +54,7 @@ namespace BitTorrent
 			bool operator== (const Info&) const;
 		};
 		QList<Info> Pieces_;
+		QHash<int, int> PieceIndex2Row_;
 
 		const int Index_;
 	public:
@@ -71,6 +73,8 @@ namespace BitTorrent
 	private:
 		void Clear ();
 		void Update (const std::vector<libtorrent::partial_piece_info>&);
+		void RemoveRows (const std::vector<char>& keep);
+		void ReindexRows ();
 	};
 }
 }
@@ -28,9 +28,12 @@
  **********************************************************************/
 
 #include "pieceswidget.h"
+#include <algorithm>
+#include <cstring>
+#include <QImage>
 #include <QPainter>
 #include <QPaintEvent>
-#include <QVector>
+#include <QtAlgorithms>
 #include <QtDebug>
 #include <QApplication>
 #include <QPalette>
@@ -46,42 +49,61 @@ namespace BitTorrent
 
 	void PiecesWidget::setPieceMap (const libtorrent::bitfield& pieces)
 	{
-		Pieces_ = pieces;
+		const auto count = static_cast<int> (pieces.size ());
+		const QByteArray bits { pieces.data (), (count + 7) / 8 };
+		if (count == PiecesCount_ && bits == Pieces_)
+			return;
+
+		Pieces_ = bits;
+		PiecesCount_ = count;
 
 		update ();
 	}
 
-	QList<QPair<int, int>> FindTrues (const libtorrent::bitfield& pieces)
+	namespace
 	{
-		QList<QPair<int, int>> result;
-		bool prevVal = pieces [0];
-		int prevPos = 0;
-		int size = static_cast<int> (pieces.size ());
-		for (int i = 1; i < size; ++i)
-			if (pieces [i] != prevVal)
+		int GetBit (const uchar *data, int pos)
+		{
+			return (data [pos / 8] >> (7 - pos % 8)) & 1;
+		}
+
+		int CountTrues (const QByteArray& bits, int begin, int end)
+		{
+			const auto data = reinterpret_cast<const uchar*> (bits.constData ());
+
+			int result = 0;
+			for (; begin < end && begin % 8; ++begin)
+				result += GetBit (data, begin);
+
+			for (; end - begin >= 64; begin += 64)
 			{
-				if (prevVal)
-					result << qMakePair (prevPos, i);
-				prevPos = i;
-				prevVal = 1 - prevVal;
+				quint64 word;
+				std::memcpy (&word, data + begin / 8, sizeof (word));
+				result += qPopulationCount (word);
 			}
 
-		if (!prevPos && prevVal)
-			result << qMakePair<int, int> (0, pieces.size ());
-		else if (prevVal && result.size () && result.last ().second != size - 1)
-			result << qMakePair<int, int> (prevPos, size);
-		else if (prevVal && !result.size ())
-			result << qMakePair<int, int> (0, size);
+			for (; end - begin >= 8; begin += 8)
+				result += qPopulationCount (data [begin / 8]);
 
-		return result;
+			for (; begin < end; ++begin)
+				result += GetBit (data, begin);
+
+			return result;
+		}
+
+		QRgb Blend (const QColor& from, const QColor& to, double ratio)
+		{
+			auto mix = [ratio] (int c1, int c2) { return static_cast<int> (c1 + (c2 - c1) * ratio); };
+			return qRgb (mix (from.red (), to.red ()),
+					mix (from.green (), to.green ()),
+					mix (from.blue (), to.blue ()));
+		}
 	}
 
 	void PiecesWidget::paintEvent (QPaintEvent *e)
 	{
-		int s = Pieces_.size ();
+		const int s = PiecesCount_;
 		QPainter painter (this);
-		painter.setRenderHints (QPainter::Antialiasing |
-				QPainter::SmoothPixmapTransform);
 		if (!s)
 		{
 			painter.setBackgroundMode (Qt::OpaqueMode);
@@ -94,25 +116,22 @@ namespace BitTorrent
 		const QColor& backgroundColor = palette.color (QPalette::Base);
 		const QColor& downloadedPieceColor = palette.color (QPalette::Highlight);
 
-		QPixmap tempPicture (s, 1);
-		QPainter tempPainter (&tempPicture);
-		tempPainter.setPen (backgroundColor);
-		tempPainter.drawLine (0, 0, s, 0);
-		QList<QPair<int, int>> trues = FindTrues (Pieces_);
-		for (int i = 0; i < trues.size (); ++i)
+		// each pixel shows the share of the downloaded pieces it covers
+		const int w = std::max (std::min (width (), s), 1);
+		QImage image { w, 1, QImage::Format_RGB32 };
+		const auto line = reinterpret_cast<QRgb*> (image.scanLine (0));
+		for (int x = 0; x < w; ++x)
 		{
-			QPair<int, int> pair = trues.at (i);
-
-			tempPainter.setPen (downloadedPieceColor);
-			tempPainter.drawLine (pair.first, 0, pair.second, 0);
+			const auto begin = static_cast<int> (static_cast<qint64> (x) * s / w);
+			const auto end = std::max (begin + 1, static_cast<int> (static_cast<qint64> (x + 1) * s / w));
+			const auto ratio = static_cast<double> (CountTrues (Pieces_, begin, end)) / (end - begin);
+			line [x] = Blend (backgroundColor, downloadedPieceColor, ratio);
 		}
-		tempPainter.end ();
 
-		painter.drawPixmap (QRect (0, 0, width (), height ()), tempPicture);
+		painter.drawImage (QRect (0, 0, width (), height ()), image);
 		painter.end ();
 
 		e->accept ();
 	}
-
 }
 }
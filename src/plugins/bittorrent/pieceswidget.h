@@ -30,7 +30,6 @@
 #pragma once
 
 #include <QLabel>
-#include <vector>
 #include <libtorrent/bitfield.hpp>
 
 namespace LeechCraft
@@ -41,7 +40,8 @@ namespace BitTorrent
 	{
 		Q_OBJECT
 
-		libtorrent::bitfield Pieces_;
+		QByteArray Pieces_;
+		int PiecesCount_ = 0;
 	public:
 		PiecesWidget (QWidget *parent = 0);
 	public slots:
@@ -0,0 +1,201 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#include "resumestore.h"
+#include <QDataStream>
+#include <QFile>
+#include <QSaveFile>
+#include <QtConcurrentRun>
+#include <QtDebug>
+#include <util/sys/paths.h>
+#include <util/threads/futures.h>
+
+namespace LeechCraft
+{
+namespace BitTorrent
+{
+	bool operator== (const ResumeRecord& r1, const ResumeRecord& r2)
+	{
+		return r1.Filename_ == r2.Filename_ &&
+				r1.SavePath_ == r2.SavePath_ &&
+				r1.Tags_ == r2.Tags_ &&
+				r1.Parameters_ == r2.Parameters_ &&
+				r1.AutoManaged_ == r2.AutoManaged_ &&
+				r1.Priorities_ == r2.Priorities_;
+	}
+
+	QDataStream& operator<< (QDataStream& out, const ResumeRecord& record)
+	{
+		out << static_cast<quint8> (1)
+				<< record.Filename_
+				<< record.SavePath_
+				<< record.Tags_
+				<< record.Parameters_
+				<< record.AutoManaged_
+				<< record.Priorities_;
+		return out;
+	}
+
+	QDataStream& operator>> (QDataStream& in, ResumeRecord& record)
+	{
+		quint8 version = 0;
+		in >> version;
+		if (version != 1)
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "unknown version"
+					<< version;
+			in.setStatus (QDataStream::ReadCorruptData);
+			return in;
+		}
+
+		in >> record.Filename_
+				>> record.SavePath_
+				>> record.Tags_
+				>> record.Parameters_
+				>> record.AutoManaged_
+				>> record.Priorities_;
+		return in;
+	}
+
+	namespace
+	{
+		const QString StoreFilename { "torrents.dat" };
+
+		QString GetFilePath (const QString& filename)
+		{
+			return Util::CreateIfNotExists ("bittorrent").filePath (filename);
+		}
+	}
+
+	ResumeStore::ResumeStore (QObject *parent)
+	: QObject { parent }
+	{
+		Pool_.setMaxThreadCount (1);
+	}
+
+	ResumeStore::~ResumeStore ()
+	{
+		WaitForDone ();
+	}
+
+	std::optional<QList<ResumeRecord>> ResumeStore::Load ()
+	{
+		QFile file { GetFilePath (StoreFilename) };
+		if (!file.exists ())
+			return {};
+
+		if (!file.open (QIODevice::ReadOnly))
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "unable to open"
+					<< file.fileName ()
+					<< file.errorString ();
+			return {};
+		}
+
+		LastSaved_ = file.readAll ();
+
+		QList<ResumeRecord> records;
+		QDataStream in { LastSaved_ };
+		in >> records;
+		if (in.status () != QDataStream::Ok)
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "corrupted store"
+					<< file.fileName ();
+			LastSaved_.clear ();
+			return {};
+		}
+
+		return records;
+	}
+
+	QFuture<bool> ResumeStore::Save (const QList<ResumeRecord>& records)
+	{
+		QByteArray data;
+		{
+			QDataStream out { &data, QIODevice::WriteOnly };
+			out << records;
+		}
+
+		if (data == LastSaved_)
+			return Util::MakeReadyFuture (false);
+
+		LastSaved_ = data;
+		return ScheduleWrite (StoreFilename, data);
+	}
+
+	void ResumeStore::WriteTorrentFile (const QString& filename, const QByteArray& contents)
+	{
+		ScheduleWrite (filename, contents);
+	}
+
+	void ResumeStore::WriteResumeData (const QString& filename, const QByteArray& data)
+	{
+		ScheduleWrite (filename + ".resume", data);
+	}
+
+	void ResumeStore::WaitForDone ()
+	{
+		Pool_.waitForDone ();
+	}
+
+	QFuture<bool> ResumeStore::ScheduleWrite (const QString& filename, const QByteArray& data)
+	{
+		const auto& path = GetFilePath (filename);
+		return QtConcurrent::run (&Pool_,
+				[path, data]
+				{
+					QSaveFile file { path };
+					if (!file.open (QIODevice::WriteOnly))
+					{
+						qWarning () << Q_FUNC_INFO
+								<< "unable to open"
+								<< path
+								<< "for writing:"
+								<< file.errorString ();
+						return false;
+					}
+
+					file.write (data);
+					if (!file.commit ())
+					{
+						qWarning () << Q_FUNC_INFO
+								<< "unable to commit"
+								<< path
+								<< file.errorString ();
+						return false;
+					}
+
+					return true;
+				});
+	}
+}
+}
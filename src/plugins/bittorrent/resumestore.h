@@ -0,0 +1,102 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#pragma once
+
+#include <optional>
+#include <QObject>
+#include <QFuture>
+#include <QThreadPool>
+#include <QStringList>
+
+class QDataStream;
+
+namespace LeechCraft
+{
+namespace BitTorrent
+{
+	/** @brief The persistent settings of a single torrent.
+	 */
+	struct ResumeRecord
+	{
+		QString Filename_;
+		QString SavePath_;
+		QStringList Tags_;
+		int Parameters_ = 0;
+		bool AutoManaged_ = true;
+		QByteArray Priorities_;
+	};
+
+	bool operator== (const ResumeRecord&, const ResumeRecord&);
+
+	QDataStream& operator<< (QDataStream&, const ResumeRecord&);
+	QDataStream& operator>> (QDataStream&, ResumeRecord&);
+
+	/** @brief Stores the list of torrents and their files on disk.
+	 *
+	 * All the writes happen on a single background thread in the order
+	 * they are requested. Each file is written to a temporary file which
+	 * is then atomically renamed over the old one, so a crash never leaves
+	 * a half-written file behind.
+	 */
+	class ResumeStore : public QObject
+	{
+		QThreadPool Pool_;
+		QByteArray LastSaved_;
+	public:
+		ResumeStore (QObject* = nullptr);
+		~ResumeStore ();
+
+		/** @brief Loads the list of torrents.
+		 *
+		 * @return The saved records, or an empty optional if the store
+		 * has never been written.
+		 */
+		std::optional<QList<ResumeRecord>> Load ();
+
+		/** @brief Schedules writing the list of torrents.
+		 *
+		 * Does nothing if the list is the same as the one written last.
+		 *
+		 * @return The future with \em true if the list has been written
+		 * successfully, or \em false if writing failed or was skipped.
+		 */
+		QFuture<bool> Save (const QList<ResumeRecord>&);
+
+		void WriteTorrentFile (const QString& filename, const QByteArray& contents);
+		void WriteResumeData (const QString& filename, const QByteArray& data);
+
+		/** @brief Blocks until all the scheduled writes are finished.
+		 */
+		void WaitForDone ();
+	private:
+		QFuture<bool> ScheduleWrite (const QString& filename, const QByteArray& data);
+	};
+}
+}
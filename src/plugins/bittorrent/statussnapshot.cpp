@@ -0,0 +1,164 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#include "statussnapshot.h"
+
+namespace LeechCraft
+{
+namespace BitTorrent
+{
+	int StatusSnapshot::GetSlot (const libtorrent::torrent_handle& handle) const
+	{
+		return Handle2Slot_.value (handle, -1);
+	}
+
+	StatusSnapshot::Row StatusSnapshot::GetRow (int slot) const
+	{
+		return
+		{
+			Names_ [slot],
+			SavePaths_ [slot],
+			Errors_ [slot],
+			States_ [slot],
+			static_cast<bool> (Paused_ [slot]),
+			Progress_ [slot],
+			DownloadRates_ [slot],
+			DownloadPayloadRates_ [slot],
+			UploadPayloadRates_ [slot],
+			NumPeers_ [slot],
+			NumSeeds_ [slot],
+			NumIncomplete_ [slot],
+			ListPeers_ [slot],
+			ListSeeds_ [slot],
+			TotalWanted_ [slot],
+			TotalWantedDone_ [slot],
+			AllTimeDownload_ [slot],
+			AllTimeUpload_ [slot]
+		};
+	}
+
+	namespace
+	{
+		template<typename T, typename U>
+		void Set (std::vector<T>& vec, int slot, const U& value, quint32& changed, quint32 field)
+		{
+			auto& cur = vec [slot];
+			if (cur == value)
+				return;
+
+			cur = value;
+			changed |= field;
+		}
+	}
+
+	quint32 StatusSnapshot::Update (const libtorrent::torrent_status& status)
+	{
+		quint32 changed = 0;
+
+		auto slot = GetSlot (status.handle);
+		if (slot < 0)
+		{
+			slot = AllocateSlot ();
+			Handle2Slot_ [status.handle] = slot;
+			changed = ~0u;
+		}
+
+		const auto& name = QString::fromStdString (status.name);
+		if (!name.isEmpty ())
+			Set (Names_, slot, name, changed, FName);
+		if (!status.save_path.empty ())
+			Set (SavePaths_, slot, QString::fromStdString (status.save_path), changed, FSavePath);
+		Set (Errors_, slot, QString::fromUtf8 (status.error.c_str ()), changed, FError);
+		Set (States_, slot, status.state, changed, FState);
+		Set (Paused_, slot, static_cast<char> (status.paused), changed, FPaused);
+		Set (Progress_, slot, status.progress, changed, FProgress);
+		Set (DownloadRates_, slot, status.download_rate, changed, FDownRate);
+		Set (DownloadPayloadRates_, slot, status.download_payload_rate, changed, FDownRate);
+		Set (UploadPayloadRates_, slot, status.upload_payload_rate, changed, FUpRate);
+		Set (NumPeers_, slot, status.num_peers, changed, FPeers);
+		Set (NumSeeds_, slot, status.num_seeds, changed, FSeeds);
+		Set (NumIncomplete_, slot, status.num_incomplete, changed, FSwarm);
+		Set (ListPeers_, slot, status.list_peers, changed, FSwarm);
+		Set (ListSeeds_, slot, status.list_seeds, changed, FSwarm);
+		Set (TotalWanted_, slot, static_cast<qint64> (status.total_wanted), changed, FWanted);
+		Set (TotalWantedDone_, slot, static_cast<qint64> (status.total_wanted_done), changed, FProgress);
+		Set (AllTimeDownload_, slot, static_cast<qint64> (status.all_time_download), changed, FAllTimeDownload);
+		Set (AllTimeUpload_, slot, static_cast<qint64> (status.all_time_upload), changed, FAllTimeUpload);
+
+		return changed;
+	}
+
+	void StatusSnapshot::Remove (const libtorrent::torrent_handle& handle)
+	{
+		const auto pos = Handle2Slot_.find (handle);
+		if (pos == Handle2Slot_.end ())
+			return;
+
+		const auto slot = *pos;
+		Handle2Slot_.erase (pos);
+
+		Names_ [slot].clear ();
+		SavePaths_ [slot].clear ();
+		Errors_ [slot].clear ();
+		FreeSlots_.push_back (slot);
+	}
+
+	int StatusSnapshot::AllocateSlot ()
+	{
+		if (!FreeSlots_.empty ())
+		{
+			const auto slot = FreeSlots_.back ();
+			FreeSlots_.pop_back ();
+			return slot;
+		}
+
+		const auto slot = static_cast<int> (Names_.size ());
+		const auto size = slot + 1;
+		Names_.resize (size);
+		SavePaths_.resize (size);
+		Errors_.resize (size);
+		States_.resize (size);
+		Paused_.resize (size);
+		Progress_.resize (size);
+		DownloadRates_.resize (size);
+		DownloadPayloadRates_.resize (size);
+		UploadPayloadRates_.resize (size);
+		NumPeers_.resize (size);
+		NumSeeds_.resize (size);
+		NumIncomplete_.resize (size);
+		ListPeers_.resize (size);
+		ListSeeds_.resize (size);
+		TotalWanted_.resize (size);
+		TotalWantedDone_.resize (size);
+		AllTimeDownload_.resize (size);
+		AllTimeUpload_.resize (size);
+		return slot;
+	}
+}
+}
@@ -0,0 +1,141 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#pragma once
+
+#include <vector>
+#include <QMap>
+#include <QString>
+#include <libtorrent/version.hpp>
+#include <libtorrent/torrent_handle.hpp>
+
+#if LIBTORRENT_VERSION_NUM >= 10100
+#include <libtorrent/torrent_status.hpp>
+#endif
+
+namespace LeechCraft
+{
+namespace BitTorrent
+{
+	/** @brief Keeps the last known status of every torrent shown in the
+	 * list.
+	 *
+	 * The fields are stored as a structure of arrays indexed by a slot
+	 * number, and each torrent handle owns a slot. The snapshot is only
+	 * refreshed from the statuses libtorrent posts in its
+	 * state_update_alert batches. Update() reports which fields
+	 * actually changed.
+	 */
+	class StatusSnapshot
+	{
+	public:
+		enum Field : quint32
+		{
+			FName = 1 << 0,
+			FSavePath = 1 << 1,
+			FError = 1 << 2,
+			FState = 1 << 3,
+			FPaused = 1 << 4,
+			FProgress = 1 << 5,
+			FDownRate = 1 << 6,
+			FUpRate = 1 << 7,
+			FPeers = 1 << 8,
+			FSeeds = 1 << 9,
+			FSwarm = 1 << 10,
+			FWanted = 1 << 11,
+			FAllTimeDownload = 1 << 12,
+			FAllTimeUpload = 1 << 13
+		};
+
+		/** @brief A lightweight view on the fields of a single slot.
+		 */
+		struct Row
+		{
+			const QString& Name_;
+			const QString& SavePath_;
+			const QString& Error_;
+			libtorrent::torrent_status::state_t State_;
+			bool Paused_;
+			float Progress_;
+			int DownloadRate_;
+			int DownloadPayloadRate_;
+			int UploadPayloadRate_;
+			int NumPeers_;
+			int NumSeeds_;
+			int NumIncomplete_;
+			int ListPeers_;
+			int ListSeeds_;
+			qint64 TotalWanted_;
+			qint64 TotalWantedDone_;
+			qint64 AllTimeDownload_;
+			qint64 AllTimeUpload_;
+		};
+	private:
+		QMap<libtorrent::torrent_handle, int> Handle2Slot_;
+		std::vector<int> FreeSlots_;
+
+		std::vector<QString> Names_;
+		std::vector<QString> SavePaths_;
+		std::vector<QString> Errors_;
+		std::vector<libtorrent::torrent_status::state_t> States_;
+		std::vector<char> Paused_;
+		std::vector<float> Progress_;
+		std::vector<int> DownloadRates_;
+		std::vector<int> DownloadPayloadRates_;
+		std::vector<int> UploadPayloadRates_;
+		std::vector<int> NumPeers_;
+		std::vector<int> NumSeeds_;
+		std::vector<int> NumIncomplete_;
+		std::vector<int> ListPeers_;
+		std::vector<int> ListSeeds_;
+		std::vector<qint64> TotalWanted_;
+		std::vector<qint64> TotalWantedDone_;
+		std::vector<qint64> AllTimeDownload_;
+		std::vector<qint64> AllTimeUpload_;
+	public:
+		/** @brief Returns the slot of the given handle, or -1 if there
+		 * is no status for it yet.
+		 */
+		int GetSlot (const libtorrent::torrent_handle&) const;
+
+		Row GetRow (int slot) const;
+
+		/** @brief Stores the given status.
+		 *
+		 * @return The bitmask of Field values that have changed, or all
+		 * the fields if this is the first status for the torrent.
+		 */
+		quint32 Update (const libtorrent::torrent_status&);
+
+		void Remove (const libtorrent::torrent_handle&);
+	private:
+		int AllocateSlot ();
+	};
+}
+}
@@ -50,6 +50,7 @@
 #include "xmlsettingsmanager.h"
 #include "localcollectionwatcher.h"
 #include "localcollectionmodel.h"
+#include "tagscanner.h"
 
 namespace LeechCraft
 {
@@ -61,6 +62,7 @@ namespace LMP
 	, CollectionModel_ (new LocalCollectionModel (Storage_, this))
 	, FilesWatcher_ (new LocalCollectionWatcher (this))
 	, AlbumArtMgr_ (new AlbumArtManager (this))
+	, Scanner_ (new TagScanner (this))
 	, Watcher_ (new QFutureWatcher<MediaInfo> (this))
 	{
 		connect (Watcher_,
@@ -94,6 +96,11 @@ namespace LMP
 				SLOT (saveRootPaths ()));
 	}
 
+	LocalCollection::~LocalCollection ()
+	{
+		Watcher_->cancel ();
+	}
+
 	bool LocalCollection::IsReady () const
 	{
 		return IsReady_;
@@ -158,48 +165,54 @@ namespace LMP
 
 			LocalCollectionStorage storage;
 
-			const auto& paths = storage.GetTracksPaths ();
+			QHash<QString, QDateTime> storedMTimes;
+			try
+			{
+				storedMTimes = storage.GetAllMTimes ();
+			}
+			catch (const std::exception& e)
+			{
+				qWarning () << Q_FUNC_INFO
+						<< "error getting mtimes"
+						<< e.what ();
+			}
+
+			QList<QPair<QString, QDateTime>> updatedMTimes;
 
 			const auto& allInfos = RecIterateInfo (path, symLinks);
 			for (const auto& info : allInfos)
 			{
 				const auto& trackPath = info.absoluteFilePath ();
 				const auto& mtime = info.lastModified ();
-				try
+
+				const auto pos = storedMTimes.constFind (trackPath);
+				if (pos != storedMTimes.constEnd ())
 				{
-					const auto& storedDt = storage.GetMTime (trackPath);
+					const auto& storedDt = *pos;
 					if (storedDt.isValid () &&
 							std::abs (storedDt.msecsTo (mtime)) < 1500)
 					{
 						result.UnchangedFiles_ << trackPath;
 						continue;
 					}
-				}
-				catch (const std::exception& e)
-				{
-					qWarning () << Q_FUNC_INFO
-							<< "error getting mtime"
-							<< trackPath
-							<< e.what ();
-				}
 
-				if (paths.contains (trackPath))
-				{
-					try
-					{
-						storage.SetMTime (trackPath, mtime);
-					}
-					catch (const std::exception& e)
-					{
-						qWarning () << Q_FUNC_INFO
-								<< "error setting mtime"
-								<< trackPath
-								<< e.what ();
-					}
+					updatedMTimes.append ({ trackPath, mtime });
 				}
+
 				result.ChangedFiles_ << trackPath;
 			}
 
+			try
+			{
+				storage.SetMTimes (updatedMTimes);
+			}
+			catch (const std::exception& e)
+			{
+				qWarning () << Q_FUNC_INFO
+						<< "error setting mtimes"
+						<< e.what ();
+			}
+
 			return result;
 		};
 		Util::Sequence (this, QtConcurrent::run (worker)) >>
@@ -249,6 +262,77 @@ namespace LMP
 			Scan (path, true);
 	}
 
+	void LocalCollection::UpdateFiles (const QStringList& paths)
+	{
+		const bool symLinks = XmlSettingsManager::Instance ()
+				.property ("FollowSymLinks").toBool ();
+
+		QSet<QString> toScan;
+		QList<QPair<QString, QDateTime>> mtimes;
+		for (const auto& path : paths)
+			for (const auto& info : RecIterateInfo (path, symLinks))
+			{
+				const auto& trackPath = info.absoluteFilePath ();
+				toScan << trackPath;
+				if (PresentPaths_.contains (trackPath))
+					mtimes.append ({ trackPath, info.lastModified () });
+			}
+
+		if (toScan.isEmpty ())
+			return;
+
+		try
+		{
+			Storage_->SetMTimes (mtimes);
+		}
+		catch (const std::exception& e)
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "error setting mtimes"
+					<< e.what ();
+		}
+
+		if (Watcher_->isRunning ())
+			NewPathsQueue_ << toScan;
+		else
+			InitiateScan (toScan);
+	}
+
+	void LocalCollection::RemoveFiles (const QStringList& paths)
+	{
+		QSet<QString> toRemove;
+		for (const auto& path : paths)
+		{
+			if (PresentPaths_.contains (path))
+			{
+				toRemove << path;
+				continue;
+			}
+
+			const auto& prefix = path + '/';
+			for (const auto& present : PresentPaths_)
+				if (present.startsWith (prefix))
+					toRemove << present;
+		}
+
+		try
+		{
+			for (const auto& path : toRemove)
+				RemoveTrack (path);
+		}
+		catch (const std::exception& e)
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "error removing tracks"
+					<< e.what ();
+		}
+	}
+
+	double LocalCollection::GetLastScanThroughput () const
+	{
+		return LastScanThroughput_;
+	}
+
 	LocalCollection::DirStatus LocalCollection::GetDirStatus (const QString& dir) const
 	{
 		if (RootPaths_.contains (dir))
@@ -872,20 +956,8 @@ namespace LMP
 		auto resolver = Core::Instance ().GetLocalFileResolver ();
 
 		emit scanStarted (newPaths.size ());
-		auto worker = [resolver] (const QString& path)
-		{
-			return resolver->ResolveInfo (path).ToRight ([] (const ResolveError& error)
-					{
-						qWarning () << Q_FUNC_INFO
-								<< "error resolving media info for"
-								<< error.FilePath_
-								<< error.ReasonString_;
-						return MediaInfo {};
-					});
-		};
-		const auto& future = QtConcurrent::mapped (newPaths,
-				std::function<MediaInfo (QString)> (worker));
-		Watcher_->setFuture (future);
+		ScanTimer_.start ();
+		Watcher_->setFuture (Scanner_->Scan (resolver, newPaths.toList (), RootPaths_));
 	}
 
 	void LocalCollection::RecordPlayedTrack (const QString& path)
@@ -918,6 +990,18 @@ namespace LMP
 	void LocalCollection::handleScanFinished ()
 	{
 		auto future = Watcher_->future ();
+
+		const auto elapsed = ScanTimer_.elapsed ();
+		LastScanThroughput_ = future.resultCount () * 1000.0 / std::max<qint64> (elapsed, 1);
+		qDebug () << Q_FUNC_INFO
+				<< "scanned"
+				<< future.resultCount ()
+				<< "files in"
+				<< elapsed
+				<< "ms,"
+				<< LastScanThroughput_
+				<< "tracks/s";
+
 		QList<MediaInfo> newInfos, existingInfos;
 		for (const auto& info : future)
 		{
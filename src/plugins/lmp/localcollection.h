@@ -33,6 +33,7 @@
 #include <QHash>
 #include <QSet>
 #include <QFutureWatcher>
+#include <QElapsedTimer>
 #include <QIcon>
 #include "interfaces/lmp/collectiontypes.h"
 #include "interfaces/lmp/ilocalcollection.h"
@@ -54,6 +55,7 @@ namespace LMP
 	class LocalCollectionWatcher;
 	class LocalCollectionModel;
 	class Player;
+	class TagScanner;
 
 	class LocalCollection : public QObject
 						  , public ILocalCollection
@@ -81,9 +83,13 @@ namespace LMP
 		QHash<int, Collection::Album_ptr> AlbumID2Album_;
 		QHash<int, int> AlbumID2ArtistID_;
 
+		TagScanner * const Scanner_;
 		QFutureWatcher<MediaInfo> *Watcher_;
 		QList<QSet<QString>> NewPathsQueue_;
 
+		QElapsedTimer ScanTimer_;
+		double LastScanThroughput_ = 0;
+
 		int UpdateNewArtists_ = 0;
 		int UpdateNewAlbums_ = 0;
 		int UpdateNewTracks_ = 0;
@@ -109,6 +115,7 @@ namespace LMP
 		};
 
 		LocalCollection (QObject* = nullptr);
+		~LocalCollection ();
 
 		bool IsReady () const;
 
@@ -124,6 +131,25 @@ namespace LMP
 		void Unscan (const QString&);
 		void Rescan ();
 
+		/** @brief Rescans the given files if they are supported tracks.
+		 *
+		 * This is used by the collection watcher to apply per-file
+		 * change notifications without rescanning whole directories.
+		 */
+		void UpdateFiles (const QStringList&);
+
+		/** @brief Removes the tracks for the given paths.
+		 *
+		 * A path may also refer to a removed directory, in which case
+		 * all the tracks under it are removed.
+		 */
+		void RemoveFiles (const QStringList&);
+
+		/** @brief Returns the speed of the last finished scan, in
+		 * tracks per second.
+		 */
+		double GetLastScanThroughput () const;
+
 		DirStatus GetDirStatus (const QString&) const;
 		QStringList GetDirs () const;
 
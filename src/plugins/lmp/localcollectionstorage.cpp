@@ -104,6 +104,7 @@ namespace LMP
 	Collection::Artists_t LocalCollectionStorage::AddToCollection (const QList<MediaInfo>& infos)
 	{
 		QMap<int, Collection::Artist> artists;
+		QHash<int, Collection::Album_ptr> albums;
 
 		Util::DBLock lock (DB_);
 
@@ -133,7 +134,9 @@ namespace LMP
 			{
 				album.CoverPath_ = FindAlbumArtPath (info.LocalPath_);
 				AddAlbum (artist, album);
-				artists [artist.ID_].Albums_ << std::make_shared<Collection::Album> (album);
+				const auto& albumPtr = std::make_shared<Collection::Album> (album);
+				artists [artist.ID_].Albums_ << albumPtr;
+				albums [album.ID_] = albumPtr;
 			}
 
 			Collection::Track track
@@ -147,12 +150,16 @@ namespace LMP
 			};
 			AddTrack (track, artist.ID_, album.ID_);
 
-			for (auto& trackAlbum : artists [artist.ID_].Albums_)
-				if (trackAlbum->ID_ == album.ID_)
-				{
-					trackAlbum->Tracks_ << track;
-					break;
-				}
+			if (const auto& trackAlbum = albums.value (album.ID_))
+				trackAlbum->Tracks_ << track;
+			else
+				for (auto& trackAlbum : artists [artist.ID_].Albums_)
+					if (trackAlbum->ID_ == album.ID_)
+					{
+						trackAlbum->Tracks_ << track;
+						albums [album.ID_] = trackAlbum;
+						break;
+					}
 
 			SetMTime (info.LocalPath_, QFileInfo { info.LocalPath_ }.lastModified ());
 		}
@@ -393,6 +400,37 @@ namespace LMP
 		}
 	}
 
+	QHash<QString, QDateTime> LocalCollectionStorage::GetAllMTimes ()
+	{
+		if (!GetAllMTimes_.exec ())
+		{
+			Util::DBLock::DumpError (GetAllMTimes_);
+			throw std::runtime_error ("cannot get all mtimes");
+		}
+
+		QHash<QString, QDateTime> result;
+		while (GetAllMTimes_.next ())
+			result [GetAllMTimes_.value (0).toString ()] = GetAllMTimes_.value (1).toDateTime ();
+
+		GetAllMTimes_.finish ();
+
+		return result;
+	}
+
+	void LocalCollectionStorage::SetMTimes (const QList<QPair<QString, QDateTime>>& mtimes)
+	{
+		if (mtimes.isEmpty ())
+			return;
+
+		Util::DBLock lock (DB_);
+		lock.Init ();
+
+		for (const auto& pair : mtimes)
+			SetMTime (pair.first, pair.second);
+
+		lock.Good ();
+	}
+
 	const int LovedStateID = 1;
 	const int BannedStateID = 2;
 
@@ -468,6 +506,17 @@ namespace LMP
 		}
 	}
 
+	void LocalCollectionStorage::SetRgAlbumInfo (const QList<QPair<int, RGData>>& tracks)
+	{
+		Util::DBLock lock (DB_);
+		lock.Init ();
+
+		for (const auto& pair : tracks)
+			SetRgTrackInfo (pair.first, pair.second);
+
+		lock.Good ();
+	}
+
 	RGData LocalCollectionStorage::GetRgTrackInfo (const QString& filepath)
 	{
 		GetTrackRgData_.bindValue (":filepath", filepath);
@@ -714,6 +763,9 @@ namespace LMP
 		GetAllTracks_ = QSqlQuery (DB_);
 		GetAllTracks_.prepare ("SELECT Id, Path FROM tracks;");
 
+		GetAllMTimes_ = QSqlQuery (DB_);
+		GetAllMTimes_.prepare ("SELECT tracks.Path, fileTimes.MTime FROM tracks LEFT JOIN fileTimes ON tracks.Id = fileTimes.TrackID;");
+
 		AddArtist_ = QSqlQuery (DB_);
 		AddArtist_.prepare ("INSERT INTO artists (Name) VALUES (:name);");
 
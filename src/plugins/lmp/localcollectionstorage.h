@@ -53,6 +53,7 @@ namespace LMP
 		QSqlQuery GetArtists_;
 		QSqlQuery GetAlbums_;
 		QSqlQuery GetAllTracks_;
+		QSqlQuery GetAllMTimes_;
 
 		QSqlQuery AddArtist_;
 		QSqlQuery AddAlbum_;
@@ -124,6 +125,19 @@ namespace LMP
 		QDateTime GetMTime (const QString&);
 		void SetMTime (const QString&, const QDateTime&);
 
+		/** @brief Returns the stored modification times of all tracks.
+		 *
+		 * The keys are the paths of all the tracks in the collection,
+		 * including the ones without a recorded modification time, for
+		 * which the value is a null QDateTime.
+		 */
+		QHash<QString, QDateTime> GetAllMTimes ();
+
+		/** @brief Updates the modification times of several tracks in a
+		 * single transaction.
+		 */
+		void SetMTimes (const QList<QPair<QString, QDateTime>>&);
+
 		void SetTrackLoved (int);
 		void SetTrackBanned (int);
 		void ClearTrackLovedBanned (int);
@@ -132,6 +146,14 @@ namespace LMP
 
 		QList<int> GetOutdatedRgTracks ();
 		void SetRgTrackInfo (int, const RGData&);
+
+		/** @brief Stores ReplayGain data for all tracks of an album in a
+		 * single transaction.
+		 *
+		 * This way an interrupted write never leaves an album partially
+		 * marked as analysed.
+		 */
+		void SetRgAlbumInfo (const QList<QPair<int, RGData>>&);
 		RGData GetRgTrackInfo (const QString&);
 	private:
 		void MarkLovedBanned (int, int);
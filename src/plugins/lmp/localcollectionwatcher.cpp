@@ -47,6 +47,14 @@ namespace LMP
 				SIGNAL (directoryChanged (QString)),
 				this,
 				SLOT (handleDirectoryChanged (QString)));
+		connect (Watcher_,
+				SIGNAL (filesChanged (QStringList)),
+				this,
+				SLOT (handleFilesChanged (QStringList)));
+		connect (Watcher_,
+				SIGNAL (filesRemoved (QStringList)),
+				this,
+				SLOT (handleFilesRemoved (QStringList)));
 
 		ScanTimer_->setSingleShot (true);
 		connect (ScanTimer_,
@@ -87,6 +95,16 @@ namespace LMP
 		ScheduleDir (path);
 	}
 
+	void LocalCollectionWatcher::handleFilesChanged (const QStringList& paths)
+	{
+		Core::Instance ().GetLocalCollection ()->UpdateFiles (paths);
+	}
+
+	void LocalCollectionWatcher::handleFilesRemoved (const QStringList& paths)
+	{
+		Core::Instance ().GetLocalCollection ()->RemoveFiles (paths);
+	}
+
 	void LocalCollectionWatcher::rescanQueue ()
 	{
 		for (const auto& path : ScheduledDirs_)
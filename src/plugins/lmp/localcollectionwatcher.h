@@ -60,6 +60,8 @@ namespace LMP
 		void ScheduleDir (const QString&);
 	private slots:
 		void handleDirectoryChanged (const QString&);
+		void handleFilesChanged (const QStringList&);
+		void handleFilesRemoved (const QStringList&);
 		void rescanQueue ();
 	};
 }
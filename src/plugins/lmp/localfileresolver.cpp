@@ -41,6 +41,12 @@ namespace LeechCraft
 {
 namespace LMP
 {
+	LocalFileResolver::LocalFileResolver (QObject *parent)
+	: QObject { parent }
+	, Cache_ { 5000 }
+	{
+	}
+
 	TagLib::FileRef LocalFileResolver::GetFileRef (const QString& file) const
 	{
 #ifdef Q_OS_WIN32
@@ -55,17 +61,12 @@ namespace LMP
 		const auto& modified = QFileInfo (file).lastModified ();
 
 		{
-			QReadLocker locker (&CacheLock_);
-			if (Cache_.contains (file))
-			{
-				const auto& pair = Cache_ [file];
-				if (pair.first == modified)
-					return ResolveResult_t::Right (pair.second);
-			}
+			QMutexLocker locker (&CacheLock_);
+			if (const auto cached = Cache_.object (file))
+				if (cached->first == modified)
+					return ResolveResult_t::Right (cached->second);
 		}
 
-		QMutexLocker tlLocker (&TaglibMutex_);
-
 		auto r = GetFileRef (file);
 		auto tag = r.tag ();
 		if (!tag)
@@ -96,10 +97,8 @@ namespace LMP
 			static_cast<qint32> (tag->track ())
 		};
 		{
-			QWriteLocker locker (&CacheLock_);
-			if (Cache_.size () > 200)
-				Cache_.clear ();
-			Cache_ [file] = qMakePair (modified, info);
+			QMutexLocker locker (&CacheLock_);
+			Cache_.insert (file, new QPair<QDateTime, MediaInfo> { modified, info });
 		}
 		return ResolveResult_t::Right (info);
 	}
@@ -111,7 +110,7 @@ namespace LMP
 
 	void LocalFileResolver::flushCache ()
 	{
-		QWriteLocker locker { &CacheLock_ };
+		QMutexLocker locker { &CacheLock_ };
 		Cache_.clear ();
 	}
 }
@@ -32,7 +32,7 @@
 #include <stdexcept>
 #include <QObject>
 #include <QHash>
-#include <QReadWriteLock>
+#include <QCache>
 #include <QMutex>
 #include <QDateTime>
 #include <taglib/fileref.h>
@@ -50,13 +50,23 @@ namespace LMP
 		Q_INTERFACES (LeechCraft::LMP::ITagResolver)
 
 		QMutex TaglibMutex_;
-		QReadWriteLock CacheLock_;
-		QHash<QString, QPair<QDateTime, MediaInfo>> Cache_;
+
+		QMutex CacheLock_;
+		QCache<QString, QPair<QDateTime, MediaInfo>> Cache_;
 	public:
-		using QObject::QObject;
+		LocalFileResolver (QObject* = nullptr);
 
 		TagLib::FileRef GetFileRef (const QString&) const;
+		/** @brief Reads the tags of the given file.
+		 *
+		 * This function is thread-safe and doesn't take the mutex
+		 * returned by GetMutex(): each call uses its own TagLib objects,
+		 * so files can be resolved in parallel.
+		 */
 		ResolveResult_t ResolveInfo (const QString&);
+
+		/** @brief Returns the mutex serializing the tags writers.
+		 */
 		QMutex& GetMutex ();
 	private slots:
 		void flushCache ();
@@ -30,6 +30,7 @@
 #pragma once
 
 #include <QObject>
+#include <QStringList>
 
 namespace LeechCraft
 {
@@ -49,6 +50,22 @@ namespace LMP
 		void RemoveRoot (const QString&);
 	signals:
 		void directoryChanged (const QString&);
+
+		/** @brief Emitted with a batch of files that have been created,
+		 * modified or moved into a watched directory.
+		 *
+		 * Only backends that support per-file notifications emit this
+		 * signal, others emit directoryChanged() instead.
+		 */
+		void filesChanged (const QStringList&);
+
+		/** @brief Emitted with a batch of files or directories that have
+		 * been removed or moved out of a watched directory.
+		 *
+		 * Only backends that support per-file notifications emit this
+		 * signal, others emit directoryChanged() instead.
+		 */
+		void filesRemoved (const QStringList&);
 	};
 }
 }
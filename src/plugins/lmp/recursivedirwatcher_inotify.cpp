@@ -0,0 +1,325 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#include "recursivedirwatcher_inotify.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <QSocketNotifier>
+#include <QTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QtConcurrentRun>
+#include <QtDebug>
+#include <util/threads/futures.h>
+
+namespace LeechCraft
+{
+namespace LMP
+{
+	namespace
+	{
+		const int DebounceInterval = 1000;
+		const int MaxPendingLatency = 5000;
+
+		const auto WatchMask = IN_CLOSE_WRITE |
+				IN_CREATE |
+				IN_DELETE |
+				IN_MOVED_FROM |
+				IN_MOVED_TO |
+				IN_ONLYDIR;
+
+		bool IsUnder (const QString& path, const QString& root)
+		{
+			return path == root || path.startsWith (root + '/');
+		}
+
+		void CollectSubdirs (const QString& path, const QHash<QString, int>& known,
+				QSet<QString>& visited, QStringList& result)
+		{
+			if (known.contains (path))
+				return;
+
+			const auto& canonical = QFileInfo { path }.canonicalFilePath ();
+			if (visited.contains (canonical))
+				return;
+			visited << canonical;
+
+			result << path;
+
+			const QDir dir { path };
+			for (const auto& item : dir.entryList (QDir::Dirs | QDir::NoDotAndDotDot))
+				CollectSubdirs (dir.filePath (item), known, visited, result);
+		}
+
+		QStringList CollectSubdirs (const QString& path, const QHash<QString, int>& known)
+		{
+			QSet<QString> visited;
+			QStringList result;
+			CollectSubdirs (path, known, visited, result);
+			return result;
+		}
+	}
+
+	RecursiveDirWatcherImpl::RecursiveDirWatcherImpl (QObject *parent)
+	: QObject { parent }
+	, Fd_ { inotify_init1 (IN_NONBLOCK | IN_CLOEXEC) }
+	, FlushTimer_ { new QTimer { this } }
+	{
+		FlushTimer_->setSingleShot (true);
+		connect (FlushTimer_,
+				SIGNAL (timeout ()),
+				this,
+				SLOT (flush ()));
+
+		if (Fd_ < 0)
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "cannot initialize inotify:"
+					<< std::strerror (errno);
+			return;
+		}
+
+		Notifier_ = new QSocketNotifier { Fd_, QSocketNotifier::Read, this };
+		connect (Notifier_,
+				SIGNAL (activated (int)),
+				this,
+				SLOT (readEvents ()));
+	}
+
+	RecursiveDirWatcherImpl::~RecursiveDirWatcherImpl ()
+	{
+		delete Notifier_;
+		if (Fd_ >= 0)
+			close (Fd_);
+	}
+
+	void RecursiveDirWatcherImpl::AddRoot (const QString& root)
+	{
+		const bool isCovered = std::any_of (Roots_.begin (), Roots_.end (),
+				[&root] (const QString& other) { return IsUnder (root, other); });
+		Roots_ << root;
+
+		if (!isCovered)
+			RegisterTree (root, false);
+	}
+
+	void RecursiveDirWatcherImpl::RemoveRoot (const QString& root)
+	{
+		if (!Roots_.removeOne (root))
+			return;
+
+		if (std::any_of (Roots_.begin (), Roots_.end (),
+				[&root] (const QString& other) { return IsUnder (root, other); }))
+			return;
+
+		RemoveWatches (root);
+
+		for (const auto& other : Roots_)
+			if (IsUnder (other, root))
+				RegisterTree (other, false);
+	}
+
+	void RecursiveDirWatcherImpl::RegisterTree (const QString& path, bool notify)
+	{
+		if (Fd_ < 0)
+			return;
+
+		qDebug () << Q_FUNC_INFO << "scanning" << path;
+		Util::Sequence (this, QtConcurrent::run ([path, known = Path2WD_] { return CollectSubdirs (path, known); })) >>
+				[this, path, notify] (const QStringList& dirs)
+				{
+					if (std::none_of (Roots_.begin (), Roots_.end (),
+							[&path] (const QString& root) { return IsUnder (path, root); }))
+						return;
+
+					AddWatches (dirs);
+
+					if (notify)
+						emit directoryChanged (path);
+				};
+	}
+
+	void RecursiveDirWatcherImpl::AddWatches (const QStringList& dirs)
+	{
+		for (const auto& dir : dirs)
+		{
+			const auto wd = inotify_add_watch (Fd_, QFile::encodeName (dir).constData (), WatchMask);
+			if (wd < 0)
+			{
+				if (errno == ENOSPC)
+				{
+					if (!WarnedLimit_)
+						qWarning () << Q_FUNC_INFO
+								<< "inotify watch limit reached, consider increasing fs.inotify.max_user_watches;"
+								<< "changes in"
+								<< dir
+								<< "and further directories won't be tracked";
+					WarnedLimit_ = true;
+					return;
+				}
+
+				qWarning () << Q_FUNC_INFO
+						<< "cannot watch"
+						<< dir
+						<< std::strerror (errno);
+				continue;
+			}
+
+			WD2Path_ [wd] = dir;
+			Path2WD_ [dir] = wd;
+		}
+	}
+
+	void RecursiveDirWatcherImpl::RemoveWatches (const QString& path)
+	{
+		for (auto it = Path2WD_.begin (); it != Path2WD_.end (); )
+		{
+			if (!IsUnder (it.key (), path))
+			{
+				++it;
+				continue;
+			}
+
+			inotify_rm_watch (Fd_, *it);
+			WD2Path_.remove (*it);
+			it = Path2WD_.erase (it);
+		}
+	}
+
+	void RecursiveDirWatcherImpl::HandleEvent (int wd, quint32 mask, const QString& name)
+	{
+		if (mask & IN_Q_OVERFLOW)
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "inotify queue overflow, rescanning all roots";
+			PendingChanged_.clear ();
+			PendingRemoved_.clear ();
+			for (const auto& root : Roots_)
+				emit directoryChanged (root);
+			return;
+		}
+
+		if (mask & IN_IGNORED)
+		{
+			const auto& path = WD2Path_.take (wd);
+			if (Path2WD_.value (path, -1) == wd)
+				Path2WD_.remove (path);
+			return;
+		}
+
+		const auto dirPos = WD2Path_.constFind (wd);
+		if (dirPos == WD2Path_.constEnd () || name.isEmpty ())
+			return;
+
+		const auto& path = *dirPos + '/' + name;
+
+		if (mask & IN_ISDIR)
+		{
+			if (mask & (IN_CREATE | IN_MOVED_TO))
+				RegisterTree (path, true);
+			else if (mask & (IN_DELETE | IN_MOVED_FROM))
+			{
+				RemoveWatches (path);
+				MarkRemoved (path);
+			}
+			return;
+		}
+
+		if (mask & (IN_CLOSE_WRITE | IN_MOVED_TO))
+			MarkChanged (path);
+		else if (mask & (IN_DELETE | IN_MOVED_FROM))
+			MarkRemoved (path);
+	}
+
+	void RecursiveDirWatcherImpl::MarkChanged (const QString& path)
+	{
+		PendingRemoved_.remove (path);
+		PendingChanged_ << path;
+		ScheduleFlush ();
+	}
+
+	void RecursiveDirWatcherImpl::MarkRemoved (const QString& path)
+	{
+		PendingChanged_.remove (path);
+		PendingRemoved_ << path;
+		ScheduleFlush ();
+	}
+
+	void RecursiveDirWatcherImpl::ScheduleFlush ()
+	{
+		if (!FlushTimer_->isActive ())
+			PendingSince_.start ();
+
+		if (PendingSince_.elapsed () < MaxPendingLatency)
+			FlushTimer_->start (DebounceInterval);
+	}
+
+	void RecursiveDirWatcherImpl::readEvents ()
+	{
+		alignas (inotify_event) char buf [64 * 1024];
+
+		while (true)
+		{
+			const auto len = read (Fd_, buf, sizeof (buf));
+			if (len <= 0)
+			{
+				if (len < 0 && errno != EAGAIN && errno != EINTR)
+					qWarning () << Q_FUNC_INFO
+							<< "error reading inotify events:"
+							<< std::strerror (errno);
+				break;
+			}
+
+			for (auto ptr = buf; ptr < buf + len; )
+			{
+				const auto event = reinterpret_cast<const inotify_event*> (ptr);
+				HandleEvent (event->wd,
+						event->mask,
+						event->len ? QFile::decodeName (event->name) : QString {});
+				ptr += sizeof (inotify_event) + event->len;
+			}
+		}
+	}
+
+	void RecursiveDirWatcherImpl::flush ()
+	{
+		if (!PendingRemoved_.isEmpty ())
+			emit filesRemoved (PendingRemoved_.toList ());
+		if (!PendingChanged_.isEmpty ())
+			emit filesChanged (PendingChanged_.toList ());
+
+		PendingRemoved_.clear ();
+		PendingChanged_.clear ();
+	}
+}
+}
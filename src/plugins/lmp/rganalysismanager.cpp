@@ -28,6 +28,10 @@
  **********************************************************************/
 
 #include "rganalysismanager.h"
+#include <algorithm>
+#include <QThread>
+#include "core.h"
+#include "player.h"
 #include "localcollection.h"
 #include "localcollectionstorage.h"
 #include "engine/rganalyser.h"
@@ -49,6 +53,8 @@ namespace LMP
 
 		XmlSettingsManager::Instance ().RegisterObject ("AutobuildRG",
 				this, "handleScanFinished");
+		XmlSettingsManager::Instance ().RegisterObject ("RgAnalysisWorkersCount",
+				this, "rotateQueue");
 	}
 
 	namespace
@@ -57,12 +63,65 @@ namespace LMP
 		{
 			return XmlSettingsManager::Instance ().property ("AutobuildRG").toBool ();
 		}
+
+		int GetMaxAnalysers ()
+		{
+			const auto configured = XmlSettingsManager::Instance ()
+					.property ("RgAnalysisWorkersCount").toInt ();
+			return std::max (configured > 0 ? configured : QThread::idealThreadCount (), 1);
+		}
 	}
 
-	void RgAnalysisManager::handleAnalysed ()
+	Collection::Album_ptr RgAnalysisManager::TakeNextAlbum ()
 	{
-		const auto& result = CurrentAnalyser_->GetResult ();
+		const auto player = Core::Instance ().GetPlayer ();
+
+		QStringList priorityPaths { player->GetCurrentMediaInfo ().LocalPath_ };
+		for (const auto& source : player->GetQueue ())
+			if (source.IsLocalFile ())
+				priorityPaths << source.GetLocalPath ();
+
+		QHash<int, int> album2pos;
+		for (int i = 0; i < AlbumsQueue_.size (); ++i)
+			album2pos [AlbumsQueue_.at (i)->ID_] = i;
+
+		for (const auto& path : priorityPaths)
+		{
+			const auto trackId = Coll_->FindTrack (path);
+			if (trackId == -1)
+				continue;
+
+			const auto pos = album2pos.value (Coll_->GetTrackAlbumId (trackId), -1);
+			if (pos != -1)
+				return AlbumsQueue_.takeAt (pos);
+		}
 
+		return AlbumsQueue_.takeFirst ();
+	}
+
+	void RgAnalysisManager::StartAnalyser (const Collection::Album_ptr& album)
+	{
+		QStringList paths;
+		for (const auto& track : album->Tracks_)
+			paths << track.FilePath_;
+
+		if (paths.isEmpty ())
+		{
+			QueuedAlbums_.remove (album->ID_);
+			return;
+		}
+
+		const auto analyser = new RgAnalyser { paths, this };
+		RunningAnalysers_ [analyser] = album->ID_;
+		connect (analyser,
+				SIGNAL (finished ()),
+				this,
+				SLOT (handleAnalysed ()));
+	}
+
+	void RgAnalysisManager::SaveResult (const AlbumRgResult& result)
+	{
+		QList<QPair<int, RGData>> tracks;
 		for (const auto& track : result.Tracks_)
 		{
 			const auto id = Coll_->FindTrack (track.TrackPath_);
@@ -74,39 +133,55 @@ namespace LMP
 				continue;
 			}
 
-			Coll_->GetStorage ()->SetRgTrackInfo (id,
+			tracks.append ({
+					id,
 					{
 						track.TrackGain_,
 						track.TrackPeak_,
 						result.AlbumGain_,
 						result.AlbumPeak_
-					});
+					}
+				});
 		}
 
-		CurrentAnalyser_.reset ();
-		rotateQueue ();
+		try
+		{
+			Coll_->GetStorage ()->SetRgAlbumInfo (tracks);
+		}
+		catch (const std::exception& e)
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "unable to save RG data:"
+					<< e.what ();
+		}
 	}
 
-	void RgAnalysisManager::rotateQueue ()
+	void RgAnalysisManager::handleAnalysed ()
 	{
-		if (AlbumsQueue_.isEmpty ())
+		const auto analyser = qobject_cast<RgAnalyser*> (sender ());
+		if (!analyser || !RunningAnalysers_.contains (analyser))
 			return;
 
+		QueuedAlbums_.remove (RunningAnalysers_.take (analyser));
+		SaveResult (analyser->GetResult ());
+		analyser->deleteLater ();
+
+		rotateQueue ();
+	}
+
+	void RgAnalysisManager::rotateQueue ()
+	{
 		if (!IsScanAllowed ())
 		{
+			for (const auto& album : AlbumsQueue_)
+				QueuedAlbums_.remove (album->ID_);
 			AlbumsQueue_.clear ();
 			return;
 		}
 
-		QStringList paths;
-		for (const auto& track : AlbumsQueue_.takeFirst ()->Tracks_)
-			paths << track.FilePath_;
-
-		CurrentAnalyser_ = std::make_shared<RgAnalyser> (paths);
-		connect (CurrentAnalyser_.get (),
-				SIGNAL (finished ()),
-				this,
-				SLOT (handleAnalysed ()));
+		const auto maxAnalysers = GetMaxAnalysers ();
+		while (RunningAnalysers_.size () < maxAnalysers && !AlbumsQueue_.isEmpty ())
+			StartAnalyser (TakeNextAlbum ());
 	}
 
 	void RgAnalysisManager::handleScanFinished ()
@@ -119,16 +194,21 @@ namespace LMP
 		for (const auto track : Coll_->GetStorage ()->GetOutdatedRgTracks ())
 			albums << Coll_->GetTrackAlbumId (track);
 
-		const bool wasEmpty = AlbumsQueue_.isEmpty ();
-
 		for (auto albumId : albums)
+		{
+			if (QueuedAlbums_.contains (albumId))
+				continue;
+
 			if (const auto& album = Coll_->GetAlbum (albumId))
+			{
 				AlbumsQueue_ << album;
+				QueuedAlbums_ << albumId;
+			}
+		}
 
 		qDebug () << AlbumsQueue_.size ()
 				<< "albums to rescan";
-		if (wasEmpty)
-			rotateQueue ();
+		rotateQueue ();
 	}
 }
 }
@@ -31,6 +31,7 @@
 
 #include <QObject>
 #include <QSet>
+#include <QHash>
 #include "interfaces/lmp/collectiontypes.h"
 
 namespace LeechCraft
@@ -39,18 +40,34 @@ namespace LMP
 {
 	class RgAnalyser;
 	class LocalCollection;
+	struct AlbumRgResult;
 
+	/** @brief Schedules ReplayGain analysis of the collection albums.
+	 *
+	 * Several albums are analysed in parallel, each in its own GStreamer
+	 * pipeline, up to the number of workers configured by the
+	 * RgAnalysisWorkersCount setting. Albums containing the currently
+	 * playing track or the tracks in the play queue are analysed first.
+	 *
+	 * Results are stored as soon as each album is analysed, so an
+	 * interrupted run resumes from the albums that are still outdated.
+	 */
 	class RgAnalysisManager : public QObject
 	{
 		Q_OBJECT
 
 		LocalCollection * const Coll_;
 
-		std::shared_ptr<RgAnalyser> CurrentAnalyser_;
+		QHash<RgAnalyser*, int> RunningAnalysers_;
 
 		QList<Collection::Album_ptr> AlbumsQueue_;
+		QSet<int> QueuedAlbums_;
 	public:
 		RgAnalysisManager (LocalCollection *coll, QObject* = nullptr);
+	private:
+		Collection::Album_ptr TakeNextAlbum ();
+		void StartAnalyser (const Collection::Album_ptr&);
+		void SaveResult (const AlbumRgResult&);
 	private slots:
 		void handleAnalysed ();
 		void rotateQueue ();
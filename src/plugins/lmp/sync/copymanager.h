@@ -53,6 +53,15 @@ namespace LMP
 		void startedCopying (const QString&);
 		void copyProgress (qint64, qint64);
 		void finishedCopying ();
+
+		/** @brief Emitted when a file has been copied successfully.
+		 *
+		 * @param[in] origPath The path of the original file in the
+		 * collection.
+		 * @param[in] size The size of the uploaded file.
+		 */
+		void fileCopied (const QString& origPath, qint64 size);
+
 		void errorCopying (const QString&, const QString&);
 	};
 
@@ -105,18 +114,23 @@ namespace LMP
 		void handleUploadFinished (const QString& localPath, QFile::FileError error, const QString& errorStr) override
 		{
 			const bool remove = CurrentJob_.RemoveOnFinish_;
+			const auto origPath = CurrentJob_.OrigPath_;
 			CurrentJob_ = CopyJobT ();
 
 			if (!Queue_.isEmpty ())
 				StartJob (Queue_.takeFirst ());
 
+			const auto size = QFileInfo { localPath }.size ();
 			if (remove)
 				QFile::remove (localPath);
 
 			if (!errorStr.isEmpty () && error != QFile::NoError)
 				emit errorCopying (localPath, errorStr);
 			else
+			{
+				emit fileCopied (origPath, size);
 				emit finishedCopying ();
+			}
 		}
 	};
 }
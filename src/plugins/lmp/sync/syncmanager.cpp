@@ -31,11 +31,15 @@
 #include <QStringList>
 #include <QtDebug>
 #include <QFileInfo>
+#include <QDir>
+#include <QtConcurrentRun>
 #include <util/util.h>
 #include <util/lmp/util.h>
 #include <util/sll/either.h>
 #include <util/sll/visitor.h>
+#include <util/threads/futures.h>
 #include "copymanager.h"
+#include "syncstate.h"
 #include "../core.h"
 #include "../localfileresolver.h"
 
@@ -64,13 +68,95 @@ namespace LMP
 		QString Filename_;
 	};
 
+	SyncManager::SyncManager (QObject *parent)
+	: SyncManagerBase { parent }
+	, State_ { new SyncState { this } }
+	{
+	}
+
+	namespace
+	{
+		struct FilterResult
+		{
+			QStringList ToSync_;
+			int Skipped_ = 0;
+
+			QHash<QString, SyncState::Record> Refreshed_;
+		};
+
+		FilterResult FilterUnchanged (const QStringList& files, const SyncState::Records_t& records,
+				const QByteArray& fingerprint, const QString& mount)
+		{
+			FilterResult result;
+
+			const QDir mountDir { mount };
+			const bool checkTarget = QFileInfo { mount }.isDir ();
+
+			for (const auto& file : files)
+			{
+				const auto pos = records.find (file);
+				if (pos == records.end () ||
+						pos->ParamsFingerprint_ != fingerprint ||
+						(checkTarget && !mountDir.exists (pos->Filename_)))
+				{
+					result.ToSync_ << file;
+					continue;
+				}
+
+				const QFileInfo fi { file };
+				if (fi.size () != pos->Size_)
+				{
+					result.ToSync_ << file;
+					continue;
+				}
+
+				if (fi.lastModified () == pos->MTime_)
+				{
+					++result.Skipped_;
+					continue;
+				}
+
+				const auto& hash = SyncState::ComputeHash (file);
+				if (hash.isEmpty () || hash != pos->Hash_)
+				{
+					result.ToSync_ << file;
+					continue;
+				}
+
+				auto record = *pos;
+				record.MTime_ = fi.lastModified ();
+				result.Refreshed_ [file] = record;
+				++result.Skipped_;
+			}
+
+			return result;
+		}
+	}
+
 	void SyncManager::AddFiles (ISyncPlugin *syncer, const QString& mount,
 			const QStringList& files, const TranscodingParams& params)
 	{
-		for (const auto& file : files)
-			Source2Params_ [file] = { syncer, mount };
+		const auto& fingerprint = GetFingerprint (params);
+		const auto& records = State_->GetRecords (mount);
+
+		Util::Sequence (this,
+				QtConcurrent::run ([=] { return FilterUnchanged (files, records, fingerprint, mount); })) >>
+				[this, syncer, mount, fingerprint, params] (const FilterResult& result)
+				{
+					for (auto i = result.Refreshed_.begin (); i != result.Refreshed_.end (); ++i)
+						State_->SetRecord (mount, i.key (), i.value ());
 
-		SyncManagerBase::AddFiles (files, params);
+					if (!result.ToSync_.isEmpty ())
+					{
+						for (const auto& file : result.ToSync_)
+							Source2Params_ [file] = { syncer, mount, fingerprint };
+
+						SyncManagerBase::AddFiles (result.ToSync_, params);
+					}
+
+					if (result.Skipped_)
+						AddSkippedFiles (result.Skipped_);
+				};
 	}
 
 	void SyncManager::CreateSyncer (const QString& mount)
@@ -84,6 +170,10 @@ namespace LMP
 				SIGNAL (finishedCopying ()),
 				this,
 				SLOT (handleFinishedCopying ()));
+		connect (mgr,
+				SIGNAL (fileCopied (QString, qint64)),
+				this,
+				SLOT (handleFileCopied (QString, qint64)));
 		connect (mgr,
 				SIGNAL (copyProgress (qint64, qint64)),
 				this,
@@ -135,6 +225,8 @@ namespace LMP
 				{
 					if (!Mount2Copiers_.contains (syncTo.MountPath_))
 						CreateSyncer (syncTo.MountPath_);
+					PendingRecords_ [from] = { syncTo.MountPath_, syncTo.ParamsFingerprint_, filename };
+
 					const CopyJob copyJob
 					{
 						transcoded,
@@ -155,5 +247,35 @@ namespace LMP
 					handleErrorCopying (transcoded, errString);
 				});
 	}
+
+	void SyncManager::handleFileCopied (const QString& origPath, qint64 size)
+	{
+		SyncManagerBase::handleFileCopied (origPath, size);
+
+		if (!PendingRecords_.contains (origPath))
+			return;
+
+		const auto& pending = PendingRecords_.take (origPath);
+		Util::Sequence (this,
+				QtConcurrent::run ([origPath]
+						{
+							const QFileInfo fi { origPath };
+
+							SyncState::Record record;
+							record.Size_ = fi.size ();
+							record.MTime_ = fi.lastModified ();
+							record.Hash_ = SyncState::ComputeHash (origPath);
+							return record;
+						})) >>
+				[this, origPath, pending] (SyncState::Record record)
+				{
+					if (record.Hash_.isEmpty ())
+						return;
+
+					record.ParamsFingerprint_ = pending.ParamsFingerprint_;
+					record.Filename_ = pending.Filename_;
+					State_->SetRecord (pending.MountPath_, origPath, record);
+				};
+	}
 }
 }
@@ -29,6 +29,7 @@
 
 #pragma once
 
+#include <QHash>
 #include "syncmanagerbase.h"
 #include "interfaces/lmp/isyncplugin.h"
 
@@ -37,6 +38,7 @@ namespace LeechCraft
 namespace LMP
 {
 	class TranscodeManager;
+	class SyncState;
 	struct TranscodingParams;
 
 	template<typename>
@@ -53,16 +55,36 @@ namespace LMP
 		{
 			ISyncPlugin *Syncer_;
 			QString MountPath_;
+			QByteArray ParamsFingerprint_;
 		};
 		QMap<QString, SyncTo> Source2Params_;
+
+		SyncState * const State_;
+
+		struct PendingRecord
+		{
+			QString MountPath_;
+			QByteArray ParamsFingerprint_;
+			QString Filename_;
+		};
+		QHash<QString, PendingRecord> PendingRecords_;
 	public:
-		using SyncManagerBase::SyncManagerBase;
+		SyncManager (QObject* = nullptr);
 
+		/** @brief Syncs the given files to the device at the given mount
+		 * point.
+		 *
+		 * Files that have already been synced to this device with the
+		 * same transcoding parameters and haven't changed since then are
+		 * skipped. This check is done in a separate thread, so the
+		 * actual transcoding and copying starts asynchronously.
+		 */
 		void AddFiles (ISyncPlugin*, const QString& mount, const QStringList&, const TranscodingParams&);
 	private:
 		void CreateSyncer (const QString&);
 	protected slots:
 		void handleFileTranscoded (const QString& from, const QString&, QString);
+		void handleFileCopied (const QString&, qint64) override;
 	};
 }
 }
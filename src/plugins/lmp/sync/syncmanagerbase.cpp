@@ -28,7 +28,9 @@
  **********************************************************************/
 
 #include "syncmanagerbase.h"
+#include <algorithm>
 #include <QFileInfo>
+#include <util/util.h>
 #include <util/xpc/util.h>
 #include "transcodemanager.h"
 #include "../core.h"
@@ -60,8 +62,25 @@ namespace LMP
 				SLOT (handleFileTCFailed (QString)));
 	}
 
+	double SyncManagerBase::StageStats::GetBytesPerSecond () const
+	{
+		return Bytes_ * 1000.0 / std::max<qint64> (ElapsedMs_, 1);
+	}
+
 	void SyncManagerBase::AddFiles (const QStringList& files, const TranscodingParams& params)
 	{
+		if (!TotalTCCount_)
+		{
+			Stats_.Transcoding_ = {};
+			TCTimer_.start ();
+		}
+		if (!TotalCopyCount_)
+		{
+			Stats_.Copying_ = {};
+			Stats_.SkippedFiles_ = 0;
+			CopyTimer_.start ();
+		}
+
 		const int numFiles = files.size ();
 		TotalTCCount_ += numFiles;
 		TotalCopyCount_ += numFiles;
@@ -74,11 +93,32 @@ namespace LMP
 		emit uploadLog (tr ("Uploading %n file(s)", 0, numFiles));
 	}
 
+	void SyncManagerBase::AddSkippedFiles (int count)
+	{
+		// Nothing is being copied, so this is a batch of skipped files only.
+		if (!TotalCopyCount_)
+			Stats_.SkippedFiles_ = 0;
+
+		Stats_.SkippedFiles_ += count;
+		emit uploadLog (tr ("Skipping %n unchanged file(s)", 0, count));
+	}
+
 	void SyncManagerBase::CheckTCFinished ()
 	{
 		if (TranscodedCount_ < TotalTCCount_)
 			return;
 
+		if (TCTimer_.isValid ())
+		{
+			Stats_.Transcoding_.ElapsedMs_ += TCTimer_.elapsed ();
+			TCTimer_.invalidate ();
+		}
+
+		const auto& tcStats = Stats_.Transcoding_;
+		if (tcStats.Files_)
+			emit uploadLog (tr ("Transcoded %n file(s) at %1/s.", 0, tcStats.Files_)
+					.arg (Util::MakePrettySize (tcStats.GetBytesPerSecond ())));
+
 		if (WereTCErrors_)
 		{
 			const auto& e = Util::MakeNotification ("LMP",
@@ -98,6 +138,19 @@ namespace LMP
 		if (CopiedCount_ < TotalCopyCount_)
 			return;
 
+		if (CopyTimer_.isValid ())
+		{
+			Stats_.Copying_.ElapsedMs_ += CopyTimer_.elapsed ();
+			CopyTimer_.invalidate ();
+		}
+
+		const auto& copyStats = Stats_.Copying_;
+		if (copyStats.Files_)
+			emit uploadLog (tr ("Copied %n file(s) at %1/s.", 0, copyStats.Files_)
+					.arg (Util::MakePrettySize (copyStats.GetBytesPerSecond ())));
+		if (Stats_.SkippedFiles_)
+			emit uploadLog (tr ("%n unchanged file(s) skipped.", 0, Stats_.SkippedFiles_));
+
 		TotalCopyCount_ = 0;
 		CopiedCount_ = 0;
 
@@ -107,9 +160,15 @@ namespace LMP
 		Core::Instance ().SendEntity (e);
 	}
 
-	void SyncManagerBase::HandleFileTranscoded (const QString&, const QString&)
+	void SyncManagerBase::HandleFileTranscoded (const QString& from, const QString& transcoded)
 	{
 		qDebug () << Q_FUNC_INFO << "file transcoded, gonna copy";
+		if (from != transcoded)
+		{
+			++Stats_.Transcoding_.Files_;
+			Stats_.Transcoding_.Bytes_ += QFileInfo { from }.size ();
+		}
+
 		emit transcodingProgress (++TranscodedCount_, TotalTCCount_, this);
 		CheckTCFinished ();
 	}
@@ -148,6 +207,12 @@ namespace LMP
 		CheckUploadFinished ();
 	}
 
+	void SyncManagerBase::handleFileCopied (const QString&, qint64 size)
+	{
+		++Stats_.Copying_.Files_;
+		Stats_.Copying_.Bytes_ += size;
+	}
+
 	void SyncManagerBase::handleCopyProgress (qint64 done, qint64 total)
 	{
 		emit singleUploadProgress (done, total, this);
@@ -31,6 +31,7 @@
 
 #include <QObject>
 #include <QMap>
+#include <QElapsedTimer>
 
 namespace LeechCraft
 {
@@ -43,8 +44,31 @@ namespace LMP
 	class SyncManagerBase : public QObject
 	{
 		Q_OBJECT
-
 	protected:
+		/** @brief Throughput statistics of a single sync stage.
+		 */
+		struct StageStats
+		{
+			int Files_ = 0;
+			qint64 Bytes_ = 0;
+			qint64 ElapsedMs_ = 0;
+
+			/** @brief Returns the throughput of the stage in bytes per
+			 * second.
+			 */
+			double GetBytesPerSecond () const;
+		};
+
+		/** @brief Statistics of the current or the last sync batch.
+		 */
+		struct Stats
+		{
+			StageStats Transcoding_;
+			StageStats Copying_;
+
+			int SkippedFiles_ = 0;
+		};
+
 		TranscodeManager *Transcoder_;
 
 		int TranscodedCount_;
@@ -53,10 +77,15 @@ namespace LMP
 
 		int CopiedCount_;
 		int TotalCopyCount_;
+
+		Stats Stats_;
+		QElapsedTimer TCTimer_;
+		QElapsedTimer CopyTimer_;
 	public:
 		SyncManagerBase (QObject* = 0);
 	protected:
 		void AddFiles (const QStringList&, const TranscodingParams&);
+		void AddSkippedFiles (int);
 		void HandleFileTranscoded (const QString&, const QString&);
 	private:
 		void CheckTCFinished ();
@@ -67,6 +96,7 @@ namespace LMP
 		void handleFileTCFailed (const QString&);
 		void handleStartedCopying (const QString&);
 		void handleFinishedCopying ();
+		virtual void handleFileCopied (const QString&, qint64);
 		void handleCopyProgress (qint64, qint64);
 		void handleErrorCopying (const QString&, const QString&);
 	signals:
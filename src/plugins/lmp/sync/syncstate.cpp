@@ -0,0 +1,174 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#include "syncstate.h"
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QFile>
+#include <QSaveFile>
+#include <QTimer>
+#include <QtDebug>
+#include <util/sys/paths.h>
+
+namespace LeechCraft
+{
+namespace LMP
+{
+	namespace
+	{
+		const quint8 StateVersion = 1;
+	}
+
+	QDataStream& operator<< (QDataStream& out, const SyncState::Record& record)
+	{
+		return out << record.Size_
+				<< record.MTime_
+				<< record.Hash_
+				<< record.ParamsFingerprint_
+				<< record.Filename_;
+	}
+
+	QDataStream& operator>> (QDataStream& in, SyncState::Record& record)
+	{
+		return in >> record.Size_
+				>> record.MTime_
+				>> record.Hash_
+				>> record.ParamsFingerprint_
+				>> record.Filename_;
+	}
+
+	SyncState::SyncState (QObject *parent)
+	: QObject { parent }
+	, Path_ { Util::CreateIfNotExists ("lmp").filePath ("syncstate.dat") }
+	, SaveTimer_ { new QTimer { this } }
+	{
+		SaveTimer_->setSingleShot (true);
+		connect (SaveTimer_,
+				SIGNAL (timeout ()),
+				this,
+				SLOT (save ()));
+
+		Load ();
+	}
+
+	SyncState::~SyncState ()
+	{
+		if (SaveTimer_->isActive ())
+			save ();
+	}
+
+	SyncState::Records_t SyncState::GetRecords (const QString& mount) const
+	{
+		return Mount2Records_.value (mount);
+	}
+
+	void SyncState::SetRecord (const QString& mount, const QString& origPath, const Record& record)
+	{
+		Mount2Records_ [mount] [origPath] = record;
+
+		if (!SaveTimer_->isActive ())
+			SaveTimer_->start (2000);
+	}
+
+	QByteArray SyncState::ComputeHash (const QString& path)
+	{
+		QFile file { path };
+		if (!file.open (QIODevice::ReadOnly))
+			return {};
+
+		QCryptographicHash hash { QCryptographicHash::Sha1 };
+		if (!hash.addData (&file))
+			return {};
+
+		return hash.result ();
+	}
+
+	void SyncState::Load ()
+	{
+		QFile file { Path_ };
+		if (!file.exists ())
+			return;
+
+		if (!file.open (QIODevice::ReadOnly))
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "unable to open"
+					<< Path_
+					<< file.errorString ();
+			return;
+		}
+
+		QDataStream in { &file };
+
+		quint8 version = 0;
+		in >> version;
+		if (version != StateVersion)
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "unknown version"
+					<< version;
+			return;
+		}
+
+		in >> Mount2Records_;
+		if (in.status () != QDataStream::Ok)
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "corrupted sync state in"
+					<< Path_;
+			Mount2Records_.clear ();
+		}
+	}
+
+	void SyncState::save ()
+	{
+		SaveTimer_->stop ();
+
+		QSaveFile file { Path_ };
+		if (!file.open (QIODevice::WriteOnly))
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "unable to open"
+					<< Path_
+					<< file.errorString ();
+			return;
+		}
+
+		QDataStream out { &file };
+		out << StateVersion
+				<< Mount2Records_;
+
+		if (!file.commit ())
+			qWarning () << Q_FUNC_INFO
+					<< "unable to save"
+					<< Path_
+					<< file.errorString ();
+	}
+}
+}
@@ -0,0 +1,96 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#pragma once
+
+#include <QObject>
+#include <QHash>
+#include <QDateTime>
+
+class QTimer;
+class QDataStream;
+
+namespace LeechCraft
+{
+namespace LMP
+{
+	/** @brief Remembers which files have been synced to which devices.
+	 *
+	 * For each device mount point and each source file the size,
+	 * modification time and content hash of the source are stored along
+	 * with the fingerprint of the transcoding parameters and the name of
+	 * the resulting file on the device. This allows skipping files that
+	 * have already been synced and haven't changed since then.
+	 *
+	 * The state is kept in memory and written to disk shortly after
+	 * each change.
+	 */
+	class SyncState : public QObject
+	{
+		Q_OBJECT
+	public:
+		struct Record
+		{
+			qint64 Size_ = -1;
+			QDateTime MTime_;
+			QByteArray Hash_;
+
+			QByteArray ParamsFingerprint_;
+			QString Filename_;
+		};
+		typedef QHash<QString, Record> Records_t;
+	private:
+		const QString Path_;
+
+		QHash<QString, Records_t> Mount2Records_;
+
+		QTimer * const SaveTimer_;
+	public:
+		SyncState (QObject* = nullptr);
+		~SyncState ();
+
+		Records_t GetRecords (const QString& mount) const;
+		void SetRecord (const QString& mount, const QString& origPath, const Record&);
+
+		/** @brief Computes the content hash of the given file.
+		 *
+		 * Returns an empty array if the file cannot be read. This
+		 * function may be called from any thread.
+		 */
+		static QByteArray ComputeHash (const QString&);
+	private:
+		void Load ();
+	private slots:
+		void save ();
+	};
+
+	QDataStream& operator<< (QDataStream&, const SyncState::Record&);
+	QDataStream& operator>> (QDataStream&, SyncState::Record&);
+}
+}
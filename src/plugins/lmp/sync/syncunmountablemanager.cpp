@@ -49,6 +49,10 @@ namespace LMP
 				SIGNAL (finishedCopying ()),
 				this,
 				SLOT (handleFinishedCopying ()));
+		connect (CopyMgr_,
+				SIGNAL (fileCopied (QString, qint64)),
+				this,
+				SLOT (handleFileCopied (QString, qint64)));
 		connect (CopyMgr_,
 				SIGNAL (copyProgress (qint64, qint64)),
 				this,
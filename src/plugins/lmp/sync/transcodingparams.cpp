@@ -29,12 +29,28 @@
 
 #include "transcodingparams.h"
 #include <QDataStream>
+#include <QCryptographicHash>
 #include <QtDebug>
 
 namespace LeechCraft
 {
 namespace LMP
 {
+	QByteArray GetFingerprint (const TranscodingParams& params)
+	{
+		QByteArray data;
+		{
+			QDataStream out { &data, QIODevice::WriteOnly };
+			out << params.FilePattern_
+					<< params.FormatID_;
+			if (!params.FormatID_.isEmpty ())
+				out << static_cast<int> (params.BitrateType_)
+						<< params.Quality_
+						<< params.OnlyLossless_;
+		}
+		return QCryptographicHash::hash (data, QCryptographicHash::Sha1);
+	}
+
 	QDataStream& operator<< (QDataStream& out, const TranscodingParams& params)
 	{
 		out << static_cast<quint8> (2);
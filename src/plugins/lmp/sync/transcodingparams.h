@@ -57,6 +57,14 @@ namespace LMP
 		bool OnlyLossless_;
 	};
 
+	/** @brief Returns a fingerprint of the parameters affecting the
+	 * resulting files.
+	 *
+	 * The number of threads is not taken into account, since it doesn't
+	 * change the output.
+	 */
+	QByteArray GetFingerprint (const TranscodingParams&);
+
 	QDataStream& operator<< (QDataStream&, const TranscodingParams&);
 	QDataStream& operator>> (QDataStream&, TranscodingParams&);
 }
@@ -0,0 +1,146 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#include "tagscanner.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <QFutureInterface>
+#include <QSet>
+#include <QThread>
+#include <QStorageInfo>
+#include <QtConcurrentRun>
+#include <QtDebug>
+#include <util/sll/either.h>
+#include "localfileresolver.h"
+#include "xmlsettingsmanager.h"
+
+namespace LeechCraft
+{
+namespace LMP
+{
+	namespace
+	{
+		struct ScanState
+		{
+			QFutureInterface<MediaInfo> Iface_;
+
+			const QStringList Paths_;
+
+			std::atomic<int> NextIndex_ { 0 };
+			std::atomic<int> Processed_ { 0 };
+			std::atomic<int> ActiveWorkers_;
+
+			ScanState (const QStringList& paths, int workers)
+			: Paths_ { paths }
+			, ActiveWorkers_ { workers }
+			{
+			}
+		};
+
+		void RunWorker (LocalFileResolver *resolver, ScanState& state)
+		{
+			const auto size = state.Paths_.size ();
+			for (int i = state.NextIndex_++; i < size; i = state.NextIndex_++)
+			{
+				if (state.Iface_.isCanceled ())
+					break;
+
+				const auto& info = resolver->ResolveInfo (state.Paths_.at (i)).ToRight ([] (const ResolveError& error)
+						{
+							qWarning () << Q_FUNC_INFO
+									<< "error resolving media info for"
+									<< error.FilePath_
+									<< error.ReasonString_;
+							return MediaInfo {};
+						});
+				state.Iface_.reportResult (info, i);
+				state.Iface_.setProgressValue (++state.Processed_);
+			}
+
+			if (!--state.ActiveWorkers_)
+				state.Iface_.reportFinished ();
+		}
+
+		bool IsNetworkFS (const QString& path)
+		{
+			static const QSet<QByteArray> networkFSes
+			{
+				"nfs",
+				"nfs4",
+				"cifs",
+				"smbfs",
+				"smb3",
+				"fuse.sshfs",
+				"9p",
+				"afs"
+			};
+			return networkFSes.contains (QStorageInfo { path }.fileSystemType ());
+		}
+	}
+
+	QFuture<MediaInfo> TagScanner::Scan (LocalFileResolver *resolver,
+			const QStringList& paths, const QStringList& rootPaths)
+	{
+		const auto workers = std::max (std::min (GetWorkersCount (rootPaths), paths.size ()), 1);
+		Pool_.setMaxThreadCount (workers);
+
+		const auto state = std::make_shared<ScanState> (paths, workers);
+		state->Iface_.setProgressRange (0, paths.size ());
+		state->Iface_.reportStarted ();
+		const auto& future = state->Iface_.future ();
+
+		if (paths.isEmpty ())
+		{
+			state->Iface_.reportFinished ();
+			return future;
+		}
+
+		for (int i = 0; i < workers; ++i)
+			QtConcurrent::run (&Pool_, [resolver, state] { RunWorker (resolver, *state); });
+
+		return future;
+	}
+
+	int TagScanner::GetWorkersCount (const QStringList& rootPaths)
+	{
+		const auto configured = XmlSettingsManager::Instance ().property ("ScanWorkersCount").toInt ();
+		if (configured > 0)
+			return configured;
+
+		const auto ideal = std::max (QThread::idealThreadCount (), 1);
+
+		// network filesystems are latency-bound, so keep more requests in flight
+		const auto hasNetwork = std::any_of (rootPaths.begin (), rootPaths.end (), &IsNetworkFS);
+		return hasNetwork ?
+				std::min (ideal * 4, 32) :
+				ideal;
+	}
+}
+}
@@ -0,0 +1,74 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#pragma once
+
+#include <QObject>
+#include <QFuture>
+#include <QThreadPool>
+#include "mediainfo.h"
+
+namespace LeechCraft
+{
+namespace LMP
+{
+	class LocalFileResolver;
+
+	/** @brief Reads the tags of the collection files in parallel.
+	 *
+	 * The files are processed by a dedicated bounded thread pool, each
+	 * worker using its own TagLib objects.
+	 */
+	class TagScanner : public QObject
+	{
+		QThreadPool Pool_;
+	public:
+		using QObject::QObject;
+
+		/** @brief Starts reading the tags of the given files.
+		 *
+		 * The returned future reports a MediaInfo for each path, in the
+		 * same order as \em paths, with an empty MediaInfo for the files
+		 * whose tags couldn't be read. Its progress is the number of
+		 * files processed so far.
+		 *
+		 * Canceling the returned future makes the workers stop after
+		 * the files they are currently processing.
+		 *
+		 * @param[in] paths The files to scan.
+		 * @param[in] rootPaths The collection root paths the files belong
+		 * to, used to choose the number of workers.
+		 */
+		QFuture<MediaInfo> Scan (LocalFileResolver *resolver,
+				const QStringList& paths, const QStringList& rootPaths);
+	private:
+		static int GetWorkersCount (const QStringList& rootPaths);
+	};
+}
+}
@@ -30,6 +30,7 @@
 #include "core.h"
 #include <algorithm>
 #include <functional>
+#include <memory>
 #include <thread>
 #include <QNetworkRequest>
 #include <QRegExp>
@@ -42,7 +43,6 @@
 #include <QDir>
 #include <QCoreApplication>
 #include <QtConcurrentRun>
-#include <QtConcurrentMap>
 #include <QMenu>
 #include <QMainWindow>
 #include <QDir>
@@ -66,6 +66,7 @@
 #include "userfiltersmodel.h"
 #include "lineparser.h"
 #include "subscriptionsmodel.h"
+#include "filtercache.h"
 
 Q_DECLARE_METATYPE (QNetworkReply*);
 
@@ -77,6 +78,18 @@ namespace CleanWeb
 {
 	namespace
 	{
+		Filter ParseToFilter (const QByteArray& contents)
+		{
+			auto rawLines = QString::fromUtf8 (contents).split ('\n', QString::SkipEmptyParts);
+			if (!rawLines.isEmpty ())
+				rawLines.removeAt (0);
+			const auto& lines = Util::Map (rawLines, Util::QStringTrimmed {});
+
+			Filter f;
+			std::for_each (lines.begin (), lines.end (), LineParser (&f));
+			return f;
+		}
+
 		QList<Filter> ParseToFilters (const QStringList& paths)
 		{
 			QList<Filter> result;
@@ -93,16 +106,19 @@ namespace CleanWeb
 					continue;
 				}
 
-				const auto& data = QString::fromUtf8 (file.readAll ());
-				auto rawLines = data.split ('\n', QString::SkipEmptyParts);
-				if (!rawLines.isEmpty ())
-					rawLines.removeAt (0);
-				const auto& lines = Util::Map (rawLines, Util::QStringTrimmed {});
+				const auto& contents = file.readAll ();
+				const auto& filename = QFileInfo (filePath).fileName ();
+				const auto& cacheKey = FilterCache::GetKey (contents);
 
-				Filter f;
-				std::for_each (lines.begin (), lines.end (), LineParser (&f));
+				if (auto cached = FilterCache::Load (filename, cacheKey))
+				{
+					result << *cached;
+					continue;
+				}
 
-				f.SD_.Filename_ = QFileInfo (filePath).fileName ();
+				auto f = ParseToFilter (contents);
+				f.SD_.Filename_ = filename;
+				FilterCache::Save (filename, cacheKey, f);
 
 				result << f;
 			}
@@ -113,6 +129,7 @@ namespace CleanWeb
 	Core::Core (SubscriptionsModel *model, UserFiltersModel *ufm, const ICoreProxy_ptr& proxy)
 	: UserFilters_ { ufm }
 	, SubsModel_ { model }
+	, Matchers_ { std::make_shared<const Matchers> () }
 	, Proxy_ { proxy }
 	{
 		connect (SubsModel_,
@@ -124,13 +141,29 @@ namespace CleanWeb
 				this,
 				SLOT (regenFilterCaches ()));
 
+		if (qgetenv ("LC_POSHUKU_CLEANWEB_DUMP_CACHE_STATS") == "1")
+		{
+			const auto timer = new QTimer { this };
+			connect (timer,
+					&QTimer::timeout,
+					this,
+					[this] { qDebug () << "CleanWeb verdict cache:" << GetVerdictCacheStats (); });
+			timer->start (60 * 1000);
+		}
+
 		const auto& path = Util::CreateIfNotExists ("cleanweb");
 		const auto& infos = path.entryInfoList (QDir::Files | QDir::Readable);
 		const auto& paths = Util::Map (infos, &QFileInfo::absoluteFilePath);
 
+		const auto& filenames = Util::Map (infos, &QFileInfo::fileName);
+
 		Util::Sequence (nullptr, QtConcurrent::run (ParseToFilters, paths)) >>
-				[this] (const QList<Filter>& filters)
+				[this, filenames] (const QList<Filter>& filters)
 				{
+					// Images are saved while parsing, so the sweep is only
+					// safe once it's done.
+					FilterCache::RemoveOrphans (filenames);
+
 					SubsModel_->SetInitialFilters (filters);
 
 					QTimer::singleShot (0,
@@ -188,111 +221,6 @@ namespace CleanWeb
 		}
 	}
 
-	namespace
-	{
-#if defined (Q_OS_WIN32) || defined (Q_OS_MAC)
-		// Thanks for this goes to http://www.codeproject.com/KB/string/patmatch.aspx
-		bool WildcardMatches (const char *pattern, const char *str)
-		{
-			enum State {
-				Exact,        // exact match
-				Any,        // ?
-				AnyRepeat    // *
-			};
-
-			const char *s = str;
-			const char *p = pattern;
-			const char *q = 0;
-			int state = 0;
-
-			bool match = true;
-			while (match && *p) {
-				if (*p == '*') {
-					state = AnyRepeat;
-					q = p+1;
-				} else if (*p == '?') state = Any;
-				else state = Exact;
-
-				if (*s == 0) break;
-
-				switch (state) {
-					case Exact:
-						match = *s == *p;
-						s++;
-						p++;
-						break;
-
-					case Any:
-						match = true;
-						s++;
-						p++;
-						break;
-
-					case AnyRepeat:
-						match = true;
-						s++;
-
-						if (*s == *q) p++;
-						break;
-				}
-			}
-
-			if (state == AnyRepeat) return (*s == *q);
-			else if (state == Any) return (*s == *p);
-			else return match && (*s == *p);
-		}
-#else
-#include <fnmatch.h>
-
-		bool WildcardMatches (const char *pat, const char *str)
-		{
-			return !fnmatch (pat, str, 0);
-		}
-#endif
-
-		bool Matches (const FilterItem_ptr& item,
-				const QByteArray& urlUtf8, const QString& domain)
-		{
-			const auto& opt = item->Option_;
-			if (opt.MatchObjects_ != FilterOption::MatchObject::All)
-			{
-				if (!(opt.MatchObjects_ & FilterOption::MatchObject::CSS) &&
-						!(opt.MatchObjects_ & FilterOption::MatchObject::Image) &&
-						!(opt.MatchObjects_ & FilterOption::MatchObject::Script) &&
-						!(opt.MatchObjects_ & FilterOption::MatchObject::Object) &&
-						!(opt.MatchObjects_ & FilterOption::MatchObject::ObjSubrequest))
-					return false;
-			}
-
-			if (std::any_of (opt.NotDomains_.begin (), opt.NotDomains_.end (),
-						[&domain, &opt] (const QString& notDomain)
-							{ return domain.endsWith (notDomain, opt.Case_); }))
-				return false;
-
-			if (!opt.Domains_.isEmpty () &&
-					std::none_of (opt.Domains_.begin (), opt.Domains_.end (),
-							[&domain, &opt] (const QString& doDomain)
-								{ return domain.endsWith (doDomain, opt.Case_); }))
-				return false;
-
-			switch (opt.MatchType_)
-			{
-			case FilterOption::MatchType::Regexp:
-				return item->RegExp_.Matches (urlUtf8);
-			case FilterOption::MatchType::Wildcard:
-				return WildcardMatches (item->PlainMatcher_.constData (), urlUtf8.constData ());
-			case FilterOption::MatchType::Plain:
-				return urlUtf8.indexOf (item->PlainMatcher_) >= 0;
-			case FilterOption::MatchType::Begin:
-				return urlUtf8.startsWith (item->PlainMatcher_);
-			case FilterOption::MatchType::End:
-				return urlUtf8.endsWith (item->PlainMatcher_);
-			}
-
-			return false;
-		}
-	}
-
 	namespace
 	{
 		FilterOption::MatchObjects ResourceType2Objs (IInterceptableRequests::ResourceType type)
@@ -328,9 +256,76 @@ namespace CleanWeb
 			return nextComponent1 == nextComponent2;
 		}
 
+		/* Returns the part of the URL up to the path, or a null string
+		 * if the URL has no authority part.
+		 */
+		QString GetAuthorityPrefix (const QString& urlStr)
+		{
+			const auto schemeEnd = urlStr.indexOf ("://");
+			if (schemeEnd < 0)
+				return {};
+
+			for (int i = schemeEnd + 3; i < urlStr.size (); ++i)
+				switch (urlStr.at (i).unicode ())
+				{
+				case '/':
+				case '?':
+				case '#':
+					return urlStr.left (i);
+				}
+
+			return urlStr;
+		}
+
+		/* Checks whether the item matching some string implies that it
+		 * also matches any string starting with that one.
+		 */
+		bool IsPrefixStable (const FilterItem& item)
+		{
+			const auto& opt = item.Option_;
+			switch (opt.MatchType_)
+			{
+			case FilterOption::MatchType::Plain:
+			case FilterOption::MatchType::Begin:
+				return true;
+			case FilterOption::MatchType::End:
+				return false;
+			case FilterOption::MatchType::Wildcard:
+				return item.PlainMatcher_.endsWith ('*') && !item.PlainMatcher_.endsWith ("\\*");
+			case FilterOption::MatchType::Regexp:
+			{
+				// Without PCRE regexps are matched against the whole string.
+				if (!Util::RegExp::IsFast ())
+					return false;
+
+				const auto& pattern = item.RegExp_.GetPattern ();
+				return !pattern.contains ('$') &&
+						!pattern.contains ("(?") &&
+						!pattern.contains ("\\b", Qt::CaseInsensitive) &&
+						!pattern.contains ("\\z", Qt::CaseInsensitive);
+			}
+			}
+
+			return false;
+		}
+
+		/* Checks whether the item matches any URL starting with the
+		 * given authority prefix, that is, any URL on the same host.
+		 */
+		bool MatchesHostWide (const FilterItem_ptr& item, const QString& prefix, const QString& domain)
+		{
+			if (!IsPrefixStable (*item))
+				return false;
+
+			const auto& casedPrefix = item->Option_.Case_ == Qt::CaseSensitive ?
+					prefix :
+					prefix.toLower ();
+			return Matches (item, casedPrefix.toUtf8 (), domain);
+		}
+
 		bool ShouldReject (const IInterceptableRequests::RequestInfo& req,
-				const QList<QList<FilterItem_ptr>>& exceptions,
-				const QList<QList<FilterItem_ptr>>& filters)
+				const FilterMatcher& exceptions, const FilterMatcher& filters,
+				VerdictCache& cache)
 		{
 			if (!XmlSettingsManager::Instance ()->property ("EnableFiltering").toBool ())
 				return false;
@@ -340,58 +335,50 @@ namespace CleanWeb
 
 			static const bool shouldDebug = qgetenv ("LC_POSHUKU_CLEANWEB_DUMP_MATCHES") == "1";
 
-			const auto objs = ResourceType2Objs (req.ResourceType_);
-
 			const QUrl& url = req.RequestUrl_;
 			const QString& urlStr = url.toString ();
-			const auto& urlUtf8 = urlStr.toUtf8 ();
-			const QString& cinUrlStr = urlStr.toLower ();
-			const auto& cinUrlUtf8 = cinUrlStr.toUtf8 ();
 
-			const QString& domain = req.PageUrl_.host ();
-			const bool isThirdParty = !IsSameDomain (req.PageUrl_, url);
+			const VerdictCache::Key key { urlStr, req.PageUrl_.host (), static_cast<int> (req.ResourceType_) };
+			if (const auto verdict = cache.GetVerdict (key))
+				return *verdict;
 
-			auto matches = [=] (const QList<QList<FilterItem_ptr>>& chunks)
+			const RequestMatchInfo info
 			{
-				return QtConcurrent::blockingMappedReduced (chunks.begin (), chunks.end (),
-						std::function<bool (const QList<FilterItem_ptr>&)>
-						{
-							[=] (const QList<FilterItem_ptr>& items)
-							{
-								for (const auto& item : items)
-								{
-									const auto& opt = item->Option_;
-									if (opt.ThirdParty_ != FilterOption::ThirdParty::Unspecified)
-										if ((opt.ThirdParty_ == FilterOption::ThirdParty::Yes) != isThirdParty)
-											continue;
-
-									if (opt.MatchObjects_ != FilterOption::MatchObject::All &&
-											!(objs & opt.MatchObjects_))
-										continue;
-
-									const auto& utf8 = item->Option_.Case_ == Qt::CaseSensitive ? urlUtf8 : cinUrlUtf8;
-									if (Matches (item, utf8, domain))
-									{
-										if (shouldDebug)
-											qDebug () << Q_FUNC_INFO
-													<< utf8
-													<< "matches"
-													<< *item;
-										return true;
-									}
-								}
-
-								return false;
-							}
-						},
-						+[] (bool& res, bool value) { res = res || value; });
+				urlStr.toUtf8 (),
+				urlStr.toLower ().toUtf8 (),
+				key.PageHost_,
+				!IsSameDomain (req.PageUrl_, url),
+				ResourceType2Objs (req.ResourceType_)
 			};
-			if (matches (exceptions))
+
+			if (exceptions.Match (info))
+			{
+				cache.SetVerdict (key, false);
 				return false;
-			if (matches (filters))
+			}
+
+			const VerdictCache::Key hostKey { GetAuthorityPrefix (urlStr), key.PageHost_, key.ResourceType_ };
+			if (!hostKey.Url_.isEmpty () && cache.IsHostMatched (hostKey))
+			{
+				cache.SetVerdict (key, true);
 				return true;
+			}
 
-			return false;
+			const auto item = filters.Match (info);
+			if (item)
+			{
+				if (shouldDebug)
+					qDebug () << Q_FUNC_INFO
+							<< info.UrlUtf8_
+							<< "matches"
+							<< *item;
+
+				if (!hostKey.Url_.isEmpty () && MatchesHostWide (item, hostKey.Url_, info.Domain_))
+					cache.SetHostMatched (hostKey);
+			}
+
+			cache.SetVerdict (key, static_cast<bool> (item));
+			return static_cast<bool> (item);
 		}
 	}
 
@@ -400,7 +387,8 @@ namespace CleanWeb
 		auto interceptor = [this] (const IInterceptableRequests::RequestInfo& info)
 				-> IInterceptableRequests::Result_t
 		{
-			if (!ShouldReject (info, ExceptionsCache_, FilterItemsCache_))
+			const auto matchers = std::atomic_load (&Matchers_);
+			if (!ShouldReject (info, matchers->Exceptions_, matchers->Filters_, matchers->Verdicts_))
 				return IInterceptableRequests::Allow {};
 
 			if (info.View_)
@@ -698,63 +686,42 @@ namespace CleanWeb
 
 	void Core::regenFilterCaches ()
 	{
-		ExceptionsCache_.clear ();
-		FilterItemsCache_.clear ();
-
 		auto allFilters = SubsModel_->GetAllFilters ();
 		allFilters << UserFilters_->GetFilter ();
 
-		int exceptionsCount = 0;
-		int filtersCount = 0;
-		for (const Filter& filter : allFilters)
-		{
-			exceptionsCount += filter.Exceptions_.size ();
-			filtersCount += filter.Filters_.size ();
-		}
-
-		auto idealThreads = std::max (QThread::idealThreadCount (), 2);
-
-		const int exChunkSize = std::max (exceptionsCount / idealThreads / 4, 200);
-		const int fChunkSize = std::max (filtersCount / idealThreads / 4, 200);
-		qDebug () << Q_FUNC_INFO << exceptionsCount << filtersCount << exChunkSize << fChunkSize;
-
-		QList<FilterItem_ptr> lastItemsChunk, lastExceptionsChunk;
-		lastItemsChunk.reserve (fChunkSize);
-		lastExceptionsChunk.reserve (exChunkSize);
-
+		QList<FilterItem_ptr> exceptions;
+		QList<FilterItem_ptr> filters;
 		for (const Filter& filter : allFilters)
 		{
 			for (const auto& item : filter.Exceptions_)
-			{
-				if (!item->Option_.HideSelector_.isEmpty ())
-					continue;
-
-				lastExceptionsChunk << item;
-				if (lastExceptionsChunk.size () >= exChunkSize)
-				{
-					ExceptionsCache_ << lastExceptionsChunk;
-					lastExceptionsChunk.clear ();
-				}
-			}
+				if (item->Option_.HideSelector_.isEmpty ())
+					exceptions << item;
 
 			for (const auto& item : filter.Filters_)
-			{
-				if (!item->Option_.HideSelector_.isEmpty ())
-					continue;
-
-				lastItemsChunk << item;
-				if (lastItemsChunk.size () >= fChunkSize)
-				{
-					FilterItemsCache_ << lastItemsChunk;
-					lastItemsChunk.clear ();
-				}
-			}
+				if (item->Option_.HideSelector_.isEmpty ())
+					filters << item;
 		}
 
-		if (!lastItemsChunk.isEmpty ())
-			FilterItemsCache_ << lastItemsChunk;
-		if (!lastExceptionsChunk.isEmpty ())
-			ExceptionsCache_ << lastExceptionsChunk;
+		QElapsedTimer timer;
+		timer.start ();
+
+		const auto newMatchers = std::make_shared<const Matchers> (FilterMatcher { exceptions }, FilterMatcher { filters });
+		const auto oldMatchers = std::atomic_exchange (&Matchers_, newMatchers);
+
+		qDebug () << Q_FUNC_INFO
+				<< "compiled"
+				<< exceptions.size ()
+				<< "exceptions and"
+				<< filters.size ()
+				<< "filters in"
+				<< timer.elapsed ()
+				<< "ms; previous verdict cache:"
+				<< oldMatchers->Verdicts_.GetStats ();
+	}
+
+	VerdictCache::Stats Core::GetVerdictCacheStats () const
+	{
+		return std::atomic_load (&Matchers_)->Verdicts_.GetStats ();
 	}
 }
 }
@@ -29,6 +29,7 @@
 
 #pragma once
 
+#include <memory>
 #include <QAbstractItemModel>
 #include <QHash>
 #include <QStringList>
@@ -39,7 +40,8 @@
 #include <interfaces/idownload.h>
 #include <interfaces/poshuku/poshukutypes.h>
 #include <interfaces/core/ihookproxy.h>
-#include "filter.h"
+#include "filtermatcher.h"
+#include "verdictcache.h"
 
 class QNetworkRequest;
 class QWebPage;
@@ -69,8 +71,22 @@ namespace CleanWeb
 		UserFiltersModel * const UserFilters_;
 		SubscriptionsModel * const SubsModel_;
 
-		QList<QList<FilterItem_ptr>> ExceptionsCache_;
-		QList<QList<FilterItem_ptr>> FilterItemsCache_;
+		struct Matchers
+		{
+			FilterMatcher Exceptions_;
+			FilterMatcher Filters_;
+
+			mutable VerdictCache Verdicts_;
+
+			Matchers () = default;
+
+			Matchers (FilterMatcher exceptions, FilterMatcher filters)
+			: Exceptions_ { std::move (exceptions) }
+			, Filters_ { std::move (filters) }
+			{
+			}
+		};
+		std::shared_ptr<const Matchers> Matchers_;
 
 		QHash<QObject*, QSet<QUrl>> MoreDelayedURLs_;
 
@@ -123,6 +139,11 @@ namespace CleanWeb
 		 * @return Whether addition was successful.
 		 */
 		bool Load (const QUrl& url, const QString& subscrName);
+
+		/** Returns the hit/miss statistics of the verdict cache for
+		 * the current set of filters.
+		 */
+		VerdictCache::Stats GetVerdictCacheStats () const;
 	private:
 		void Parse (const QString&);
 
@@ -0,0 +1,529 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#include "filtercache.h"
+#include <cstring>
+#include <type_traits>
+#include <vector>
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QtConcurrentMap>
+#include <QtDebug>
+#include <util/sys/paths.h>
+
+namespace LeechCraft
+{
+namespace Poshuku
+{
+namespace CleanWeb
+{
+namespace FilterCache
+{
+	namespace
+	{
+		/* The image consists of the following parts, each one
+		 * immediately following the previous one:
+		 *  - Header,
+		 *  - ItemRecord for each filter and then each exception,
+		 *  - StringRef for each (not-)domain, referred to by items,
+		 *  - the strings blob.
+		 *
+		 * Plain matchers are stored in UTF-8 with a terminating zero
+		 * (wildcard matching relies on it), everything else is stored
+		 * in UTF-16 so that QString::fromRawData() could be used.
+		 *
+		 * The image is only meant to be read by the same build on the
+		 * same machine, so native byte order and layout are used, and
+		 * the version should be bumped on any change to the layout or to
+		 * how LineParser interprets the rules.
+		 */
+		const quint32 ImageMagic = 0x4357494d;
+		const quint32 ImageVersion = 1;
+
+		struct StringRef
+		{
+			quint32 Offset_;
+			quint32 Length_;
+		};
+
+		struct Header
+		{
+			quint32 Magic_;
+			quint32 Version_;
+			quint32 HeaderSize_;
+			quint32 ItemRecordSize_;
+			quint32 FiltersCount_;
+			quint32 ExceptionsCount_;
+			quint32 DomainsCount_;
+			quint32 StringsSize_;
+		};
+
+		struct ItemRecord
+		{
+			StringRef Plain_;
+			StringRef Pattern_;
+			StringRef Selector_;
+			quint32 FirstDomain_;
+			quint16 DomainsCount_;
+			quint16 NotDomainsCount_;
+			quint16 MatchObjects_;
+			quint8 Case_;
+			quint8 MatchType_;
+			quint8 ThirdParty_;
+			quint8 PatternCase_;
+			quint8 Padding_ [2];
+		};
+
+		static_assert (std::is_trivially_copyable<Header> {} && sizeof (Header) % 4 == 0,
+				"Header should be a trivially copyable 4-byte-aligned structure");
+		static_assert (std::is_trivially_copyable<ItemRecord> {} && sizeof (ItemRecord) % 4 == 0,
+				"ItemRecord should be a trivially copyable 4-byte-aligned structure");
+
+		QDir GetCacheDir ()
+		{
+			return Util::GetUserDir (Util::UserDir::Cache, "poshuku/cleanweb");
+		}
+
+		QString GetImageName (const QString& filename, const QByteArray& key)
+		{
+			return filename + '.' + QString::fromLatin1 (key.toHex ());
+		}
+
+		/** Returns the subscription file name of the image called \em name,
+		 * or a null string if \em name isn't a name produced by
+		 * GetImageName(), like temporary files of QSaveFile.
+		 */
+		QString GetImageFilename (const QString& name)
+		{
+			const int keyHexLength = QCryptographicHash::hashLength (QCryptographicHash::Sha1) * 2;
+
+			const auto dotPos = name.lastIndexOf ('.');
+			if (dotPos <= 0 || name.size () - dotPos - 1 != keyHexLength)
+				return {};
+
+			for (int i = dotPos + 1; i < name.size (); ++i)
+			{
+				const auto ch = name.at (i);
+				if (!(ch >= '0' && ch <= '9') && !(ch >= 'a' && ch <= 'f'))
+					return {};
+			}
+
+			return name.left (dotPos);
+		}
+
+		class ImageWriter
+		{
+			QList<ItemRecord> Records_;
+			QList<StringRef> Domains_;
+			QByteArray Strings_;
+
+			QHash<QString, StringRef> Utf16Cache_;
+		public:
+			void Add (const FilterItem& item)
+			{
+				const auto& opt = item.Option_;
+
+				ItemRecord record {};
+				record.Plain_ = AddUtf8 (item.PlainMatcher_);
+				record.Pattern_ = AddUtf16 (item.RegExp_.GetPattern ());
+				record.PatternCase_ = item.RegExp_.GetCaseSensitivity ();
+				record.Selector_ = AddUtf16 (opt.HideSelector_);
+
+				record.FirstDomain_ = Domains_.size ();
+				record.DomainsCount_ = opt.Domains_.size ();
+				record.NotDomainsCount_ = opt.NotDomains_.size ();
+				for (const auto& domain : opt.Domains_ + opt.NotDomains_)
+					Domains_ << AddUtf16 (domain);
+
+				record.MatchObjects_ = opt.MatchObjects_;
+				record.Case_ = opt.Case_;
+				record.MatchType_ = static_cast<quint8> (opt.MatchType_);
+				record.ThirdParty_ = static_cast<quint8> (opt.ThirdParty_);
+
+				Records_ << record;
+			}
+
+			QByteArray Serialize (int filtersCount, int exceptionsCount) const
+			{
+				const Header header
+				{
+					ImageMagic,
+					ImageVersion,
+					sizeof (Header),
+					sizeof (ItemRecord),
+					static_cast<quint32> (filtersCount),
+					static_cast<quint32> (exceptionsCount),
+					static_cast<quint32> (Domains_.size ()),
+					static_cast<quint32> (Strings_.size ())
+				};
+
+				QByteArray result;
+				result.reserve (sizeof (Header) +
+						Records_.size () * sizeof (ItemRecord) +
+						Domains_.size () * sizeof (StringRef) +
+						Strings_.size ());
+
+				auto append = [&result] (const auto& pod)
+				{
+					result.append (reinterpret_cast<const char*> (&pod), sizeof (pod));
+				};
+				append (header);
+				for (const auto& record : Records_)
+					append (record);
+				for (const auto& domain : Domains_)
+					append (domain);
+				result += Strings_;
+
+				return result;
+			}
+		private:
+			StringRef AddUtf8 (const QByteArray& str)
+			{
+				if (str.isEmpty ())
+					return {};
+
+				const StringRef ref { static_cast<quint32> (Strings_.size ()), static_cast<quint32> (str.size ()) };
+				Strings_ += str;
+				Strings_ += '\0';
+				return ref;
+			}
+
+			StringRef AddUtf16 (const QString& str)
+			{
+				if (str.isEmpty ())
+					return {};
+
+				const auto pos = Utf16Cache_.constFind (str);
+				if (pos != Utf16Cache_.constEnd ())
+					return *pos;
+
+				if (Strings_.size () % sizeof (QChar))
+					Strings_ += '\0';
+
+				const StringRef ref { static_cast<quint32> (Strings_.size ()), static_cast<quint32> (str.size ()) };
+				Strings_.append (reinterpret_cast<const char*> (str.utf16 ()), str.size () * sizeof (QChar));
+				Utf16Cache_ [str] = ref;
+				return ref;
+			}
+		};
+
+		struct MappedImage
+		{
+			QFile File_;
+			std::vector<FilterItem> Items_;
+
+			MappedImage (const QString& path)
+			: File_ { path }
+			{
+			}
+		};
+
+		class ImageReader
+		{
+			const uchar * const Strings_;
+			const quint32 StringsSize_;
+		public:
+			ImageReader (const uchar *strings, quint32 size)
+			: Strings_ { strings }
+			, StringsSize_ { size }
+			{
+			}
+
+			bool IsValid (const StringRef& ref, int charSize) const
+			{
+				return ref.Offset_ % charSize == 0 &&
+						ref.Offset_ <= StringsSize_ &&
+						ref.Length_ <= (StringsSize_ - ref.Offset_) / charSize;
+			}
+
+			QByteArray GetUtf8 (const StringRef& ref) const
+			{
+				if (!ref.Length_)
+					return {};
+
+				return QByteArray::fromRawData (reinterpret_cast<const char*> (Strings_ + ref.Offset_), ref.Length_);
+			}
+
+			QString GetUtf16 (const StringRef& ref) const
+			{
+				if (!ref.Length_)
+					return {};
+
+				return QString::fromRawData (reinterpret_cast<const QChar*> (Strings_ + ref.Offset_), ref.Length_);
+			}
+
+			/* Strings that might be copied out of the filter items and
+			 * outlive them (like the selectors or the patterns, which are
+			 * stored inside the regexps) must not refer to the image.
+			 */
+			QString CopyUtf16 (const StringRef& ref) const
+			{
+				if (!ref.Length_)
+					return {};
+
+				return { reinterpret_cast<const QChar*> (Strings_ + ref.Offset_), static_cast<int> (ref.Length_) };
+			}
+		};
+	}
+
+	QByteArray GetKey (const QByteArray& contents)
+	{
+		QCryptographicHash hash { QCryptographicHash::Sha1 };
+		hash.addData (contents);
+		// LineParser drops some rules if the regexp engine is slow.
+		hash.addData (Util::RegExp::IsFast () ? "fast" : "slow");
+		return hash.result ();
+	}
+
+	std::optional<Filter> Load (const QString& filename, const QByteArray& key)
+	{
+		QString path;
+		try
+		{
+			path = GetCacheDir ().filePath (GetImageName (filename, key));
+		}
+		catch (const std::exception& e)
+		{
+			qWarning () << Q_FUNC_INFO
+					<< e.what ();
+			return {};
+		}
+
+		if (!QFile::exists (path))
+			return {};
+
+		const auto image = std::make_shared<MappedImage> (path);
+		auto& file = image->File_;
+		if (!file.open (QIODevice::ReadOnly))
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "unable to open"
+					<< path
+					<< file.errorString ();
+			return {};
+		}
+
+		const auto size = file.size ();
+		const auto data = size >= static_cast<qint64> (sizeof (Header)) ?
+				file.map (0, size) :
+				nullptr;
+		file.close ();
+		if (!data)
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "unable to map"
+					<< path
+					<< file.errorString ();
+			return {};
+		}
+
+		Header header;
+		std::memcpy (&header, data, sizeof (header));
+		if (header.Magic_ != ImageMagic ||
+				header.Version_ != ImageVersion ||
+				header.HeaderSize_ != sizeof (Header) ||
+				header.ItemRecordSize_ != sizeof (ItemRecord))
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "outdated or corrupted image"
+					<< path;
+			return {};
+		}
+
+		const quint64 itemsCount = static_cast<quint64> (header.FiltersCount_) + header.ExceptionsCount_;
+		const auto recordsOffset = sizeof (Header);
+		const auto domainsOffset = recordsOffset + itemsCount * sizeof (ItemRecord);
+		const auto stringsOffset = domainsOffset + header.DomainsCount_ * sizeof (StringRef);
+		if (stringsOffset + header.StringsSize_ != static_cast<quint64> (size))
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "image size mismatch"
+					<< path;
+			return {};
+		}
+
+		const auto records = reinterpret_cast<const ItemRecord*> (data + recordsOffset);
+		const auto domains = reinterpret_cast<const StringRef*> (data + domainsOffset);
+		const ImageReader reader { data + stringsOffset, header.StringsSize_ };
+
+		image->Items_.resize (itemsCount);
+
+		QList<FilterItem*> regexpItems;
+		for (quint64 i = 0; i < itemsCount; ++i)
+		{
+			const auto& record = records [i];
+			if (!reader.IsValid (record.Plain_, 1) ||
+					!reader.IsValid (record.Pattern_, sizeof (QChar)) ||
+					!reader.IsValid (record.Selector_, sizeof (QChar)) ||
+					record.FirstDomain_ > header.DomainsCount_ ||
+					record.DomainsCount_ + record.NotDomainsCount_ > header.DomainsCount_ - record.FirstDomain_)
+			{
+				qWarning () << Q_FUNC_INFO
+						<< "corrupted item"
+						<< i
+						<< "in"
+						<< path;
+				return {};
+			}
+
+			auto& item = image->Items_ [i];
+			item.PlainMatcher_ = reader.GetUtf8 (record.Plain_);
+
+			auto& opt = item.Option_;
+			opt.Case_ = static_cast<Qt::CaseSensitivity> (record.Case_);
+			opt.MatchType_ = static_cast<FilterOption::MatchType> (record.MatchType_);
+			opt.MatchObjects_ = FilterOption::MatchObjects (record.MatchObjects_);
+			opt.ThirdParty_ = static_cast<FilterOption::ThirdParty> (record.ThirdParty_);
+			opt.HideSelector_ = reader.CopyUtf16 (record.Selector_);
+
+			const auto addDomains = [&] (QStringList& list, quint32 first, quint32 count)
+			{
+				if (!count)
+					return true;
+
+				list.reserve (count);
+				for (auto d = first; d < first + count; ++d)
+				{
+					if (!reader.IsValid (domains [d], sizeof (QChar)))
+						return false;
+					list << reader.GetUtf16 (domains [d]);
+				}
+				return true;
+			};
+			if (!addDomains (opt.Domains_, record.FirstDomain_, record.DomainsCount_) ||
+					!addDomains (opt.NotDomains_, record.FirstDomain_ + record.DomainsCount_, record.NotDomainsCount_))
+			{
+				qWarning () << Q_FUNC_INFO
+						<< "corrupted domains of item"
+						<< i
+						<< "in"
+						<< path;
+				return {};
+			}
+
+			if (record.Pattern_.Length_)
+				regexpItems << &item;
+		}
+
+		// Compiled regexps can't be persisted, but they can at least be compiled in parallel.
+		QtConcurrent::blockingMap (regexpItems,
+				[&reader, records, base = image->Items_.data ()] (FilterItem *item)
+				{
+					const auto& record = records [item - base];
+					item->RegExp_ = Util::RegExp (reader.CopyUtf16 (record.Pattern_),
+							static_cast<Qt::CaseSensitivity> (record.PatternCase_));
+				});
+
+		Filter filter;
+		filter.SD_.Filename_ = filename;
+
+		const auto toPtr = [&image] (FilterItem& item) { return FilterItem_ptr { image, &item }; };
+
+		filter.Filters_.reserve (header.FiltersCount_);
+		for (quint32 i = 0; i < header.FiltersCount_; ++i)
+			filter.Filters_ << toPtr (image->Items_ [i]);
+
+		filter.Exceptions_.reserve (header.ExceptionsCount_);
+		for (quint64 i = header.FiltersCount_; i < itemsCount; ++i)
+			filter.Exceptions_ << toPtr (image->Items_ [i]);
+
+		return filter;
+	}
+
+	void Save (const QString& filename, const QByteArray& key, const Filter& filter)
+	{
+		QDir dir;
+		try
+		{
+			dir = GetCacheDir ();
+		}
+		catch (const std::exception& e)
+		{
+			qWarning () << Q_FUNC_INFO
+					<< e.what ();
+			return;
+		}
+
+		ImageWriter writer;
+		for (const auto& item : filter.Filters_)
+			writer.Add (*item);
+		for (const auto& item : filter.Exceptions_)
+			writer.Add (*item);
+
+		const auto& imageName = GetImageName (filename, key);
+
+		QSaveFile file { dir.filePath (imageName) };
+		if (!file.open (QIODevice::WriteOnly))
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "unable to open"
+					<< file.fileName ()
+					<< file.errorString ();
+			return;
+		}
+
+		file.write (writer.Serialize (filter.Filters_.size (), filter.Exceptions_.size ()));
+		if (!file.commit ())
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "unable to save"
+					<< file.fileName ()
+					<< file.errorString ();
+			return;
+		}
+
+		for (const auto& name : dir.entryList ({ filename + ".*" }, QDir::Files))
+			if (name != imageName && name.section ('.', 0, -2) == filename)
+				dir.remove (name);
+	}
+
+	void RemoveOrphans (const QStringList& filenames)
+	{
+		try
+		{
+			auto dir = GetCacheDir ();
+			for (const auto& name : dir.entryList (QDir::Files))
+			{
+				const auto& filename = GetImageFilename (name);
+				if (!filename.isNull () && !filenames.contains (filename))
+					dir.remove (name);
+			}
+		}
+		catch (const std::exception& e)
+		{
+			qWarning () << Q_FUNC_INFO
+					<< e.what ();
+		}
+	}
+}
+}
+}
+}
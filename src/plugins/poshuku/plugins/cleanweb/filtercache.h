@@ -0,0 +1,93 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#pragma once
+
+#include <optional>
+#include "filter.h"
+
+class QString;
+class QStringList;
+class QByteArray;
+
+namespace LeechCraft
+{
+namespace Poshuku
+{
+namespace CleanWeb
+{
+namespace FilterCache
+{
+	/** @brief Computes the cache key for the given subscription contents.
+	 *
+	 * @param[in] contents The raw contents of the subscription file.
+	 * @return The key to pass to Load() and Save().
+	 */
+	QByteArray GetKey (const QByteArray& contents);
+
+	/** @brief Loads the precompiled image of a subscription.
+	 *
+	 * The image is memory-mapped, and the filter items refer to the
+	 * mapped memory directly instead of copying the strings out of it.
+	 * All the items of the subscription share a single allocation
+	 * which also keeps the mapping alive.
+	 *
+	 * @param[in] filename The name of the subscription file.
+	 * @param[in] key The key of the subscription contents as returned
+	 * by GetKey().
+	 * @return The filter, or an empty optional if there is no valid
+	 * image for this key.
+	 */
+	std::optional<Filter> Load (const QString& filename, const QByteArray& key);
+
+	/** @brief Saves the precompiled image of a subscription.
+	 *
+	 * Any images of previous versions of the subscription are removed.
+	 *
+	 * @param[in] filename The name of the subscription file.
+	 * @param[in] key The key of the subscription contents as returned
+	 * by GetKey().
+	 * @param[in] filter The parsed filter to save.
+	 */
+	void Save (const QString& filename, const QByteArray& key, const Filter& filter);
+
+	/** @brief Removes images of subscriptions that don't exist anymore.
+	 *
+	 * Only files named like the images written by Save() are removed,
+	 * other files in the cache directory are kept. This function
+	 * should not be called concurrently with Save().
+	 *
+	 * @param[in] filenames The names of all existing subscription
+	 * files.
+	 */
+	void RemoveOrphans (const QStringList& filenames);
+}
+}
+}
+}
@@ -0,0 +1,515 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#include "filtermatcher.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <limits>
+#include <QVarLengthArray>
+#include <QtDebug>
+
+#if !defined (Q_OS_WIN32) && !defined (Q_OS_MAC)
+#include <fnmatch.h>
+#endif
+
+namespace LeechCraft
+{
+namespace Poshuku
+{
+namespace CleanWeb
+{
+	namespace
+	{
+#if defined (Q_OS_WIN32) || defined (Q_OS_MAC)
+		// Thanks for this goes to http://www.codeproject.com/KB/string/patmatch.aspx
+		bool WildcardMatches (const char *pattern, const char *str)
+		{
+			enum State {
+				Exact,        // exact match
+				Any,        // ?
+				AnyRepeat    // *
+			};
+
+			const char *s = str;
+			const char *p = pattern;
+			const char *q = 0;
+			int state = 0;
+
+			bool match = true;
+			while (match && *p) {
+				if (*p == '*') {
+					state = AnyRepeat;
+					q = p+1;
+				} else if (*p == '?') state = Any;
+				else state = Exact;
+
+				if (*s == 0) break;
+
+				switch (state) {
+					case Exact:
+						match = *s == *p;
+						s++;
+						p++;
+						break;
+
+					case Any:
+						match = true;
+						s++;
+						p++;
+						break;
+
+					case AnyRepeat:
+						match = true;
+						s++;
+
+						if (*s == *q) p++;
+						break;
+				}
+			}
+
+			if (state == AnyRepeat) return (*s == *q);
+			else if (state == Any) return (*s == *p);
+			else return match && (*s == *p);
+		}
+#else
+		bool WildcardMatches (const char *pat, const char *str)
+		{
+			return !fnmatch (pat, str, 0);
+		}
+#endif
+	}
+
+	bool Matches (const FilterItem_ptr& item,
+			const QByteArray& urlUtf8, const QString& domain)
+	{
+		const auto& opt = item->Option_;
+		if (opt.MatchObjects_ != FilterOption::MatchObject::All)
+		{
+			if (!(opt.MatchObjects_ & FilterOption::MatchObject::CSS) &&
+					!(opt.MatchObjects_ & FilterOption::MatchObject::Image) &&
+					!(opt.MatchObjects_ & FilterOption::MatchObject::Script) &&
+					!(opt.MatchObjects_ & FilterOption::MatchObject::Object) &&
+					!(opt.MatchObjects_ & FilterOption::MatchObject::ObjSubrequest))
+				return false;
+		}
+
+		if (std::any_of (opt.NotDomains_.begin (), opt.NotDomains_.end (),
+					[&domain, &opt] (const QString& notDomain)
+						{ return domain.endsWith (notDomain, opt.Case_); }))
+			return false;
+
+		if (!opt.Domains_.isEmpty () &&
+				std::none_of (opt.Domains_.begin (), opt.Domains_.end (),
+						[&domain, &opt] (const QString& doDomain)
+							{ return domain.endsWith (doDomain, opt.Case_); }))
+			return false;
+
+		switch (opt.MatchType_)
+		{
+		case FilterOption::MatchType::Regexp:
+			return item->RegExp_.Matches (urlUtf8);
+		case FilterOption::MatchType::Wildcard:
+			return WildcardMatches (item->PlainMatcher_.constData (), urlUtf8.constData ());
+		case FilterOption::MatchType::Plain:
+			return urlUtf8.indexOf (item->PlainMatcher_) >= 0;
+		case FilterOption::MatchType::Begin:
+			return urlUtf8.startsWith (item->PlainMatcher_);
+		case FilterOption::MatchType::End:
+			return urlUtf8.endsWith (item->PlainMatcher_);
+		}
+
+		return false;
+	}
+
+	namespace
+	{
+		const int KeyLength = sizeof (quint32);
+
+		quint32 ReadKey (const char *data)
+		{
+			quint32 key;
+			std::memcpy (&key, data, KeyLength);
+			return key;
+		}
+
+		bool IsAsciiLiteral (char c)
+		{
+			return c > ' ' && static_cast<unsigned char> (c) < 0x80;
+		}
+
+		/* Collects the literal strings that must occur verbatim in any
+		 * string matching the given fnmatch()-style pattern.
+		 */
+		QList<QByteArray> GetWildcardLiterals (const QByteArray& pattern)
+		{
+			QList<QByteArray> result;
+
+			QByteArray current;
+			auto flush = [&result, &current]
+			{
+				if (current.size () >= KeyLength)
+					result << current;
+				current.clear ();
+			};
+
+			for (int i = 0; i < pattern.size (); ++i)
+			{
+				const auto c = pattern.at (i);
+				switch (c)
+				{
+				case '*':
+				case '?':
+					flush ();
+					break;
+				case '[':
+					flush ();
+					i = pattern.indexOf (']', i + 2);
+					if (i == -1)
+						return result;
+					break;
+				case '\\':
+					if (i + 1 < pattern.size () && IsAsciiLiteral (pattern.at (i + 1)))
+						current += pattern.at (++i);
+					else
+						flush ();
+					break;
+				default:
+					if (IsAsciiLiteral (c))
+						current += c;
+					else
+						flush ();
+					break;
+				}
+			}
+			flush ();
+
+			return result;
+		}
+
+		int SkipCharClass (const QByteArray& pattern, int pos)
+		{
+			++pos;
+			if (pos < pattern.size () && pattern.at (pos) == '^')
+				++pos;
+			if (pos < pattern.size () && pattern.at (pos) == ']')
+				++pos;
+
+			for (; pos < pattern.size (); ++pos)
+				switch (pattern.at (pos))
+				{
+				case '\\':
+					++pos;
+					break;
+				case ']':
+					return pos;
+				}
+
+			return -1;
+		}
+
+		/* Collects the literal strings that must occur verbatim in any
+		 * string matching the given regular expression.
+		 *
+		 * This is deliberately conservative: alternations and groups
+		 * are not analyzed at all, and anything that is not a plain
+		 * character just terminates the current literal.
+		 */
+		QList<QByteArray> GetRegexpLiterals (const QByteArray& pattern)
+		{
+			if (pattern.contains ('|') || pattern.contains ('('))
+				return {};
+
+			QList<QByteArray> result;
+
+			QByteArray current;
+			auto flush = [&result, &current]
+			{
+				if (current.size () >= KeyLength)
+					result << current;
+				current.clear ();
+			};
+
+			for (int i = 0; i < pattern.size (); ++i)
+			{
+				const auto c = pattern.at (i);
+				switch (c)
+				{
+				case '*':
+				case '?':
+				case '{':
+					// The previous atom is optional, so it can't be a part of a literal.
+					if (!current.isEmpty ())
+						current.chop (1);
+					flush ();
+					if (c == '{')
+					{
+						i = pattern.indexOf ('}', i);
+						if (i == -1)
+							return result;
+					}
+					break;
+				case '+':
+					flush ();
+					break;
+				case '[':
+					flush ();
+					i = SkipCharClass (pattern, i);
+					if (i == -1)
+						return result;
+					break;
+				case '\\':
+				{
+					if (i + 1 >= pattern.size ())
+						return result;
+
+					const auto next = pattern.at (++i);
+					if (!std::isalnum (static_cast<unsigned char> (next)) && IsAsciiLiteral (next))
+						current += next;
+					else if (QByteArray { "dDwWsSbB" }.contains (next))
+						flush ();
+					else
+						// Hex, octal, unicode escapes and such — better safe than sorry.
+						return {};
+					break;
+				}
+				case '.':
+				case '^':
+				case '$':
+					flush ();
+					break;
+				default:
+					if (IsAsciiLiteral (c))
+						current += c;
+					else
+						flush ();
+					break;
+				}
+			}
+			flush ();
+
+			return result;
+		}
+
+		QList<QByteArray> GetLiterals (const FilterItem& item)
+		{
+			switch (item.Option_.MatchType_)
+			{
+			case FilterOption::MatchType::Plain:
+			case FilterOption::MatchType::Begin:
+			case FilterOption::MatchType::End:
+				return { item.PlainMatcher_ };
+			case FilterOption::MatchType::Wildcard:
+				return GetWildcardLiterals (item.PlainMatcher_);
+			case FilterOption::MatchType::Regexp:
+			{
+				auto literals = GetRegexpLiterals (item.RegExp_.GetPattern ().toUtf8 ());
+				if (item.Option_.Case_ == Qt::CaseInsensitive)
+					for (auto& literal : literals)
+						literal = literal.toLower ();
+				return literals;
+			}
+			}
+
+			return {};
+		}
+
+		QVector<quint32> GetKeys (const FilterItem& item)
+		{
+			QVector<quint32> keys;
+			for (const auto& literal : GetLiterals (item))
+				for (int i = 0; i <= literal.size () - KeyLength; ++i)
+					keys << ReadKey (literal.constData () + i);
+
+			std::sort (keys.begin (), keys.end ());
+			keys.erase (std::unique (keys.begin (), keys.end ()), keys.end ());
+			return keys;
+		}
+
+		/* These occur in almost every URL, so indexing by them would
+		 * bring nearly no benefit.
+		 */
+		bool IsCommonKey (quint32 key)
+		{
+			static const auto commonKeys = []
+			{
+				QVector<quint32> keys;
+				for (const auto str : { "http", "ttp:", "tps:", "tp:/", "ps:/", "p://", "s://",
+							"://w", "//ww", "/www", "www.", ".com", "com/", ".net", ".org",
+							".htm", "html", ".php" })
+					keys << ReadKey (str);
+				std::sort (keys.begin (), keys.end ());
+				return keys;
+			} ();
+			return std::binary_search (commonKeys.begin (), commonKeys.end (), key);
+		}
+	}
+
+	FilterMatcher::FilterMatcher (const QList<FilterItem_ptr>& items)
+	{
+		Items_.reserve (items.size ());
+
+		QVector<QVector<quint32>> itemsKeys;
+		itemsKeys.reserve (items.size ());
+
+		QHash<quint32, int> keyFrequencies;
+		for (const auto& item : items)
+		{
+			const auto& keys = GetKeys (*item);
+			for (const auto key : keys)
+				++keyFrequencies [key];
+
+			Items_ << item;
+			itemsKeys << keys;
+		}
+
+		for (int i = 0; i < Items_.size (); ++i)
+		{
+			const auto& opt = Items_.at (i)->Option_;
+			const auto& keys = itemsKeys.at (i);
+			if (keys.isEmpty ())
+			{
+				switch (opt.MatchType_)
+				{
+				case FilterOption::MatchType::Begin:
+				case FilterOption::MatchType::End:
+					Anchored_ << i;
+					break;
+				case FilterOption::MatchType::Regexp:
+					Regexps_ << i;
+					break;
+				case FilterOption::MatchType::Plain:
+				case FilterOption::MatchType::Wildcard:
+					Generic_ << i;
+					break;
+				}
+				continue;
+			}
+
+			auto weight = [&keyFrequencies] (quint32 key)
+			{
+				return IsCommonKey (key) ?
+						std::numeric_limits<int>::max () :
+						keyFrequencies.value (key);
+			};
+			const auto bestKey = *std::min_element (keys.begin (), keys.end (),
+					[&weight] (quint32 left, quint32 right) { return weight (left) < weight (right); });
+
+			auto& index = opt.Case_ == Qt::CaseSensitive ? CSIndex_ : CIIndex_;
+			index [bestKey] << i;
+		}
+
+		qDebug () << Q_FUNC_INFO
+				<< "compiled"
+				<< Items_.size ()
+				<< "items into"
+				<< CSIndex_.size () + CIIndex_.size ()
+				<< "buckets;"
+				<< GetUnindexedCount ()
+				<< "items left unindexed";
+	}
+
+	FilterItem_ptr FilterMatcher::Match (const RequestMatchInfo& info) const
+	{
+		FilterItem_ptr result;
+		if (MatchesIndex (CIIndex_, info.CinUrlUtf8_, info, result) ||
+				MatchesIndex (CSIndex_, info.UrlUtf8_, info, result) ||
+				MatchesList (Anchored_, info, result) ||
+				MatchesList (Generic_, info, result) ||
+				MatchesList (Regexps_, info, result))
+			return result;
+
+		return {};
+	}
+
+	int FilterMatcher::GetSize () const
+	{
+		return Items_.size ();
+	}
+
+	int FilterMatcher::GetUnindexedCount () const
+	{
+		return Anchored_.size () + Regexps_.size () + Generic_.size ();
+	}
+
+	bool FilterMatcher::MatchesIndex (const QHash<quint32, QVector<int>>& index,
+			const QByteArray& url, const RequestMatchInfo& info, FilterItem_ptr& result) const
+	{
+		if (index.isEmpty () || url.size () < KeyLength)
+			return false;
+
+		QVarLengthArray<quint32, 512> keys;
+		keys.reserve (url.size () - KeyLength + 1);
+		for (int i = 0; i <= url.size () - KeyLength; ++i)
+			keys.append (ReadKey (url.constData () + i));
+
+		std::sort (keys.begin (), keys.end ());
+		const auto keysEnd = std::unique (keys.begin (), keys.end ());
+
+		for (auto key = keys.begin (); key != keysEnd; ++key)
+		{
+			const auto pos = index.constFind (*key);
+			if (pos != index.constEnd () && MatchesList (*pos, info, result))
+				return true;
+		}
+
+		return false;
+	}
+
+	bool FilterMatcher::MatchesList (const QVector<int>& indexes,
+			const RequestMatchInfo& info, FilterItem_ptr& result) const
+	{
+		for (const auto idx : indexes)
+			if (MatchesItem (idx, info))
+			{
+				result = Items_.at (idx);
+				return true;
+			}
+
+		return false;
+	}
+
+	bool FilterMatcher::MatchesItem (int idx, const RequestMatchInfo& info) const
+	{
+		const auto& item = Items_.at (idx);
+		const auto& opt = item->Option_;
+		if (opt.ThirdParty_ != FilterOption::ThirdParty::Unspecified &&
+				(opt.ThirdParty_ == FilterOption::ThirdParty::Yes) != info.IsThirdParty_)
+			return false;
+
+		if (opt.MatchObjects_ != FilterOption::MatchObject::All &&
+				!(info.Objects_ & opt.MatchObjects_))
+			return false;
+
+		const auto& utf8 = opt.Case_ == Qt::CaseSensitive ? info.UrlUtf8_ : info.CinUrlUtf8_;
+		return Matches (item, utf8, info.Domain_);
+	}
+}
+}
+}
@@ -0,0 +1,93 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#pragma once
+
+#include <QHash>
+#include <QVector>
+#include "filter.h"
+
+namespace LeechCraft
+{
+namespace Poshuku
+{
+namespace CleanWeb
+{
+	bool Matches (const FilterItem_ptr& item, const QByteArray& urlUtf8, const QString& domain);
+
+	struct RequestMatchInfo
+	{
+		QByteArray UrlUtf8_;
+		QByteArray CinUrlUtf8_;
+		QString Domain_;
+		bool IsThirdParty_;
+		FilterOption::MatchObjects Objects_;
+	};
+
+	/** @brief A compiled set of filter items optimized for matching.
+	 *
+	 * Each item is indexed by a rare fixed-length substring that is
+	 * guaranteed to be present in any URL the item matches, so that a
+	 * lookup only checks the items whose key occurs in the URL being
+	 * checked. Items without such substrings are kept in separate
+	 * fallback buckets: the cheap anchored (begin/end) ones, the
+	 * regexp ones and the rest.
+	 */
+	class FilterMatcher
+	{
+		QVector<FilterItem_ptr> Items_;
+
+		QHash<quint32, QVector<int>> CSIndex_;
+		QHash<quint32, QVector<int>> CIIndex_;
+
+		QVector<int> Anchored_;
+		QVector<int> Regexps_;
+		QVector<int> Generic_;
+	public:
+		FilterMatcher () = default;
+		explicit FilterMatcher (const QList<FilterItem_ptr>&);
+
+		/** @brief Returns the first item matching the given request.
+		 *
+		 * @param[in] info The request to check.
+		 * @return The matching item or a null pointer if there is none.
+		 */
+		FilterItem_ptr Match (const RequestMatchInfo& info) const;
+
+		int GetSize () const;
+		int GetUnindexedCount () const;
+	private:
+		bool MatchesIndex (const QHash<quint32, QVector<int>>&, const QByteArray&,
+				const RequestMatchInfo&, FilterItem_ptr&) const;
+		bool MatchesList (const QVector<int>&, const RequestMatchInfo&, FilterItem_ptr&) const;
+		bool MatchesItem (int, const RequestMatchInfo&) const;
+	};
+}
+}
+}
@@ -0,0 +1,114 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#include "verdictcache.h"
+#include <QtDebug>
+
+namespace LeechCraft
+{
+namespace Poshuku
+{
+namespace CleanWeb
+{
+	VerdictCache::VerdictCache (int capacity)
+	: UrlVerdicts_ { capacity }
+	, HostMatches_ { capacity / 4 }
+	{
+	}
+
+	std::optional<bool> VerdictCache::GetVerdict (const Key& key)
+	{
+		QMutexLocker locker { &Mutex_ };
+		if (const auto verdict = UrlVerdicts_.object (key))
+		{
+			++Stats_.UrlHits_;
+			return *verdict;
+		}
+
+		++Stats_.Misses_;
+		return {};
+	}
+
+	void VerdictCache::SetVerdict (const Key& key, bool verdict)
+	{
+		QMutexLocker locker { &Mutex_ };
+		UrlVerdicts_.insert (key, new bool { verdict });
+	}
+
+	bool VerdictCache::IsHostMatched (const Key& key)
+	{
+		QMutexLocker locker { &Mutex_ };
+		if (!HostMatches_.contains (key))
+			return false;
+
+		++Stats_.HostHits_;
+		return true;
+	}
+
+	void VerdictCache::SetHostMatched (const Key& key)
+	{
+		QMutexLocker locker { &Mutex_ };
+		HostMatches_.insert (key, new bool { true });
+	}
+
+	VerdictCache::Stats VerdictCache::GetStats () const
+	{
+		QMutexLocker locker { &Mutex_ };
+		auto stats = Stats_;
+		stats.UrlEntries_ = UrlVerdicts_.size ();
+		stats.HostEntries_ = HostMatches_.size ();
+		return stats;
+	}
+
+	bool operator== (const VerdictCache::Key& left, const VerdictCache::Key& right)
+	{
+		return left.ResourceType_ == right.ResourceType_ &&
+				left.Url_ == right.Url_ &&
+				left.PageHost_ == right.PageHost_;
+	}
+
+	uint qHash (const VerdictCache::Key& key)
+	{
+		return qHash (key.Url_) ^ qHash (key.PageHost_) ^ static_cast<uint> (key.ResourceType_);
+	}
+
+	QDebug operator<< (QDebug dbg, const VerdictCache::Stats& stats)
+	{
+		QDebugStateSaver saver { dbg };
+		dbg.nospace () << "VerdictCache::Stats { "
+				<< "URL hits: " << stats.UrlHits_ << "; "
+				<< "host hits: " << stats.HostHits_ << "; "
+				<< "misses: " << stats.Misses_ << "; "
+				<< "entries: " << stats.UrlEntries_ << " URLs, " << stats.HostEntries_ << " hosts"
+				<< " }";
+		return dbg;
+	}
+}
+}
+}
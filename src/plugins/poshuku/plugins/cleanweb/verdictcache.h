@@ -0,0 +1,99 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#pragma once
+
+#include <optional>
+#include <QCache>
+#include <QMutex>
+#include <QString>
+
+namespace LeechCraft
+{
+namespace Poshuku
+{
+namespace CleanWeb
+{
+	/** @brief A bounded thread-safe cache of the filtering verdicts.
+	 *
+	 * Two kinds of verdicts are cached: the exact ones for the full
+	 * request URLs, and the host-wide ones that are recorded when a
+	 * filter matches regardless of the path, so that any other URL on
+	 * the same host is known to match the filters as well.
+	 *
+	 * The cache is tied to a specific set of compiled filters and is to
+	 * be dropped together with it.
+	 */
+	class VerdictCache
+	{
+	public:
+		struct Key
+		{
+			/** Either the full request URL or, for the host-wide
+			 * verdicts, its part up to the path.
+			 */
+			QString Url_;
+			QString PageHost_;
+			int ResourceType_;
+		};
+
+		struct Stats
+		{
+			quint64 UrlHits_ = 0;
+			quint64 HostHits_ = 0;
+			quint64 Misses_ = 0;
+			int UrlEntries_ = 0;
+			int HostEntries_ = 0;
+		};
+	private:
+		mutable QMutex Mutex_;
+
+		QCache<Key, bool> UrlVerdicts_;
+		QCache<Key, bool> HostMatches_;
+
+		Stats Stats_;
+	public:
+		explicit VerdictCache (int capacity = 16384);
+
+		std::optional<bool> GetVerdict (const Key&);
+		void SetVerdict (const Key&, bool);
+
+		bool IsHostMatched (const Key&);
+		void SetHostMatched (const Key&);
+
+		Stats GetStats () const;
+	};
+
+	bool operator== (const VerdictCache::Key&, const VerdictCache::Key&);
+	uint qHash (const VerdictCache::Key&);
+
+	QDebug operator<< (QDebug, const VerdictCache::Stats&);
+}
+}
+}
@@ -76,17 +76,21 @@ namespace DCAC
 			return Clamp (138.52 * std::log (temperature - 10) - 305.0);
 		}
 
-		/** http://www.tannerhelland.com/4435/convert-temperature-rgb-algorithm-code/ is used.
-		 *
-		 * Even though http://www.vendian.org/mncharity/dir3/blackbody/UnstableURLs/bbr_color.html
-		 * for instance.
-		 */
-		QRgb Temp2Rgb (double temperature)
-		{
-			temperature /= 100;
-			return qRgb (Temp2Red (temperature), Temp2Green (temperature), Temp2Blue (temperature));
-		}
+	}
+
+	/** http://www.tannerhelland.com/4435/convert-temperature-rgb-algorithm-code/ is used.
+	 *
+	 * Even though http://www.vendian.org/mncharity/dir3/blackbody/UnstableURLs/bbr_color.html
+	 * for instance.
+	 */
+	QRgb Temp2Rgb (double temperature)
+	{
+		temperature /= 100;
+		return qRgb (Temp2Red (temperature), Temp2Green (temperature), Temp2Blue (temperature));
+	}
 
+	namespace
+	{
 		void AdjustColorTempInner (unsigned char* pixel, float red, float green, float blue)
 		{
 #if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
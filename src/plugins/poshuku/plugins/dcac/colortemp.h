@@ -29,6 +29,8 @@
 
 #pragma once
 
+#include <QRgb>
+
 class QImage;
 
 namespace LeechCraft
@@ -37,6 +39,8 @@ namespace Poshuku
 {
 namespace DCAC
 {
+	QRgb Temp2Rgb (double temperature);
+
 	void AdjustColorTemp (QImage& image, int temperature);
 }
 }
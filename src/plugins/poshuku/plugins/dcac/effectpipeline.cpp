@@ -0,0 +1,529 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#include "effectpipeline.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numeric>
+#include <QImage>
+#include <QThread>
+#include <QtConcurrentMap>
+#include <util/sys/cpufeatures.h>
+#include <util/sll/visitor.h>
+#include "invertcolors.h"
+#include "colortemp.h"
+#include "effectscommon.h"
+
+#ifdef SSE_ENABLED
+#include "ssecommon.h"
+#endif
+
+namespace LeechCraft
+{
+namespace Poshuku
+{
+namespace DCAC
+{
+	namespace
+	{
+		PixelTransform MakeUniform (double mult, double add)
+		{
+			return { { mult, add }, { mult, add }, { mult, add } };
+		}
+
+		/* The fixed-point form of a ChannelTransform that is actually
+		 * applied by the kernels: c' = clamp ((Mult_ * c + 256 * Add_) >> 8).
+		 *
+		 * It maps directly onto a single _mm_madd_epi16 over the (c, 256)
+		 * and (Mult_, Add_) pairs.
+		 */
+		struct FixedChannel
+		{
+			int16_t Mult_;
+			int16_t Add_;
+		};
+
+		struct FixedTransform
+		{
+			FixedChannel Red_;
+			FixedChannel Green_;
+			FixedChannel Blue_;
+		};
+
+		int16_t ToInt16 (double value)
+		{
+			return static_cast<int16_t> (std::max (std::min (std::round (value), 32767.), -32768.));
+		}
+
+		FixedChannel ToFixed (const ChannelTransform& ch)
+		{
+			return { ToInt16 (ch.Mult_ * 256), ToInt16 (ch.Add_) };
+		}
+
+		FixedTransform ToFixed (const PixelTransform& t)
+		{
+			return { ToFixed (t.Red_), ToFixed (t.Green_), ToFixed (t.Blue_) };
+		}
+
+		int ApplyFixed (int c, FixedChannel ch)
+		{
+			return std::max (std::min ((c * ch.Mult_ + 256 * ch.Add_) >> 8, 255), 0);
+		}
+
+		QRgb ApplyFixed (QRgb color, const FixedTransform& t)
+		{
+			return qRgba (ApplyFixed (qRed (color), t.Red_),
+					ApplyFixed (qGreen (color), t.Green_),
+					ApplyFixed (qBlue (color), t.Blue_),
+					qAlpha (color));
+		}
+
+		void ApplyTransformDefault (QImage& image, const FixedTransform& t)
+		{
+			const auto height = image.height ();
+			const auto width = image.width ();
+
+			for (int y = 0; y < height; ++y)
+			{
+				const auto scanline = reinterpret_cast<QRgb*> (image.scanLine (y));
+				for (int x = 0; x < width; ++x)
+					scanline [x] = ApplyFixed (scanline [x], t);
+			}
+		}
+
+#ifdef SSE_ENABLED
+		__attribute__ ((target ("sse2")))
+		__m128i MakeCoeffs128 (const FixedTransform& t)
+		{
+			return _mm_setr_epi16 (t.Blue_.Mult_, t.Blue_.Add_,
+					t.Green_.Mult_, t.Green_.Add_,
+					t.Red_.Mult_, t.Red_.Add_,
+					256, 0);
+		}
+
+		__attribute__ ((target ("ssse3")))
+		void ApplyTransformSSSE3 (QImage& image, const FixedTransform& t)
+		{
+			constexpr auto alignment = 16;
+
+			const auto height = image.height ();
+			const auto width = image.width ();
+
+			const __m128i zero = _mm_setzero_si128 ();
+			const __m128i unit = _mm_set1_epi16 (256);
+			const __m128i coeffs = MakeCoeffs128 (t);
+
+			for (int y = 0; y < height; ++y)
+			{
+				uchar * const scanline = image.scanLine (y);
+
+				auto handler = [scanline, &t] (int i)
+				{
+					auto& color = *reinterpret_cast<QRgb*> (&scanline [i]);
+					color = ApplyFixed (color, t);
+				};
+
+				if (width * 4 < alignment * 2)
+				{
+					HandleLoopEnd (width, 0, handler);
+					continue;
+				}
+
+				int x = 0;
+				int bytesCount = 0;
+				HandleLoopBegin<alignment> (scanline, width, x, bytesCount, handler);
+
+				for (; x < bytesCount; x += alignment)
+				{
+					const __m128i pixels = _mm_load_si128 (reinterpret_cast<const __m128i*> (scanline + x));
+
+					const __m128i pair1 = _mm_unpacklo_epi8 (pixels, zero);
+					const __m128i pair2 = _mm_unpackhi_epi8 (pixels, zero);
+
+					__m128i p1 = _mm_madd_epi16 (_mm_unpacklo_epi16 (pair1, unit), coeffs);
+					__m128i p2 = _mm_madd_epi16 (_mm_unpackhi_epi16 (pair1, unit), coeffs);
+					__m128i p3 = _mm_madd_epi16 (_mm_unpacklo_epi16 (pair2, unit), coeffs);
+					__m128i p4 = _mm_madd_epi16 (_mm_unpackhi_epi16 (pair2, unit), coeffs);
+
+					p1 = _mm_srai_epi32 (p1, 8);
+					p2 = _mm_srai_epi32 (p2, 8);
+					p3 = _mm_srai_epi32 (p3, 8);
+					p4 = _mm_srai_epi32 (p4, 8);
+
+					const __m128i result = _mm_packus_epi16 (_mm_packs_epi32 (p1, p2), _mm_packs_epi32 (p3, p4));
+					_mm_store_si128 (reinterpret_cast<__m128i*> (scanline + x), result);
+				}
+
+				HandleLoopEnd (width, x, handler);
+			}
+		}
+
+		__attribute__ ((target ("avx2")))
+		void ApplyTransformAVX2 (QImage& image, const FixedTransform& t)
+		{
+			constexpr auto alignment = 32;
+
+			const auto height = image.height ();
+			const auto width = image.width ();
+
+			const __m256i zero = _mm256_setzero_si256 ();
+			const __m256i unit = _mm256_set1_epi16 (256);
+			const __m256i coeffs = _mm256_broadcastsi128_si256 (MakeCoeffs128 (t));
+
+			for (int y = 0; y < height; ++y)
+			{
+				uchar * const scanline = image.scanLine (y);
+
+				auto handler = [scanline, &t] (int i)
+				{
+					auto& color = *reinterpret_cast<QRgb*> (&scanline [i]);
+					color = ApplyFixed (color, t);
+				};
+
+				if (width * 4 < alignment * 2)
+				{
+					HandleLoopEnd (width, 0, handler);
+					continue;
+				}
+
+				int x = 0;
+				int bytesCount = 0;
+				HandleLoopBegin<alignment> (scanline, width, x, bytesCount, handler);
+
+				for (; x < bytesCount; x += alignment)
+				{
+					const __m256i pixels = _mm256_load_si256 (reinterpret_cast<const __m256i*> (scanline + x));
+
+					const __m256i pair1 = _mm256_unpacklo_epi8 (pixels, zero);
+					const __m256i pair2 = _mm256_unpackhi_epi8 (pixels, zero);
+
+					__m256i p1 = _mm256_madd_epi16 (_mm256_unpacklo_epi16 (pair1, unit), coeffs);
+					__m256i p2 = _mm256_madd_epi16 (_mm256_unpackhi_epi16 (pair1, unit), coeffs);
+					__m256i p3 = _mm256_madd_epi16 (_mm256_unpacklo_epi16 (pair2, unit), coeffs);
+					__m256i p4 = _mm256_madd_epi16 (_mm256_unpackhi_epi16 (pair2, unit), coeffs);
+
+					p1 = _mm256_srai_epi32 (p1, 8);
+					p2 = _mm256_srai_epi32 (p2, 8);
+					p3 = _mm256_srai_epi32 (p3, 8);
+					p4 = _mm256_srai_epi32 (p4, 8);
+
+					const __m256i result = _mm256_packus_epi16 (_mm256_packs_epi32 (p1, p2), _mm256_packs_epi32 (p3, p4));
+					_mm256_store_si256 (reinterpret_cast<__m256i*> (scanline + x), result);
+				}
+
+				HandleLoopEnd (width, x, handler);
+			}
+		}
+#endif
+
+		void ApplyFixedTransform (QImage& image, const FixedTransform& t)
+		{
+#ifdef SSE_ENABLED
+			static const auto ptr = Util::CpuFeatures::Choose ({
+						{ Util::CpuFeatures::Feature::AVX2, &ApplyTransformAVX2 },
+						{ Util::CpuFeatures::Feature::SSSE3, &ApplyTransformSSSE3 }
+					},
+					&ApplyTransformDefault);
+
+			ptr (image, t);
+#else
+			ApplyTransformDefault (image, t);
+#endif
+		}
+
+		/* Images smaller than this are not worth distributing over
+		 * the thread pool.
+		 */
+		const int MinParallelPixels = 256 * 1024;
+
+		const int MinTileRows = 16;
+
+		int GetTileRows (const QImage& image)
+		{
+			const auto height = image.height ();
+			if (image.width () * height < MinParallelPixels)
+				return std::max (height, 1);
+
+			const auto tilesCount = QThread::idealThreadCount () * 4;
+			return std::max ((height + tilesCount - 1) / tilesCount, MinTileRows);
+		}
+
+		/* Splits the image into tiles of full rows. The tiles share the
+		 * memory of the image, so modifying them modifies the image.
+		 */
+		template<typename Bits>
+		QVector<QImage> SplitRows (const QImage& image, Bits bits)
+		{
+			const auto height = image.height ();
+			const auto width = image.width ();
+			const auto bpl = image.bytesPerLine ();
+			const auto tileRows = GetTileRows (image);
+
+			QVector<QImage> tiles;
+			tiles.reserve ((height + tileRows - 1) / tileRows);
+			for (int row = 0; row < height; row += tileRows)
+				tiles.push_back (QImage { bits + row * bpl, width, std::min (tileRows, height - row), bpl, image.format () });
+			return tiles;
+		}
+
+		uint64_t GetGrayParallel (const QImage& image)
+		{
+			const auto& tiles = SplitRows (image, image.constBits ());
+			if (tiles.size () == 1)
+				return GetGray (tiles.front ());
+
+			QVector<uint64_t> grays (tiles.size ());
+			QVector<int> indexes (tiles.size ());
+			std::iota (indexes.begin (), indexes.end (), 0);
+			QtConcurrent::blockingMap (indexes,
+					[&tiles, &grays] (int idx) { grays [idx] = GetGray (tiles [idx]); });
+
+			return std::accumulate (grays.begin (), grays.end (), uint64_t { 0 });
+		}
+
+		/* The number of pixels having each value of each color component.
+		 *
+		 * Since the transformations are per-channel, this is enough to
+		 * compute the gray level of the image with any transformation
+		 * applied, without transforming the image itself.
+		 */
+		struct ChannelHistograms
+		{
+			std::array<uint64_t, 256> Red_ {};
+			std::array<uint64_t, 256> Green_ {};
+			std::array<uint64_t, 256> Blue_ {};
+
+			ChannelHistograms& operator+= (const ChannelHistograms& other)
+			{
+				for (int i = 0; i < 256; ++i)
+				{
+					Red_ [i] += other.Red_ [i];
+					Green_ [i] += other.Green_ [i];
+					Blue_ [i] += other.Blue_ [i];
+				}
+				return *this;
+			}
+		};
+
+		ChannelHistograms GetHistograms (const QImage& image)
+		{
+			ChannelHistograms result;
+
+			const auto height = image.height ();
+			const auto width = image.width ();
+
+			for (int y = 0; y < height; ++y)
+			{
+				const auto scanline = reinterpret_cast<const QRgb*> (image.constScanLine (y));
+				for (int x = 0; x < width; ++x)
+				{
+					const auto color = scanline [x];
+					++result.Red_ [qRed (color)];
+					++result.Green_ [qGreen (color)];
+					++result.Blue_ [qBlue (color)];
+				}
+			}
+
+			return result;
+		}
+
+		ChannelHistograms GetHistogramsParallel (const QImage& image)
+		{
+			const auto& tiles = SplitRows (image, image.constBits ());
+			if (tiles.size () == 1)
+				return GetHistograms (tiles.front ());
+
+			QVector<ChannelHistograms> histograms (tiles.size ());
+			QVector<int> indexes (tiles.size ());
+			std::iota (indexes.begin (), indexes.end (), 0);
+			QtConcurrent::blockingMap (indexes,
+					[&tiles, &histograms] (int idx) { histograms [idx] = GetHistograms (tiles [idx]); });
+
+			return std::accumulate (histograms.begin (), histograms.end (), ChannelHistograms {},
+					[] (ChannelHistograms acc, const ChannelHistograms& h) { return acc += h; });
+		}
+
+		uint64_t GetTransformedSum (const std::array<uint64_t, 256>& histogram, FixedChannel ch)
+		{
+			uint64_t result = 0;
+			for (int i = 0; i < 256; ++i)
+				result += histogram [i] * ApplyFixed (i, ch);
+			return result;
+		}
+
+		/* Returns the same as GetGray() would for the image with the
+		 * transform applied via ApplyTransform().
+		 */
+		uint64_t GetTransformedGray (const ChannelHistograms& histograms, const PixelTransform& transform)
+		{
+			const auto& fixed = ToFixed (transform);
+			return CombineGray (GetTransformedSum (histograms.Red_, fixed.Red_),
+					GetTransformedSum (histograms.Green_, fixed.Green_),
+					GetTransformedSum (histograms.Blue_, fixed.Blue_));
+		}
+
+		PixelTransform MakeColorTemp (int temperature)
+		{
+			const auto rgb = Temp2Rgb (temperature);
+			return
+			{
+				{ qRed (rgb) / 255.0, 0 },
+				{ qGreen (rgb) / 255.0, 0 },
+				{ qBlue (rgb) / 255.0, 0 }
+			};
+		}
+	}
+
+	ChannelTransform Then (const ChannelTransform& first, const ChannelTransform& second)
+	{
+		return { second.Mult_ * first.Mult_, second.Mult_ * first.Add_ + second.Add_ };
+	}
+
+	bool PixelTransform::IsIdentity () const
+	{
+		auto isIdentity = [] (const ChannelTransform& ch) { return ch.Mult_ == 1 && ch.Add_ == 0; };
+		return isIdentity (Red_) && isIdentity (Green_) && isIdentity (Blue_);
+	}
+
+	PixelTransform Then (const PixelTransform& first, const PixelTransform& second)
+	{
+		return
+		{
+			Then (first.Red_, second.Red_),
+			Then (first.Green_, second.Green_),
+			Then (first.Blue_, second.Blue_)
+		};
+	}
+
+	bool operator== (const ChannelTransform& t1, const ChannelTransform& t2)
+	{
+		return t1.Mult_ == t2.Mult_ && t1.Add_ == t2.Add_;
+	}
+
+	bool operator!= (const ChannelTransform& t1, const ChannelTransform& t2)
+	{
+		return !(t1 == t2);
+	}
+
+	bool operator== (const PixelTransform& t1, const PixelTransform& t2)
+	{
+		return t1.Red_ == t2.Red_ &&
+				t1.Green_ == t2.Green_ &&
+				t1.Blue_ == t2.Blue_;
+	}
+
+	bool operator!= (const PixelTransform& t1, const PixelTransform& t2)
+	{
+		return !(t1 == t2);
+	}
+
+	std::optional<PixelTransform> ResolveEffects (const QImage& image, const QList<Effect_t>& effects)
+	{
+		if (image.isNull ())
+			return {};
+
+		const auto pixelsCount = static_cast<uint64_t> (image.width ()) * image.height ();
+
+		// Only computed if a thresholded inversion follows other effects.
+		std::optional<ChannelHistograms> histograms;
+
+		bool hadEffects = false;
+		PixelTransform result;
+		for (const auto& effect : effects)
+			Util::Visit (effect,
+					[&] (const InvertEffect& effect)
+					{
+						if (effect.Threshold_)
+						{
+							// The gray level is to be computed over the image with all the previous effects applied.
+							uint64_t gray = 0;
+							if (result.IsIdentity ())
+								gray = GetGrayParallel (image);
+							else
+							{
+								if (!histograms)
+									histograms = GetHistogramsParallel (image);
+								gray = GetTransformedGray (*histograms, result);
+							}
+
+							if (!ShouldInvert (gray, pixelsCount, effect.Threshold_))
+								return;
+						}
+
+						result = Then (result, MakeUniform (-1, 255));
+						hadEffects = true;
+					},
+					[&] (const LightnessEffect& effect)
+					{
+						hadEffects = true;
+						if (std::abs (effect.Factor_ - 1) < 1e-3)
+							return;
+
+						result = Then (result, MakeUniform (1 / effect.Factor_, 0));
+					},
+					[&] (const ColorTempEffect& effect)
+					{
+						result = Then (result, MakeColorTemp (effect.Temperature_));
+						hadEffects = true;
+					});
+
+		if (!hadEffects)
+			return {};
+
+		return result;
+	}
+
+	void ApplyTransform (QImage& image, const PixelTransform& transform)
+	{
+		if (image.isNull () || transform.IsIdentity ())
+			return;
+
+		const auto& fixed = ToFixed (transform);
+
+		auto tiles = SplitRows (image, image.bits ());
+		if (tiles.size () == 1)
+			ApplyFixedTransform (tiles.front (), fixed);
+		else
+			QtConcurrent::blockingMap (tiles,
+					[&fixed] (QImage& tile) { ApplyFixedTransform (tile, fixed); });
+	}
+
+	bool ApplyEffects (QImage& image, const QList<Effect_t>& effects)
+	{
+		const auto& transform = ResolveEffects (image, effects);
+		if (!transform)
+			return false;
+
+		ApplyTransform (image, *transform);
+		return true;
+	}
+}
+}
+}
@@ -0,0 +1,130 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#pragma once
+
+#include <optional>
+#include <QList>
+#include "effects.h"
+
+class QImage;
+
+namespace LeechCraft
+{
+namespace Poshuku
+{
+namespace DCAC
+{
+	/** @brief Maps a color component c to Mult_ * c + Add_.
+	 *
+	 * Every effect is such a mapping for each of the components, and so
+	 * is any chain of effects.
+	 */
+	struct ChannelTransform
+	{
+		double Mult_ = 1;
+		double Add_ = 0;
+	};
+
+	/** @brief The per-channel transformation of a pixel.
+	 *
+	 * The alpha channel is always kept intact.
+	 */
+	struct PixelTransform
+	{
+		ChannelTransform Red_;
+		ChannelTransform Green_;
+		ChannelTransform Blue_;
+
+		bool IsIdentity () const;
+	};
+
+	/** @brief Returns the transformation applying \em first and then
+	 * \em second.
+	 */
+	ChannelTransform Then (const ChannelTransform& first, const ChannelTransform& second);
+
+	/** @brief Returns the transformation applying \em first and then
+	 * \em second.
+	 */
+	PixelTransform Then (const PixelTransform& first, const PixelTransform& second);
+
+	bool operator== (const ChannelTransform&, const ChannelTransform&);
+	bool operator!= (const ChannelTransform&, const ChannelTransform&);
+
+	bool operator== (const PixelTransform&, const PixelTransform&);
+	bool operator!= (const PixelTransform&, const PixelTransform&);
+
+	/** @brief Fuses the chain of effects into a single transformation.
+	 *
+	 * The \em image is only used to decide whether the thresholded
+	 * inversions should be applied, and it is not modified.
+	 *
+	 * The result may be applied to any part of the \em image (or of an
+	 * image having the same contents) via ApplyTransform().
+	 *
+	 * @param[in] image The ARGB32 image the effects are going to be
+	 * applied to.
+	 * @param[in] effects The effects to apply, in order.
+	 * @return The fused transformation, or an empty optional if none of
+	 * the effects apply.
+	 */
+	std::optional<PixelTransform> ResolveEffects (const QImage& image, const QList<Effect_t>& effects);
+
+	/** @brief Applies the \em transform to the \em image in place.
+	 *
+	 * Large images are split into row tiles processed in parallel.
+	 *
+	 * @param[in] image The ARGB32 image to modify in place.
+	 * @param[in] transform The transformation to apply.
+	 */
+	void ApplyTransform (QImage& image, const PixelTransform& transform);
+
+	/** @brief Applies the chain of effects to the image.
+	 *
+	 * Unlike applying the effects one by one, the consecutive effects
+	 * are fused into a single per-pixel transformation, which is then
+	 * applied in one pass over the image split into row tiles processed
+	 * in parallel. Additional passes are only needed to compute the
+	 * average gray level for the thresholded inversions.
+	 *
+	 * The result may differ by a couple of units per color component
+	 * from applying the effects one by one, since the intermediate
+	 * results are not rounded.
+	 *
+	 * This is ResolveEffects() followed by ApplyTransform().
+	 *
+	 * @param[in] image The ARGB32 image to modify in place.
+	 * @param[in] effects The effects to apply, in order.
+	 * @return Whether any of the effects actually changed the image.
+	 */
+	bool ApplyEffects (QImage& image, const QList<Effect_t>& effects);
+}
+}
+}
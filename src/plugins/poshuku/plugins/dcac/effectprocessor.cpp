@@ -28,13 +28,14 @@
  **********************************************************************/
 
 #include "effectprocessor.h"
+#include <cstring>
+#include <numeric>
 #include <QPainter>
+#include <QPixmap>
+#include <QRegion>
 #include <QWidget>
 #include <QtDebug>
-#include <util/sll/visitor.h>
-#include "invertcolors.h"
-#include "reducelightness.h"
-#include "colortemp.h"
+#include "effectpipeline.h"
 
 namespace LeechCraft
 {
@@ -42,6 +43,106 @@ namespace Poshuku
 {
 namespace DCAC
 {
+	namespace
+	{
+		/* The frames are compared in bands of this many rows, and only
+		 * the changed bands are filtered again.
+		 */
+		const int BandRows = 16;
+
+		/* If more than this share of the rows has changed, the
+		 * thresholded effects are decided again over the whole frame.
+		 * Otherwise the last decision is reused, so that a blinking
+		 * caret or an animated banner doesn't cause a full-frame gray
+		 * level computation.
+		 */
+		const double RevalidateShare = 0.25;
+
+		struct RowsRange
+		{
+			int Begin_;
+			int End_;
+		};
+
+		bool AreAreasEqual (const QImage& img1, const QImage& img2, const QRegion& area)
+		{
+			for (const auto& rect : area)
+			{
+				const auto offset = rect.x () * 4;
+				const auto rectBytes = rect.width () * 4;
+				for (int y = rect.top (); y <= rect.bottom (); ++y)
+					if (std::memcmp (img1.constScanLine (y) + offset, img2.constScanLine (y) + offset, rectBytes))
+						return false;
+			}
+			return true;
+		}
+
+		/* Only the given area of the frames is compared, and the bands
+		 * outside of it are considered unchanged.
+		 */
+		QVector<RowsRange> GetChangedRows (const QImage& last, const QImage& current, const QRegion& area)
+		{
+			const auto height = current.height ();
+			const auto& boundingRect = area.boundingRect ();
+
+			QVector<RowsRange> result;
+			for (int begin = boundingRect.top () / BandRows * BandRows; begin <= boundingRect.bottom (); begin += BandRows)
+			{
+				const auto end = std::min (begin + BandRows, height);
+				const auto& bandArea = area.intersected ({ 0, begin, current.width (), end - begin });
+				if (AreAreasEqual (last, current, bandArea))
+					continue;
+
+				if (!result.isEmpty () && result.last ().End_ == begin)
+					result.last ().End_ = end;
+				else
+					result.push_back ({ begin, end });
+			}
+			return result;
+		}
+
+		int GetRowsCount (const QVector<RowsRange>& ranges)
+		{
+			return std::accumulate (ranges.begin (), ranges.end (), 0,
+					[] (int acc, const RowsRange& range) { return acc + range.End_ - range.Begin_; });
+		}
+
+		void CopyRows (const QImage& source, QImage& target, const RowsRange& range)
+		{
+			const auto rowBytes = target.width () * 4;
+			for (int y = range.Begin_; y < range.End_; ++y)
+				std::memcpy (target.scanLine (y), source.constScanLine (y), rowBytes);
+		}
+
+		/* Copies the rows of the range from the source into the target
+		 * and filters them in place.
+		 */
+		void RefilterRows (const QImage& source, QImage& target, const RowsRange& range, const PixelTransform& transform)
+		{
+			CopyRows (source, target, range);
+
+			QImage rows { target.scanLine (range.Begin_), target.width (), range.End_ - range.Begin_, target.bytesPerLine (), target.format () };
+			ApplyTransform (rows, transform);
+		}
+
+		/* Returns the part of the frame being repainted in the frame
+		 * pixels, or the whole frame if the painter isn't clipped.
+		 */
+		QRegion GetExposedArea (const QPainter& painter, const QPixmap& pixmap, const QPoint& offset)
+		{
+			const QRect frameRect { {}, pixmap.size () };
+			if (!painter.hasClipping ())
+				return frameRect;
+
+			const auto dpr = pixmap.devicePixelRatioF ();
+
+			QRegion result;
+			for (const auto& rect : painter.clipRegion ().translated (-offset))
+				result += QRectF { QPointF { rect.topLeft () } * dpr, QSizeF { rect.size () } * dpr }.toAlignedRect ();
+			return result & frameRect;
+		}
+	}
+
 	EffectProcessor::EffectProcessor (QWidget *view)
 	: QGraphicsEffect { view }
 	{
@@ -53,31 +154,10 @@ namespace DCAC
 			return;
 
 		Effects_ = std::move (effects);
+		ResetCache ();
 		update ();
 	}
 
-	namespace
-	{
-		bool ApplyEffect (const Effect_t& effect, QImage& image)
-		{
-			return Util::Visit (effect,
-					[&image] (const InvertEffect& effect)
-					{
-						return InvertColors (image, effect.Threshold_);
-					},
-					[&image] (const LightnessEffect& effect)
-					{
-						ReduceLightness (image, effect.Factor_);
-						return true;
-					},
-					[&image] (const ColorTempEffect& effect)
-					{
-						AdjustColorTemp (image, effect.Temperature_);
-						return true;
-					});
-		}
-	}
-
 	void EffectProcessor::draw (QPainter *painter)
 	{
 		if (Effects_.isEmpty ())
@@ -88,9 +168,16 @@ namespace DCAC
 
 		QPoint offset;
 
-		auto image = sourcePixmap (Qt::LogicalCoordinates, &offset, QGraphicsEffect::NoPad).toImage ();
+		const auto& pixmap = sourcePixmap (Qt::LogicalCoordinates, &offset, QGraphicsEffect::NoPad);
+		const auto& exposed = GetExposedArea (*painter, pixmap, offset);
+		if (exposed.isEmpty ())
+			return;
+
+		// The effects only touch the color components, so RGB32 is as good as ARGB32 here.
+		auto image = pixmap.toImage ();
 		switch (image.format ())
 		{
+		case QImage::Format_RGB32:
 		case QImage::Format_ARGB32:
 		case QImage::Format_ARGB32_Premultiplied:
 			break;
@@ -98,18 +185,81 @@ namespace DCAC
 			image = image.convertToFormat (QImage::Format_ARGB32);
 			break;
 		}
-		image.detach ();
-
-		bool hadEffects = false;
-		for (const auto& effect : Effects_)
-			if (ApplyEffect (effect, image))
-				hadEffects = true;
 
-		if (hadEffects)
-			painter->drawImage (offset, image);
+		if (UpdateFiltered (image, exposed))
+			painter->drawImage (offset, LastFiltered_);
 		else
 			drawSource (painter);
 	}
+
+	void EffectProcessor::ResetCache ()
+	{
+		LastSource_ = {};
+		LastFiltered_ = {};
+		LastTransform_.reset ();
+	}
+
+	bool EffectProcessor::UpdateFiltered (const QImage& image, const QRegion& exposed)
+	{
+		if (image.isNull ())
+		{
+			ResetCache ();
+			return false;
+		}
+
+		const bool canReuse = LastTransform_ &&
+				LastSource_.size () == image.size () &&
+				LastSource_.format () == image.format ();
+		if (!canReuse)
+		{
+			ResetCache ();
+
+			LastTransform_ = ResolveEffects (image, Effects_);
+			if (!LastTransform_)
+				return false;
+
+			LastSource_ = image;
+			LastFiltered_ = image.copy ();
+			ApplyTransform (LastFiltered_, *LastTransform_);
+			return true;
+		}
+
+		auto changed = GetChangedRows (LastSource_, image, exposed);
+		if (changed.isEmpty ())
+			return true;
+
+		if (GetRowsCount (changed) > image.height () * RevalidateShare)
+		{
+			const auto& transform = ResolveEffects (image, Effects_);
+			if (!transform)
+			{
+				ResetCache ();
+				return false;
+			}
+
+			if (*transform != *LastTransform_)
+			{
+				LastTransform_ = transform;
+
+				LastSource_ = image;
+				LastFiltered_ = image.copy ();
+				ApplyTransform (LastFiltered_, *LastTransform_);
+				return true;
+			}
+		}
+
+		/* The changed rows outside of the exposed area are left as they
+		 * were in the last source frame, so they are caught when they
+		 * are exposed.
+		 */
+		for (const auto& range : changed)
+		{
+			CopyRows (image, LastSource_, range);
+			RefilterRows (image, LastFiltered_, range, *LastTransform_);
+		}
+
+		return true;
+	}
 }
 }
 }
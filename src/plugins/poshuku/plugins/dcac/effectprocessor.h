@@ -29,8 +29,13 @@
 
 #pragma once
 
+#include <optional>
 #include <QGraphicsEffect>
+#include <QImage>
 #include "effects.h"
+#include "effectpipeline.h"
+
+class QRegion;
 
 namespace LeechCraft
 {
@@ -41,12 +46,19 @@ namespace DCAC
 	class EffectProcessor : public QGraphicsEffect
 	{
 		QList<Effect_t> Effects_;
+
+		QImage LastSource_;
+		QImage LastFiltered_;
+		std::optional<PixelTransform> LastTransform_;
 	public:
 		EffectProcessor (QWidget*);
 
 		void SetEffects (QList<Effect_t>);
 	protected:
 		void draw (QPainter*) override;
+	private:
+		void ResetCache ();
+		bool UpdateFiltered (const QImage&, const QRegion& exposed);
 	};
 }
 }
@@ -44,13 +44,13 @@ namespace Poshuku
 {
 namespace DCAC
 {
-	namespace
+	uint64_t CombineGray (uint64_t r, uint64_t g, uint64_t b)
 	{
-		uint64_t CombineGray (uint64_t r, uint64_t g, uint64_t b)
-		{
-			return r * 11 + g * 16 + b * 5;
-		}
+		return r * 11 + g * 16 + b * 5;
+	}
 
+	namespace
+	{
 		uint64_t GetGrayDefault (const QImage& image)
 		{
 			uint64_t r = 0, g = 0, b = 0;
@@ -209,25 +209,33 @@ namespace DCAC
 		}
 #endif
 
-		uint64_t GetGray (const QImage& image)
+		void InvertRgb (QImage& image)
 		{
+			InvertRgbDefault (image);
+		}
+	}
+
+	uint64_t GetGray (const QImage& image)
+	{
 #ifdef SSE_ENABLED
-			static const auto ptr = Util::CpuFeatures::Choose ({
-						{ Util::CpuFeatures::Feature::AVX2, &GetGrayAVX2 },
-						{ Util::CpuFeatures::Feature::SSSE3, &GetGraySSSE3 }
-					},
-					&GetGrayDefault);
+		static const auto ptr = Util::CpuFeatures::Choose ({
+					{ Util::CpuFeatures::Feature::AVX2, &GetGrayAVX2 },
+					{ Util::CpuFeatures::Feature::SSSE3, &GetGraySSSE3 }
+				},
+				&GetGrayDefault);
 
-			return ptr (image);
+		return ptr (image);
 #else
-			return GetGrayDefault (image);
+		return GetGrayDefault (image);
 #endif
-		}
+	}
 
-		void InvertRgb (QImage& image)
-		{
-			InvertRgbDefault (image);
-		}
+	bool ShouldInvert (uint64_t gray, uint64_t pixelsCount, int threshold)
+	{
+		if (!threshold)
+			return true;
+
+		return pixelsCount && gray / (pixelsCount * 32) >= static_cast<uint64_t> (threshold);
 	}
 
 	bool InvertColors (QImage& image, int threshold)
@@ -235,10 +243,8 @@ namespace DCAC
 		const auto height = image.height ();
 		const auto width = image.width ();
 
-		const auto sourceGraySum = threshold ?
-				(GetGray (image) / (width * height * 32)) :
-				0;
-		const auto shouldInvert = !threshold || sourceGraySum >= static_cast<uint64_t> (threshold);
+		const auto shouldInvert = ShouldInvert (threshold ? GetGray (image) : 0,
+				static_cast<uint64_t> (width) * height, threshold);
 
 		if (shouldInvert)
 			InvertRgb (image);
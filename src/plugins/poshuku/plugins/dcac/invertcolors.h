@@ -29,6 +29,8 @@
 
 #pragma once
 
+#include <cstdint>
+
 class QImage;
 
 namespace LeechCraft
@@ -37,6 +39,28 @@ namespace Poshuku
 {
 namespace DCAC
 {
+	/** @brief Returns the weighted sum of the color components of the image.
+	 *
+	 * Each pixel contributes 11, 16 and 5 times its red, green and blue
+	 * components respectively, so the sums of several parts of an
+	 * image add up to the sum for the whole image.
+	 */
+	uint64_t GetGray (const QImage& image);
+
+	/** @brief Combines the sums of the color components like GetGray().
+	 */
+	uint64_t CombineGray (uint64_t r, uint64_t g, uint64_t b);
+
+	/** @brief Checks if an image with the given gray sum should be inverted.
+	 *
+	 * @param[in] gray The gray sum as returned by GetGray().
+	 * @param[in] pixelsCount The number of pixels the gray sum was
+	 * computed over.
+	 * @param[in] threshold The average gray level threshold, or 0 to
+	 * invert unconditionally.
+	 */
+	bool ShouldInvert (uint64_t gray, uint64_t pixelsCount, int threshold);
+
 	bool InvertColors (QImage& image, int threshold);
 }
 }
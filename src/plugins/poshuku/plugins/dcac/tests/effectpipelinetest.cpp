@@ -0,0 +1,177 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#include "effectpipelinetest.h"
+#include <QtTest>
+#include "../effectpipeline.cpp"
+#include "../invertcolors.cpp"
+#include "../reducelightness.cpp"
+#include "../colortemp.cpp"
+
+QTEST_APPLESS_MAIN (LeechCraft::Poshuku::DCAC::EffectPipelineTest)
+
+namespace LeechCraft
+{
+namespace Poshuku
+{
+namespace DCAC
+{
+	namespace
+	{
+		const QList<Effect_t> TestChain
+		{
+			InvertEffect { 0 },
+			LightnessEffect { 1.5 },
+			ColorTempEffect { 6000 }
+		};
+
+		void ApplyReference (QImage& image, const QList<Effect_t>& effects)
+		{
+			for (const auto& effect : effects)
+				Util::Visit (effect,
+						[&image] (const InvertEffect& effect) { InvertColors (image, effect.Threshold_); },
+						[&image] (const LightnessEffect& effect) { ReduceLightness (image, effect.Factor_); },
+						[&image] (const ColorTempEffect& effect) { AdjustColorTemp (image, effect.Temperature_); });
+		}
+
+		FixedTransform GetTestTransform ()
+		{
+			PixelTransform transform;
+			transform = Then (transform, MakeUniform (-1, 255));
+			transform = Then (transform, MakeUniform (1 / 1.5, 0));
+			return ToFixed (transform);
+		}
+	}
+
+	void EffectPipelineTest::testSSSE3 ()
+	{
+#ifdef SSE_ENABLED
+		CHECKFEATURE (SSSE3)
+
+		for (const auto& image : TestImages_)
+		{
+			const auto diff = CompareModifying (image,
+					&ApplyTransformDefault, &ApplyTransformSSSE3, GetTestTransform ());
+			QCOMPARE (diff, uchar { 0 });
+		}
+#endif
+	}
+
+	void EffectPipelineTest::testAVX2 ()
+	{
+#ifdef SSE_ENABLED
+		CHECKFEATURE (AVX2)
+
+		for (const auto& image : TestImages_)
+		{
+			const auto diff = CompareModifying (image,
+					&ApplyTransformDefault, &ApplyTransformAVX2, GetTestTransform ());
+			QCOMPARE (diff, uchar { 0 });
+		}
+#endif
+	}
+
+	void EffectPipelineTest::testFusedChain ()
+	{
+		for (const auto& image : TestImages_)
+		{
+			const auto diff = CompareModifying (image,
+					&ApplyReference, [] (QImage& image, const QList<Effect_t>& effects) { ApplyEffects (image, effects); },
+					TestChain);
+			QVERIFY2 (diff <= 4, ("too big difference: " + std::to_string (diff)).c_str ());
+		}
+	}
+
+	void EffectPipelineTest::testThresholdedInvert ()
+	{
+		const QList<Effect_t> chain
+		{
+			LightnessEffect { 1.2 },
+			InvertEffect { 100 },
+			ColorTempEffect { 5000 }
+		};
+
+		for (const auto& image : TestImages_)
+		{
+			const auto diff = CompareModifying (image,
+					&ApplyReference, [] (QImage& image, const QList<Effect_t>& effects) { ApplyEffects (image, effects); },
+					chain);
+			QVERIFY2 (diff <= 4, ("too big difference: " + std::to_string (diff)).c_str ());
+		}
+	}
+
+	void EffectPipelineTest::testPartialRows ()
+	{
+		for (const auto& image : TestImages_)
+		{
+			const auto& transform = ResolveEffects (image, TestChain);
+			QVERIFY (transform);
+
+			auto full = image.copy ();
+			ApplyTransform (full, *transform);
+
+			auto partial = image.copy ();
+			const auto bpl = partial.bytesPerLine ();
+			for (int row = 0; row < partial.height (); row += 7)
+			{
+				QImage rows { partial.scanLine (row), partial.width (), std::min (7, partial.height () - row), bpl, partial.format () };
+				ApplyTransform (rows, *transform);
+			}
+
+			QCOMPARE (partial, full);
+		}
+	}
+
+	void EffectPipelineTest::testTransformedGray ()
+	{
+		PixelTransform transform;
+		transform = Then (transform, MakeUniform (1 / 1.2, 0));
+		transform = Then (transform, MakeColorTemp (5000));
+
+		for (const auto& image : TestImages_)
+		{
+			auto transformed = image.copy ();
+			ApplyTransform (transformed, transform);
+
+			QCOMPARE (GetTransformedGray (GetHistogramsParallel (image), transform), GetGrayParallel (transformed));
+		}
+	}
+
+	void EffectPipelineTest::benchReference ()
+	{
+		BenchmarkFunction ([] (QImage& image) { ApplyReference (image, TestChain); });
+	}
+
+	void EffectPipelineTest::benchFused ()
+	{
+		BenchmarkFunction ([] (QImage& image) { ApplyEffects (image, TestChain); });
+	}
+}
+}
+}
@@ -0,0 +1,242 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#include "kernelsbench.h"
+#include <random>
+#include <QtTest>
+#include <util/sys/cpufeatures.h>
+#include "../effectpipeline.cpp"
+#include "../invertcolors.cpp"
+#include "../reducelightness.cpp"
+#include "../colortemp.cpp"
+
+QTEST_APPLESS_MAIN (LeechCraft::Poshuku::DCAC::KernelsBench)
+
+namespace LeechCraft
+{
+namespace Poshuku
+{
+namespace DCAC
+{
+	namespace
+	{
+		using Feature = Util::CpuFeatures::Feature;
+
+		const QList<QSize> Sizes { { 1280, 720 }, { 1920, 1080 }, { 3840, 2160 } };
+
+		/* Both the aligned and the unaligned views start within this
+		 * many extra pixels of each row of the backing buffer.
+		 */
+		const int PaddingPixels = 16;
+
+		const int Alignment = 32;
+
+		QList<Feature> GetSimdFeatures ()
+		{
+#ifdef SSE_ENABLED
+			return { Feature::SSSE3, Feature::AVX2 };
+#else
+			return {};
+#endif
+		}
+
+		QString GetFeatureName (Feature feature)
+		{
+			return feature == Feature::None ?
+					QString { "default" } :
+					Util::CpuFeatures::GetFeatureName (feature);
+		}
+
+		void AddRows (const QList<Feature>& features)
+		{
+			QTest::addColumn<int> ("feature");
+			QTest::addColumn<QSize> ("size");
+			QTest::addColumn<bool> ("aligned");
+
+			for (const auto feature : features)
+				for (const auto& size : Sizes)
+					for (const auto aligned : { true, false })
+					{
+						const auto& name = QString { "%1/%2x%3/%4" }
+								.arg (GetFeatureName (feature))
+								.arg (size.width ())
+								.arg (size.height ())
+								.arg (aligned ? "aligned" : "unaligned");
+						QTest::newRow (name.toUtf8 ().constData ())
+								<< static_cast<int> (feature)
+								<< size
+								<< aligned;
+					}
+		}
+
+		void AddKernelRows ()
+		{
+			AddRows (QList<Feature> { Feature::None } + GetSimdFeatures ());
+		}
+
+		template<typename F>
+		F Pick (Feature feature, F def, F ssse3, F avx2)
+		{
+			switch (feature)
+			{
+			case Feature::SSSE3:
+				return ssse3;
+			case Feature::AVX2:
+				return avx2;
+			default:
+				return def;
+			}
+		}
+
+		FixedTransform GetBenchTransform ()
+		{
+			return ToFixed (Then (MakeUniform (-1, 255), MakeUniform (1 / 1.5, 0)));
+		}
+	}
+
+#ifdef SSE_ENABLED
+#define PICK_KERNEL(name) Pick (isa, &name##Default, &name##SSSE3, &name##AVX2)
+#else
+#define PICK_KERNEL(name) &name##Default
+#endif
+
+#define FETCH_BENCH_ROW \
+	QFETCH (int, feature); \
+	QFETCH (QSize, size); \
+	QFETCH (bool, aligned); \
+	const auto isa = static_cast<Feature> (feature); \
+	if (isa != Feature::None && !Util::CpuFeatures {}.HasFeature (isa)) \
+		QSKIP ("unsupported instruction set"); \
+	auto image = GetImage (size, aligned);
+
+	void KernelsBench::initTestCase ()
+	{
+		std::mt19937 gen { 0xdcac };
+		std::uniform_int_distribution<uint32_t> dist { 0xff000000, 0xffffffff };
+
+		for (const auto& size : Sizes)
+		{
+			QImage buffer { size.width () + PaddingPixels, size.height (), QImage::Format_ARGB32 };
+			for (int y = 0; y < buffer.height (); ++y)
+			{
+				const auto scanline = reinterpret_cast<QRgb*> (buffer.scanLine (y));
+				for (int x = 0; x < buffer.width (); ++x)
+					scanline [x] = dist (gen);
+			}
+
+			QVERIFY (!(buffer.bytesPerLine () % Alignment));
+			Buffers_ [{ size.width (), size.height () }] = buffer;
+		}
+	}
+
+	QImage KernelsBench::GetImage (const QSize& size, bool aligned)
+	{
+		auto& buffer = Buffers_ [{ size.width (), size.height () }];
+
+		const auto bits = buffer.bits ();
+		auto offset = (Alignment - reinterpret_cast<uintptr_t> (bits) % Alignment) % Alignment;
+		if (!aligned)
+			offset += 4;
+
+		return { bits + offset, size.width (), size.height (), buffer.bytesPerLine (), buffer.format () };
+	}
+
+	void KernelsBench::benchGetGray_data ()
+	{
+		AddKernelRows ();
+	}
+
+	void KernelsBench::benchGetGray ()
+	{
+		FETCH_BENCH_ROW
+
+		const auto func = PICK_KERNEL (GetGray);
+
+		uint64_t gray = 0;
+		QBENCHMARK { gray += func (image); }
+		Q_UNUSED (gray)
+	}
+
+	void KernelsBench::benchInvertRgb_data ()
+	{
+		AddRows ({ Feature::None });
+	}
+
+	void KernelsBench::benchInvertRgb ()
+	{
+		FETCH_BENCH_ROW
+
+		QBENCHMARK { InvertRgbDefault (image); }
+	}
+
+	void KernelsBench::benchReduceLightness_data ()
+	{
+		AddKernelRows ();
+	}
+
+	void KernelsBench::benchReduceLightness ()
+	{
+		FETCH_BENCH_ROW
+
+		const auto func = PICK_KERNEL (ReduceLightness);
+
+		QBENCHMARK { func (image, 1.5); }
+	}
+
+	void KernelsBench::benchAdjustColorTemp_data ()
+	{
+		AddKernelRows ();
+	}
+
+	void KernelsBench::benchAdjustColorTemp ()
+	{
+		FETCH_BENCH_ROW
+
+		const auto func = PICK_KERNEL (AdjustColorTemp);
+
+		QBENCHMARK { func (image, 4000); }
+	}
+
+	void KernelsBench::benchApplyTransform_data ()
+	{
+		AddKernelRows ();
+	}
+
+	void KernelsBench::benchApplyTransform ()
+	{
+		FETCH_BENCH_ROW
+
+		const auto func = PICK_KERNEL (ApplyTransform);
+		const auto& transform = GetBenchTransform ();
+
+		QBENCHMARK { func (image, transform); }
+	}
+}
+}
+}
@@ -49,7 +49,7 @@ LeechCraft::Util::DBLock::~DBLock ()
 	if (!Initialized_)
 		return;
 
-	if (Good_ ? !Database_.commit () : !Database_.rollback ())
+	if (!Committed_ && (Good_ ? !Database_.commit () : !Database_.rollback ()))
 		DumpError (Database_.lastError ());
 
 	{
@@ -81,6 +81,22 @@ void LeechCraft::Util::DBLock::Good ()
 	Good_ = true;
 }
 
+bool LeechCraft::Util::DBLock::Commit ()
+{
+	if (!Initialized_ || Committed_)
+		return false;
+
+	if (!Database_.commit ())
+	{
+		DumpError (Database_.lastError ());
+		Good_ = false;
+		return false;
+	}
+
+	Committed_ = true;
+	return true;
+}
+
 void LeechCraft::Util::DBLock::DumpError (const QSqlError& lastError)
 {
 	qWarning () << lastError.text () << "|"
@@ -65,6 +65,7 @@ namespace LeechCraft
 
 			bool Good_ = false;
 			bool Initialized_ = false;
+			bool Committed_ = false;
 
 			static QMutex LockedMutex_;
 			static QSet<QString> LockedBases_;
@@ -109,6 +110,17 @@ namespace LeechCraft
 			 */
 			UTIL_DB_API void Good ();
 
+			/** @brief Commits the transaction right away.
+			 *
+			 * Unlike Good(), this function allows checking whether the
+			 * transaction has been committed successfully. If it has
+			 * not, the transaction is rolled back upon destruction.
+			 *
+			 * @return Whether the transaction has been committed. This
+			 * is always false if Init() didn't start the transaction.
+			 */
+			UTIL_DB_API bool Commit ();
+
 			/** @brief Dumps the error to the qWarning() stream.
 			 *
 			 * @param[in] error The error class.
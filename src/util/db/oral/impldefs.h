@@ -30,6 +30,7 @@
 #pragma once
 
 #include <memory>
+#include <QStringList>
 #include "oraldetailfwd.h"
 #include "oraltypes.h"
 
@@ -43,7 +44,32 @@ namespace LeechCraft::Util::oral::detail
 		virtual ~IInsertQueryBuilder () = default;
 
 		virtual std::shared_ptr<QSqlQuery> GetQuery (InsertAction) = 0;
+
+		/** Returns the query inserting \em rowsCount rows at once, with
+		 * the fields of each row bound to consecutive positional
+		 * placeholders, or a null pointer if the backend cannot do that
+		 * for the given \em action.
+		 */
+		virtual std::shared_ptr<QSqlQuery> GetBatchQuery (InsertAction action, int rowsCount) = 0;
+
+		/** Returns the maximum number of rows a single batch query can
+		 * insert.
+		 */
+		virtual int GetMaxBatchRows () const = 0;
 	};
 
+	inline QString BuildBatchValues (int fieldsCount, int rowsCount)
+	{
+		QStringList placeholders;
+		for (int i = 0; i < fieldsCount; ++i)
+			placeholders << "?";
+		const auto& row = "(" + placeholders.join (", ") + ")";
+
+		QStringList rows;
+		for (int i = 0; i < rowsCount; ++i)
+			rows << row;
+		return rows.join (", ");
+	}
+
 	using IInsertQueryBuilder_ptr = std::unique_ptr<IInsertQueryBuilder>;
 }
@@ -33,6 +33,9 @@
 #include <type_traits>
 #include <memory>
 #include <optional>
+#include <iterator>
+#include <typeindex>
+#include <unordered_map>
 #include <boost/fusion/include/for_each.hpp>
 #include <boost/fusion/include/fold.hpp>
 #include <boost/fusion/include/filter_if.hpp>
@@ -43,6 +46,7 @@
 #include <boost/fusion/container/generation/make_vector.hpp>
 #include <boost/variant/variant.hpp>
 #include <QStringList>
+#include <QVector>
 #include <QDateTime>
 #include <QPair>
 #include <QSqlQuery>
@@ -409,7 +413,8 @@ namespace oral
 		public:
 			template<typename ImplFactory>
 			AdaptInsert (const QSqlDatabase& db, CachedFieldsData data, ImplFactory&& factory) noexcept
-			: Data_ { RemovePKey (data) }
+			: DB_ { db }
+			, Data_ { RemovePKey (data) }
 			, QueryBuilder_ { factory.MakeInsertQueryBuilder (db, Data_) }
 			{
 			}
@@ -423,7 +428,89 @@ namespace oral
 			{
 				return Run<false> (t, action);
 			}
+
+			/** @brief Inserts all the records of the \em range in a single
+			 * transaction.
+			 *
+			 * Records without an autogenerated primary key are inserted
+			 * by multi-row statements if the backend supports that for
+			 * the \em action. Records with an autogenerated primary key
+			 * are inserted one by one via the same prepared statement, so
+			 * that the generated keys can be retrieved.
+			 *
+			 * If any of the records fails to be inserted, the whole
+			 * transaction is rolled back and QueryException is thrown.
+			 *
+			 * @return The list of the generated primary keys, in the order
+			 * of the records in the \em range, if the record type has an
+			 * autogenerated primary key, and nothing otherwise.
+			 */
+			template<typename Range>
+			auto Batch (const Range& range, InsertAction action = InsertAction::Default) const
+			{
+				auto db = DB_;
+				DBLock lock { db };
+				lock.Init ();
+
+				if constexpr (HasAutogen_)
+				{
+					constexpr auto index = FindPKey<Seq>::result_type::value;
+
+					QList<typename ValueAtC_t<Seq, index>::value_type> ids;
+					for (const Seq& t : range)
+						ids << Run<false> (t, action);
+
+					lock.Good ();
+					return ids;
+				}
+				else
+				{
+					const auto maxRows = QueryBuilder_->GetMaxBatchRows ();
+
+					QVector<const Seq*> chunk;
+					chunk.reserve (maxRows);
+					for (const Seq& t : range)
+					{
+						chunk << &t;
+						if (chunk.size () == maxRows)
+						{
+							RunBatch (chunk, action);
+							chunk.clear ();
+						}
+					}
+					RunBatch (chunk, action);
+
+					lock.Good ();
+				}
+			}
 		private:
+			void RunBatch (const QVector<const Seq*>& chunk, InsertAction action) const
+			{
+				if (chunk.isEmpty ())
+					return;
+
+				const auto query = chunk.size () > 1 ?
+						QueryBuilder_->GetBatchQuery (action, chunk.size ()) :
+						QSqlQuery_ptr {};
+				if (!query)
+				{
+					for (const auto t : chunk)
+						Run<false> (*t, action);
+					return;
+				}
+
+				int pos = 0;
+				for (const auto t : chunk)
+					boost::fusion::for_each (*t,
+							[&] (const auto& elem) { query->bindValue (pos++, ToVariantF (elem)); });
+
+				if (!query->exec ())
+				{
+					DBLock::DumpError (*query);
+					throw QueryException ("batch insert query execution failed", query);
+				}
+			}
+
 			template<bool UpdatePKey, typename Val>
 			auto Run (Val&& t, InsertAction action) const
 			{
@@ -1148,20 +1235,166 @@ namespace oral
 		template<typename F, typename R>
 		HandleSelectorResult (QString, F, R) -> HandleSelectorResult<F, R>;
 
+		/** @brief A lazily evaluated result of a select statement.
+		 *
+		 * The records are fetched from the database as the cursor is
+		 * advanced, so only the current record (or the current chunk of
+		 * records) is kept in memory. The underlying query is forward-only
+		 * and is finished as soon as the last record is fetched.
+		 *
+		 * The cursor is an input range: it can be traversed only once,
+		 * either via begin()/end(), via Next() or via NextChunk().
+		 */
+		template<typename Initializer>
+		class SelectCursor
+		{
+			QSqlQuery_ptr Query_;
+			Initializer Initializer_;
+		public:
+			using value_type = std::result_of_t<Initializer (QSqlQuery)>;
+
+			class iterator
+			{
+				SelectCursor *Cursor_ = nullptr;
+				std::optional<value_type> Current_;
+			public:
+				using iterator_category = std::input_iterator_tag;
+				using value_type = typename SelectCursor::value_type;
+				using difference_type = std::ptrdiff_t;
+				using pointer = const value_type*;
+				using reference = const value_type&;
+
+				iterator () = default;
+
+				explicit iterator (SelectCursor *cursor)
+				: Cursor_ { cursor }
+				, Current_ { cursor->Next () }
+				{
+				}
+
+				reference operator* () const
+				{
+					return *Current_;
+				}
+
+				pointer operator-> () const
+				{
+					return &*Current_;
+				}
+
+				iterator& operator++ ()
+				{
+					Current_ = Cursor_->Next ();
+					return *this;
+				}
+
+				bool operator== (const iterator& other) const
+				{
+					return !Current_ && !other.Current_;
+				}
+
+				bool operator!= (const iterator& other) const
+				{
+					return !(*this == other);
+				}
+			};
+
+			SelectCursor (QSqlQuery_ptr query, Initializer initializer)
+			: Query_ { std::move (query) }
+			, Initializer_ { std::move (initializer) }
+			{
+			}
+
+			iterator begin ()
+			{
+				return iterator { this };
+			}
+
+			iterator end ()
+			{
+				return {};
+			}
+
+			/** @brief Fetches the next record.
+			 *
+			 * @return The next record, or an empty optional if there are
+			 * no more records.
+			 */
+			std::optional<value_type> Next ()
+			{
+				if (!Query_->isActive ())
+					return {};
+
+				if (!Query_->next ())
+				{
+					Query_->finish ();
+					return {};
+				}
+
+				return Initializer_ (*Query_);
+			}
+
+			/** @brief Fetches up to \em size next records.
+			 *
+			 * @return The next records, or an empty list if there are no
+			 * more records.
+			 */
+			QList<value_type> NextChunk (int size)
+			{
+				QList<value_type> result;
+				result.reserve (size);
+				while (result.size () < size)
+				{
+					auto next = Next ();
+					if (!next)
+						break;
+					result << std::move (*next);
+				}
+				return result;
+			}
+		};
+
+		/* Identifies the SQL text of a select statement: for a given
+		 * record type it is fully determined by the types of the selector,
+		 * the expression tree and the order, group, limit and offset
+		 * clauses, while all the values are bound.
+		 */
+		template<typename Selector, typename Tree, typename Order, typename Group, typename Limit, typename Offset>
+		struct SelectShape {};
+
 		class SelectWrapperCommon
 		{
 		protected:
 			const QSqlDatabase DB_;
 			const QString LimitNone_;
 
+			mutable std::unordered_map<std::type_index, QSqlQuery> Queries_;
+
 			SelectWrapperCommon (const QSqlDatabase& db, const QString& limitNone)
 			: DB_ { db }
 			, LimitNone_ { limitNone }
 			{
 			}
 
-			auto RunQuery (const QString& fields, const QString& from,
-					QString where, std::function<void (QSqlQuery&)>&& binder,
+			template<typename Shape, typename SqlBuilder>
+			QSqlQuery& GetPreparedQuery (SqlBuilder&& sqlBuilder) const
+			{
+				const auto pos = Queries_.find (typeid (Shape));
+				if (pos != Queries_.end ())
+					return pos->second;
+
+				QSqlQuery query { DB_ };
+				if (!query.prepare (sqlBuilder ()))
+				{
+					DBLock::DumpError (query);
+					throw QueryException ("fetch query preparation failed", std::make_shared<QSqlQuery> (query));
+				}
+
+				return Queries_.emplace (typeid (Shape), std::move (query)).first->second;
+			}
+
+			QString BuildQueryString (const QString& fields, const QString& from,
+					QString where,
 					const QString& orderStr,
 					const QString& groupStr,
 					const QString& limitOffsetStr) const
@@ -1169,25 +1402,21 @@ namespace oral
 				if (!where.isEmpty ())
 					where.prepend (" WHERE ");
 
-				const auto& queryStr = "SELECT " + fields +
+				return "SELECT " + fields +
 						" FROM " + from +
 						where +
 						orderStr +
 						groupStr +
 						limitOffsetStr;
+			}
 
-				QSqlQuery query { DB_ };
-				query.prepare (queryStr);
-				if (binder)
-					binder (query);
-
+			void RunQuery (QSqlQuery& query) const
+			{
 				if (!query.exec ())
 				{
 					DBLock::DumpError (query);
 					throw QueryException ("fetch query execution failed", std::make_shared<QSqlQuery> (query));
 				}
-
-				return query;
 			}
 
 			QString HandleLimitOffset (LimitNone, OffsetNone) const noexcept
@@ -1195,26 +1424,42 @@ namespace oral
 				return {};
 			}
 
-			QString HandleLimitOffset (Limit limit, OffsetNone) const noexcept
+			QString HandleLimitOffset (Limit, OffsetNone) const noexcept
+			{
+				return " LIMIT :limit";
+			}
+
+			template<typename L>
+			QString HandleLimitOffset (L, Offset) const noexcept
+			{
+				if constexpr (std::is_same_v<std::decay_t<L>, LimitNone>)
+					return " LIMIT " + LimitNone_ + " OFFSET :offset";
+				else
+					return " LIMIT :limit OFFSET :offset";
+			}
+
+			void BindLimitOffset (QSqlQuery&, LimitNone, OffsetNone) const noexcept
 			{
-				return " LIMIT " + QString::number (limit.Count);
+			}
+
+			void BindLimitOffset (QSqlQuery& query, Limit limit, OffsetNone) const noexcept
+			{
+				query.bindValue (":limit", static_cast<qlonglong> (limit.Count));
 			}
 
 			template<typename L>
-			QString HandleLimitOffset (L limit, Offset offset) const noexcept
+			void BindLimitOffset (QSqlQuery& query, L limit, Offset offset) const noexcept
 			{
-				QString limitStr;
 				if constexpr (std::is_same_v<std::decay_t<L>, LimitNone>)
 				{
 					Q_UNUSED (limit)
-					limitStr = LimitNone_;
 				}
 				else if constexpr (std::is_integral_v<L>)
-					limitStr = QString::number (limit);
+					query.bindValue (":limit", static_cast<qlonglong> (limit));
 				else
-					limitStr = QString::number (limit.Count);
-				return " LIMIT " + limitStr +
-						" OFFSET " + QString::number (offset.Count);
+					query.bindValue (":limit", static_cast<qlonglong> (limit.Count));
+
+				query.bindValue (":offset", static_cast<qlonglong> (offset.Count));
 			}
 		};
 
@@ -1276,6 +1521,14 @@ namespace oral
 					return std::apply (W_, Params_);
 				}
 
+				/** @brief Runs the query returning a SelectCursor instead
+				 * of a list of all the records.
+				 */
+				auto Cursor () &&
+				{
+					return std::apply ([this] (auto&&... params) { return W_.MakeCursor (params...); }, Params_);
+				}
+
 				template<auto... Ptrs>
 				auto Group () && noexcept
 				{
@@ -1333,44 +1586,95 @@ namespace oral
 					Limit limit = LimitNone {},
 					Offset offset = OffsetNone {}) const
 			{
+				using Shape_t = SelectShape<std::decay_t<Selector>, ExprTree<Type, L, R>,
+						std::decay_t<Order>, std::decay_t<Group>, std::decay_t<Limit>, std::decay_t<Offset>>;
+
 				const auto& [where, binder, _] = HandleExprTree<T> (tree);
 				Q_UNUSED (_);
 				const auto& [fields, initializer, resultBehaviour] = HandleSelector (std::forward<Selector> (selector));
-				return HandleResultBehaviour (resultBehaviour,
-						Select (fields, BuildFromClause (tree),
-								where, binder,
-								initializer,
-								HandleOrder (std::forward<Order> (order)),
-								HandleGroup (std::forward<Group> (group)),
-								HandleLimitOffset (std::forward<Limit> (limit), std::forward<Offset> (offset))));
+
+				auto& query = GetPreparedQuery<Shape_t> ([&, &where = where, &fields = fields]
+						{
+							return BuildQueryString (fields, BuildFromClause (tree),
+									where,
+									HandleOrder (std::forward<Order> (order)),
+									HandleGroup (std::forward<Group> (group)),
+									HandleLimitOffset (limit, offset));
+						});
+
+				if constexpr (!std::is_same_v<Void, std::decay_t<decltype (binder)>>)
+					binder (query);
+				BindLimitOffset (query, limit, offset);
+
+				return HandleResultBehaviour (resultBehaviour, Select (query, initializer));
+			}
+
+			template<
+					typename Selector,
+					ExprType Type, typename L, typename R,
+					typename Order = OrderNone,
+					typename Group = GroupNone,
+					typename Limit = LimitNone,
+					typename Offset = OffsetNone
+				>
+			auto MakeCursor (Selector selector,
+					const ExprTree<Type, L, R>& tree,
+					Order order = OrderNone {},
+					Group group = GroupNone {},
+					Limit limit = LimitNone {},
+					Offset offset = OffsetNone {}) const
+			{
+				const auto& [where, binder, _] = HandleExprTree<T> (tree);
+				Q_UNUSED (_);
+				const auto& [fields, initializer, resultBehaviour] = HandleSelector (std::forward<Selector> (selector));
+				static_assert (std::is_same_v<std::decay_t<decltype (resultBehaviour)>, ResultBehaviour::All>,
+						"cursors make sense only for selectors returning all the rows");
+
+				/* The cursor outlives this call and may be interleaved with
+				 * other selects of the same shape, so it gets its own query
+				 * instead of a cached one.
+				 */
+				const auto query = std::make_shared<QSqlQuery> (DB_);
+				query->setForwardOnly (true);
+				if (!query->prepare (BuildQueryString (fields, BuildFromClause (tree),
+							where,
+							HandleOrder (std::forward<Order> (order)),
+							HandleGroup (std::forward<Group> (group)),
+							HandleLimitOffset (limit, offset))))
+				{
+					DBLock::DumpError (*query);
+					throw QueryException ("fetch query preparation failed", query);
+				}
+
+				if constexpr (!std::is_same_v<Void, std::decay_t<decltype (binder)>>)
+					binder (*query);
+				BindLimitOffset (*query, limit, offset);
+				RunQuery (*query);
+
+				return SelectCursor<std::decay_t<decltype (initializer)>> { query, initializer };
 			}
 		private:
-			template<typename Binder, typename Initializer>
-			auto Select (const QString& fields, const QString& from,
-					const QString& where, Binder&& binder,
-					Initializer&& initializer,
-					const QString& orderStr,
-					const QString& groupStr,
-					const QString& limitOffsetStr) const
+			template<typename Initializer>
+			auto Select (QSqlQuery& query, Initializer&& initializer) const
 			{
-				std::function<void (QSqlQuery&)> binderFunc;
-				if constexpr (!std::is_same_v<Void, std::decay_t<Binder>>)
-					binderFunc = binder;
-				auto query = RunQuery (fields, from, where, std::move (binderFunc), orderStr, groupStr, limitOffsetStr);
+				RunQuery (query);
 
 				if constexpr (SelectBehaviour == SelectBehaviour::Some)
 				{
 					QList<std::result_of_t<Initializer (QSqlQuery)>> result;
 					while (query.next ())
 						result << initializer (query);
+					query.finish ();
 					return result;
 				}
 				else
 				{
 					using RetType_t = std::optional<std::result_of_t<Initializer (QSqlQuery)>>;
-					return query.next () ?
+					auto result = query.next () ?
 						RetType_t { initializer (query) } :
 						RetType_t {};
+					query.finish ();
+					return result;
 				}
 			}
 
@@ -29,6 +29,10 @@
 
 #pragma once
 
+#include <algorithm>
+#include <optional>
+#include <QHash>
+#include <QPair>
 #include <util/sll/visitor.h>
 #include "oraltypes.h"
 #include "oraldetailfwd.h"
@@ -47,6 +51,14 @@ namespace LeechCraft::Util::oral::detail::PostgreSQL
 
 		const QString InsertBase_;
 		const QString Updater_;
+
+		QHash<QPair<int, int>, QSqlQuery_ptr> BatchQueries_;
+		const QString BatchInsertBase_;
+		const int FieldsCount_;
+
+		// PostgreSQL protocol limits the number of parameters to 65535.
+		static constexpr int MaxBoundVariables = 65535;
+		static constexpr int MaxBatchRows = 1000;
 	public:
 		InsertQueryBuilder (const QSqlDatabase& db, const CachedFieldsData& data)
 		: DB_ { db }
@@ -54,6 +66,9 @@ namespace LeechCraft::Util::oral::detail::PostgreSQL
 				" (" + data.Fields_.join (", ") + ") VALUES (" +
 				data.BoundFields_.join (", ") + ") " }
 		, Updater_ { Map (data.Fields_, [] (auto&& str) { return str + " = EXCLUDED." + str; }).join (", ") }
+		, BatchInsertBase_ { "INSERT INTO " + data.Table_ +
+				" (" + data.Fields_.join (", ") + ") VALUES " }
+		, FieldsCount_ { data.Fields_.size () }
 		{
 		}
 
@@ -64,6 +79,34 @@ namespace LeechCraft::Util::oral::detail::PostgreSQL
 					[this] (InsertAction::IgnoreTag) { return GetIgnoreQuery (); },
 					[this] (InsertAction::Replace ct) { return MakeReplaceQuery (ct.Fields_); });
 		}
+
+		QSqlQuery_ptr GetBatchQuery (InsertAction action, int rowsCount) override
+		{
+			/* ON CONFLICT DO UPDATE refuses to affect the same row twice
+			 * within a single statement, while separate inserts of the
+			 * same key just replace each other, so replacing is left to
+			 * the row-by-row path.
+			 */
+			const auto& conflictClause = Visit (action.Selector_,
+					[] (InsertAction::DefaultTag) { return std::optional<QString> { "" }; },
+					[] (InsertAction::IgnoreTag) { return std::optional<QString> { " ON CONFLICT DO NOTHING" }; },
+					[] (const InsertAction::Replace&) { return std::optional<QString> {}; });
+			if (!conflictClause)
+				return {};
+
+			auto& query = BatchQueries_ [{ action.Selector_.which (), rowsCount }];
+			if (!query)
+			{
+				query = std::make_shared<QSqlQuery> (DB_);
+				query->prepare (BatchInsertBase_ + BuildBatchValues (FieldsCount_, rowsCount) + *conflictClause);
+			}
+			return query;
+		}
+
+		int GetMaxBatchRows () const override
+		{
+			return std::clamp (MaxBoundVariables / std::max (FieldsCount_, 1), 1, MaxBatchRows);
+		}
 	private:
 		QSqlQuery_ptr GetDefaultQuery ()
 		{
@@ -29,6 +29,9 @@
 
 #pragma once
 
+#include <algorithm>
+#include <QHash>
+#include <QPair>
 #include <util/sll/visitor.h>
 #include "oraltypes.h"
 #include "oraldetailfwd.h"
@@ -44,12 +47,22 @@ namespace LeechCraft::Util::oral::detail::SQLite
 
 		std::array<QSqlQuery_ptr, InsertAction::StaticCount () + 1> Queries_;
 		const QString InsertSuffix_;
+
+		QHash<QPair<int, int>, QSqlQuery_ptr> BatchQueries_;
+		const QString BatchInsertSuffix_;
+		const int FieldsCount_;
+
+		// The default SQLITE_MAX_VARIABLE_NUMBER before SQLite 3.32.
+		static constexpr int MaxBoundVariables = 999;
 	public:
 		InsertQueryBuilder (const QSqlDatabase& db, const CachedFieldsData& data)
 		: DB_ { db }
 		, InsertSuffix_ { " INTO " + data.Table_ +
 			" (" + data.Fields_.join (", ") + ") VALUES (" +
 			data.BoundFields_.join (", ") + ");" }
+		, BatchInsertSuffix_ { " INTO " + data.Table_ +
+			" (" + data.Fields_.join (", ") + ") VALUES " }
+		, FieldsCount_ { data.Fields_.size () }
 		{
 		}
 
@@ -63,6 +76,23 @@ namespace LeechCraft::Util::oral::detail::SQLite
 			}
 			return query;
 		}
+
+		QSqlQuery_ptr GetBatchQuery (InsertAction action, int rowsCount) override
+		{
+			auto& query = BatchQueries_ [{ action.Selector_.which (), rowsCount }];
+			if (!query)
+			{
+				query = std::make_shared<QSqlQuery> (DB_);
+				query->prepare (GetInsertPrefix (action) + BatchInsertSuffix_ +
+						BuildBatchValues (FieldsCount_, rowsCount) + ";");
+			}
+			return query;
+		}
+
+		int GetMaxBatchRows () const override
+		{
+			return std::max (MaxBoundVariables / std::max (FieldsCount_, 1), 1);
+		}
 	private:
 		QString GetInsertPrefix (InsertAction action)
 		{
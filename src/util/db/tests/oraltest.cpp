@@ -191,6 +191,21 @@ namespace Util
 		QCOMPARE (records, (QList<AutogenPKeyRecord> { { 1, "0" }, { 2, "1" }, { 3, "2" } }));
 	}
 
+	void OralTest::testAutoPKeyRecordInsertBatchReturnsPKeys ()
+	{
+		auto adapted = Util::oral::AdaptPtr<AutogenPKeyRecord, OralFactory> (MakeDatabase ());
+
+		QList<AutogenPKeyRecord> records;
+		for (int i = 0; i < 3; ++i)
+			records.push_back ({ 0, QString::number (i) });
+
+		const auto& ids = adapted->Insert.Batch (records);
+		QCOMPARE (ids, (QList<int> { 1, 2, 3 }));
+
+		const auto& list = adapted->Select ();
+		QCOMPARE (list, (QList<AutogenPKeyRecord> { { 1, "0" }, { 2, "1" }, { 3, "2" } }));
+	}
+
 	void OralTest::testNoPKeyRecordInsertSelect ()
 	{
 		auto adapted = PrepareRecords<NoPKeyRecord> (MakeDatabase ());
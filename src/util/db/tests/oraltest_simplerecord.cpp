@@ -70,6 +70,35 @@ namespace Util
 		QCOMPARE (list, (QList<SimpleRecord> { { 0, "0" } }));
 	}
 
+	void OralTest_SimpleRecord::testSimpleRecordInsertBatchSelect ()
+	{
+		auto adapted = Util::oral::AdaptPtr<SimpleRecord, OralFactory> (MakeDatabase ());
+
+		// Enough records to span several multi-row statements and a remainder.
+		QList<SimpleRecord> records;
+		for (int i = 0; i < 1500; ++i)
+			records.push_back ({ i, QString::number (i) });
+
+		adapted->Insert.Batch (records);
+
+		const auto& list = adapted->Select.Build ().Order (oral::OrderBy<sph::asc<&SimpleRecord::ID_>>) ();
+		QCOMPARE (list, records);
+	}
+
+	void OralTest_SimpleRecord::testSimpleRecordInsertBatchIgnoreSelect ()
+	{
+		auto adapted = Util::oral::AdaptPtr<SimpleRecord, OralFactory> (MakeDatabase ());
+
+		QList<SimpleRecord> records;
+		for (int i = 0; i < 3; ++i)
+			records.push_back ({ 0, QString::number (i) });
+
+		adapted->Insert.Batch (records, lco::InsertAction::Ignore);
+
+		const auto& list = adapted->Select ();
+		QCOMPARE (list, (QList<SimpleRecord> { { 0, "0" } }));
+	}
+
 	void OralTest_SimpleRecord::testSimpleRecordInsertSelectByPos ()
 	{
 		auto adapted = PrepareRecords<SimpleRecord> (MakeDatabase ());
@@ -269,6 +298,41 @@ namespace Util
 		QCOMPARE (list, (QList<SimpleRecord> { { 0, "foo" }, { 2, "foobar" } }));
 	}
 
+	void OralTest_SimpleRecord::testSimpleRecordSelectCursor ()
+	{
+		auto adapted = PrepareRecords<SimpleRecord> (MakeDatabase ());
+
+		QList<SimpleRecord> list;
+		for (const auto& record : adapted->Select.Build ().Cursor ())
+			list << record;
+		QCOMPARE (list, (QList<SimpleRecord> { { 0, "0" }, { 1, "1" }, { 2, "2" } }));
+	}
+
+	void OralTest_SimpleRecord::testSimpleRecordSelectCursorFieldsWhere ()
+	{
+		auto adapted = PrepareRecords<SimpleRecord> (MakeDatabase ());
+
+		auto cursor = adapted->Select.Build ()
+				.Select (sph::fields<&SimpleRecord::Value_>)
+				.Where (sph::f<&SimpleRecord::ID_> > 0)
+				.Cursor ();
+		QCOMPARE (cursor.Next (), std::optional<QString> { "1" });
+		QCOMPARE (cursor.Next (), std::optional<QString> { "2" });
+		QCOMPARE (cursor.Next (), std::optional<QString> {});
+		QCOMPARE (cursor.Next (), std::optional<QString> {});
+	}
+
+	void OralTest_SimpleRecord::testSimpleRecordSelectCursorChunks ()
+	{
+		auto adapted = PrepareRecords<SimpleRecord> (MakeDatabase (), 5);
+
+		auto cursor = adapted->Select.Build ().Cursor ();
+		QCOMPARE (cursor.NextChunk (2), (QList<SimpleRecord> { { 0, "0" }, { 1, "1" } }));
+		QCOMPARE (cursor.NextChunk (2), (QList<SimpleRecord> { { 2, "2" }, { 3, "3" } }));
+		QCOMPARE (cursor.NextChunk (2), (QList<SimpleRecord> { { 4, "4" } }));
+		QCOMPARE (cursor.NextChunk (2), QList<SimpleRecord> {});
+	}
+
 	void OralTest_SimpleRecord::testSimpleRecordUpdate ()
 	{
 		auto adapted = PrepareRecords<SimpleRecord> (MakeDatabase ());
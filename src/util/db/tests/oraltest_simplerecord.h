@@ -42,6 +42,8 @@ namespace Util
 		void testSimpleRecordInsertSelect ();
 		void testSimpleRecordInsertReplaceSelect ();
 		void testSimpleRecordInsertIgnoreSelect ();
+		void testSimpleRecordInsertBatchSelect ();
+		void testSimpleRecordInsertBatchIgnoreSelect ();
 
 		void testSimpleRecordInsertSelectByPos ();
 		void testSimpleRecordInsertSelectByPos2 ();
@@ -79,6 +81,10 @@ namespace Util
 
 		void testSimpleRecordInsertSelectLike ();
 
+		void testSimpleRecordSelectCursor ();
+		void testSimpleRecordSelectCursorFieldsWhere ();
+		void testSimpleRecordSelectCursorChunks ();
+
 		void testSimpleRecordUpdate ();
 		void testSimpleRecordUpdateExprTree ();
 		void testSimpleRecordUpdateMultiExprTree ();
@@ -71,6 +71,71 @@ namespace Util
 		QBENCHMARK { adapted.Insert ({ 0, "0" }, lco::InsertAction::Ignore); }
 	}
 
+	namespace
+	{
+		const int BatchRecordsCount = 10000;
+
+		QList<SimpleRecord> MakeBatchRecords ()
+		{
+			QList<SimpleRecord> records;
+			for (int i = 0; i < BatchRecordsCount; ++i)
+				records.push_back ({ i, QString::number (i) });
+			return records;
+		}
+	}
+
+	void OralTest_SimpleRecord_Bench::benchBaselineInsert10k ()
+	{
+		auto db = MakeDatabase ();
+		Util::oral::Adapt<SimpleRecord, OralFactory> (db);
+
+		QSqlQuery query { db };
+		query.prepare ("INSERT INTO SimpleRecord (ID, Value) VALUES (:id, :val);");
+
+		QBENCHMARK
+		{
+			RunTextQuery (db, "DELETE FROM SimpleRecord;");
+
+			db.transaction ();
+			for (int i = 0; i < BatchRecordsCount; ++i)
+			{
+				query.bindValue (":id", i);
+				query.bindValue (":val", QString::number (i));
+				query.exec ();
+			}
+			db.commit ();
+		}
+	}
+
+	void OralTest_SimpleRecord_Bench::benchSimpleRecordInsert10k ()
+	{
+		auto db = MakeDatabase ();
+		const auto& adapted = Util::oral::Adapt<SimpleRecord, OralFactory> (db);
+		const auto& records = MakeBatchRecords ();
+
+		QBENCHMARK
+		{
+			RunTextQuery (db, "DELETE FROM SimpleRecord;");
+
+			for (const auto& record : records)
+				adapted.Insert (record);
+		}
+	}
+
+	void OralTest_SimpleRecord_Bench::benchSimpleRecordInsertBatch10k ()
+	{
+		auto db = MakeDatabase ();
+		const auto& adapted = Util::oral::Adapt<SimpleRecord, OralFactory> (db);
+		const auto& records = MakeBatchRecords ();
+
+		QBENCHMARK
+		{
+			RunTextQuery (db, "DELETE FROM SimpleRecord;");
+
+			adapted.Insert.Batch (records);
+		}
+	}
+
 	void OralTest_SimpleRecord_Bench::benchBaselineUpdate ()
 	{
 		auto db = MakeDatabase ();
@@ -96,5 +161,65 @@ namespace Util
 
 		QBENCHMARK { adapted.Update ({ 0, "1" }); }
 	}
+
+	namespace
+	{
+		const int SelectRecordsCount = 100;
+	}
+
+	void OralTest_SimpleRecord_Bench::benchBaselineSelectOne ()
+	{
+		auto db = MakeDatabase ();
+		const auto& adapted = PrepareRecords<SimpleRecord> (db, SelectRecordsCount);
+
+		QSqlQuery query { db };
+		query.prepare ("SELECT SimpleRecord.ID, SimpleRecord.Value FROM SimpleRecord WHERE SimpleRecord.ID = :id;");
+
+		QBENCHMARK
+		{
+			query.bindValue (":id", 50);
+			query.exec ();
+			query.next ();
+			SimpleRecord record { query.value (0).toInt (), query.value (1).toString () };
+			Q_UNUSED (record)
+			query.finish ();
+		}
+	}
+
+	void OralTest_SimpleRecord_Bench::benchSimpleRecordSelectOne ()
+	{
+		auto db = MakeDatabase ();
+		const auto& adapted = PrepareRecords<SimpleRecord> (db, SelectRecordsCount);
+
+		QBENCHMARK { adapted->SelectOne (sph::f<&SimpleRecord::ID_> == 50); }
+	}
+
+	void OralTest_SimpleRecord_Bench::benchBaselineSelect ()
+	{
+		auto db = MakeDatabase ();
+		const auto& adapted = PrepareRecords<SimpleRecord> (db, SelectRecordsCount);
+
+		QSqlQuery query { db };
+		query.prepare ("SELECT SimpleRecord.ID, SimpleRecord.Value FROM SimpleRecord WHERE SimpleRecord.ID < :id;");
+
+		QBENCHMARK
+		{
+			query.bindValue (":id", 10);
+			query.exec ();
+
+			QList<SimpleRecord> records;
+			while (query.next ())
+				records.push_back ({ query.value (0).toInt (), query.value (1).toString () });
+			query.finish ();
+		}
+	}
+
+	void OralTest_SimpleRecord_Bench::benchSimpleRecordSelect ()
+	{
+		auto db = MakeDatabase ();
+		const auto& adapted = PrepareRecords<SimpleRecord> (db, SelectRecordsCount);
+
+		QBENCHMARK { adapted->Select (sph::f<&SimpleRecord::ID_> < 10); }
+	}
 }
 }
@@ -44,8 +44,18 @@ namespace Util
 		void benchBaselineInsert ();
 		void benchSimpleRecordInsert ();
 
+		void benchBaselineInsert10k ();
+		void benchSimpleRecordInsert10k ();
+		void benchSimpleRecordInsertBatch10k ();
+
 		void benchBaselineUpdate ();
 		void benchSimpleRecordUpdate ();
+
+		void benchBaselineSelectOne ();
+		void benchSimpleRecordSelectOne ();
+
+		void benchBaselineSelect ();
+		void benchSimpleRecordSelect ();
 	};
 }
 }
@@ -0,0 +1,184 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#include "workerthreadtest.h"
+#include <QtTest>
+#include <workerthreadbase.h>
+
+QTEST_GUILESS_MAIN (LeechCraft::Util::WorkerThreadTest)
+
+namespace LeechCraft
+{
+namespace Util
+{
+	namespace
+	{
+		class TestThread final : public WorkerThreadBase
+		{
+		public:
+			TestThread ()
+			{
+				SetPaused (true);
+				start ();
+			}
+
+			~TestThread ()
+			{
+				quit ();
+				wait ();
+			}
+		protected:
+			void Initialize () override
+			{
+			}
+
+			void Cleanup () override
+			{
+			}
+		};
+
+		template<typename T>
+		T WaitFor (QFuture<T> future)
+		{
+			future.waitForFinished ();
+			if constexpr (!std::is_same_v<T, void>)
+				return future.result ();
+		}
+	}
+
+	void WorkerThreadTest::testOrder ()
+	{
+		TestThread thread;
+
+		QList<int> executed;
+		QFuture<void> last;
+		for (int i = 0; i < 100; ++i)
+			last = thread.ScheduleImpl ([&executed, i] { executed << i; });
+
+		thread.SetPaused (false);
+		WaitFor (last);
+
+		QList<int> expected;
+		for (int i = 0; i < 100; ++i)
+			expected << i;
+		QCOMPARE (executed, expected);
+	}
+
+	void WorkerThreadTest::testPriorities ()
+	{
+		TestThread thread;
+
+		QList<int> executed;
+		auto schedule = [&] (TaskPriority priority, int value)
+		{
+			return thread.ScheduleImpl ({ priority }, [&executed, value] { executed << value; });
+		};
+
+		schedule (TaskPriority::Low, 0);
+		schedule (TaskPriority::Normal, 1);
+		schedule (TaskPriority::High, 2);
+		schedule (TaskPriority::Normal, 3);
+		const auto last = schedule (TaskPriority::Low, 4);
+
+		thread.SetPaused (false);
+		WaitFor (last);
+
+		QCOMPARE (executed, (QList<int> { 2, 1, 3, 0, 4 }));
+	}
+
+	void WorkerThreadTest::testCoalescing ()
+	{
+		TestThread thread;
+
+		QList<int> executed;
+		auto schedule = [&] (const QByteArray& key, int value)
+		{
+			return thread.ScheduleImpl ({ TaskPriority::Normal, key },
+					[&executed, value] { executed << value; return value; });
+		};
+
+		const auto first = schedule ("key", 0);
+		schedule ("other", 1);
+		const auto second = schedule ("key", 2);
+
+		QVERIFY (first.isCanceled ());
+		QVERIFY (first.isFinished ());
+
+		thread.SetPaused (false);
+		QCOMPARE (WaitFor (second), 2);
+
+		QCOMPARE (executed, (QList<int> { 1, 2 }));
+	}
+
+	void WorkerThreadTest::testCancellation ()
+	{
+		TestThread thread;
+
+		bool executed = false;
+		auto future = thread.ScheduleImpl ([&executed] { executed = true; });
+		future.cancel ();
+
+		const auto last = thread.ScheduleImpl ([] {});
+
+		thread.SetPaused (false);
+		WaitFor (last);
+		WaitFor (future);
+
+		QCOMPARE (executed, false);
+	}
+
+	void WorkerThreadTest::testMetrics ()
+	{
+		TestThread thread;
+
+		auto canceled = thread.ScheduleImpl ([] {});
+		canceled.cancel ();
+		thread.ScheduleImpl ({ TaskPriority::High, "key" }, [] {});
+		thread.ScheduleImpl ({ TaskPriority::High, "key" }, [] {});
+		thread.ScheduleImpl ({ TaskPriority::Low }, [] {});
+
+		const auto& pending = thread.GetQueueMetrics ();
+		QCOMPARE (pending.Pending_ [static_cast<int> (TaskPriority::Low)], size_t { 1 });
+		QCOMPARE (pending.Pending_ [static_cast<int> (TaskPriority::Normal)], size_t { 1 });
+		QCOMPARE (pending.Pending_ [static_cast<int> (TaskPriority::High)], size_t { 1 });
+		QCOMPARE (pending.Coalesced_, uint64_t { 1 });
+		QCOMPARE (thread.GetQueueSize (), size_t { 3 });
+
+		const auto last = thread.ScheduleImpl ({ TaskPriority::Low }, [] {});
+		thread.SetPaused (false);
+		WaitFor (last);
+
+		const auto& done = thread.GetQueueMetrics ();
+		QCOMPARE (done.GetPendingCount (), size_t { 0 });
+		QCOMPARE (done.Executed_, uint64_t { 3 });
+		QCOMPARE (done.Canceled_, uint64_t { 1 });
+		QCOMPARE (done.MaxPending_, size_t { 4 });
+	}
+}
+}
@@ -28,12 +28,22 @@
  **********************************************************************/
 
 #include "workerthreadbase.h"
+#include <algorithm>
+#include <optional>
 #include <util/sll/slotclosure.h>
 
 namespace LeechCraft
 {
 namespace Util
 {
+	namespace
+	{
+		int ToIndex (TaskPriority priority)
+		{
+			return static_cast<int> (priority);
+		}
+	}
+
 	void WorkerThreadBase::SetPaused (bool paused)
 	{
 		if (paused == IsPaused_)
@@ -44,10 +54,96 @@ namespace Util
 			emit rotateFuncs ();
 	}
 
+	void WorkerThreadBase::SetBatchSize (int size)
+	{
+		BatchSize_ = std::max (size, 1);
+	}
+
 	size_t WorkerThreadBase::GetQueueSize ()
+	{
+		return GetQueueMetrics ().GetPendingCount ();
+	}
+
+	WorkerQueueMetrics WorkerThreadBase::GetQueueMetrics ()
 	{
 		QMutexLocker locker { &FunctionsMutex_ };
-		return Functions_.size ();
+		auto metrics = Metrics_;
+		for (size_t i = 0; i < Queues_.size (); ++i)
+			metrics.Pending_ [i] = Queues_ [i].size ();
+		return metrics;
+	}
+
+	void WorkerThreadBase::Enqueue (const TaskParams& params, Task&& task)
+	{
+		// The replaced task is canceled out of the lock, since that may trigger its watchers.
+		std::optional<Task> replaced;
+
+		{
+			QMutexLocker locker { &FunctionsMutex_ };
+
+			auto& queue = Queues_ [ToIndex (params.Priority_)];
+
+			const auto& key = params.CoalesceKey_;
+			if (key.isEmpty ())
+				queue.push_back (std::move (task));
+			else
+			{
+				task.CoalesceKey_ = key;
+
+				const auto pos = Coalescing_.find (key);
+				if (pos != Coalescing_.end () && pos->first == params.Priority_)
+				{
+					replaced = std::move (*pos->second);
+					*pos->second = std::move (task);
+				}
+				else
+				{
+					if (pos != Coalescing_.end ())
+					{
+						replaced = std::move (*pos->second);
+						Queues_ [ToIndex (pos->first)].erase (pos->second);
+					}
+
+					queue.push_back (std::move (task));
+					Coalescing_ [key] = { params.Priority_, std::prev (queue.end ()) };
+				}
+
+				if (replaced)
+					++Metrics_.Coalesced_;
+			}
+
+			size_t pending = 0;
+			for (const auto& list : Queues_)
+				pending += list.size ();
+			Metrics_.MaxPending_ = std::max (Metrics_.MaxPending_, pending);
+		}
+
+		if (replaced)
+			replaced->Cancel_ ();
+
+		if (!IsRotateScheduled_.exchange (true))
+			emit rotateFuncs ();
+	}
+
+	QList<WorkerThreadBase::Task> WorkerThreadBase::TakeBatch ()
+	{
+		QList<Task> batch;
+
+		QMutexLocker locker { &FunctionsMutex_ };
+
+		const int batchSize = BatchSize_;
+		for (auto queue = Queues_.rbegin (); queue != Queues_.rend (); ++queue)
+			while (!queue->empty () && batch.size () < batchSize)
+			{
+				auto& task = queue->front ();
+				if (!task.CoalesceKey_.isEmpty ())
+					Coalescing_.remove (task.CoalesceKey_);
+
+				batch << std::move (task);
+				queue->pop_front ();
+			}
+
+		return batch;
 	}
 
 	void WorkerThreadBase::run ()
@@ -71,20 +167,39 @@ namespace Util
 
 	void WorkerThreadBase::RotateFuncs ()
 	{
-		if (IsPaused_)
+		/* Tasks scheduled from the tasks themselves end up here directly
+		 * via the rotateFuncs() signal, and they will be picked up by the
+		 * loop below anyway.
+		 */
+		if (IsDraining_)
 			return;
 
-		decltype (Functions_) funcs;
+		IsDraining_ = true;
 
 		{
 			QMutexLocker locker { &FunctionsMutex_ };
+			++Metrics_.Wakeups_;
+		}
 
-			using std::swap;
-			swap (funcs, Functions_);
+		while (!IsPaused_)
+		{
+			IsRotateScheduled_ = false;
+
+			const auto& batch = TakeBatch ();
+			if (batch.isEmpty ())
+				break;
+
+			uint64_t executed = 0;
+			for (const auto& task : batch)
+				if (task.Run_ ())
+					++executed;
+
+			QMutexLocker locker { &FunctionsMutex_ };
+			Metrics_.Executed_ += executed;
+			Metrics_.Canceled_ += batch.size () - executed;
 		}
 
-		for (const auto& func : funcs)
-			func ();
+		IsDraining_ = false;
 	}
 }
 }
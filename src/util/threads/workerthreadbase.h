@@ -31,12 +31,18 @@
 
 #include <functional>
 #include <atomic>
+#include <array>
+#include <list>
+#include <numeric>
 #include <QThread>
 #include <QMutex>
 #include <QMutexLocker>
 #include <QFutureInterface>
 #include <QFuture>
 #include <QList>
+#include <QHash>
+#include <QPair>
+#include <QByteArray>
 #include "futures.h"
 #include "threadsconfig.h"
 
@@ -44,38 +50,154 @@ namespace LeechCraft
 {
 namespace Util
 {
+	/** @brief The priority of a task scheduled on a WorkerThreadBase.
+	 *
+	 * Pending tasks of higher priority are always executed before the
+	 * pending tasks of lower priority. The tasks of the same priority
+	 * are executed in the order they were scheduled in.
+	 */
+	enum class TaskPriority
+	{
+		Low,
+		Normal,
+		High
+	};
+
+	/** @brief Parameters of a task scheduled on a WorkerThreadBase.
+	 */
+	struct TaskParams
+	{
+		/** @brief The priority of the task.
+		 */
+		TaskPriority Priority_ = TaskPriority::Normal;
+
+		/** @brief The coalescing key of the task.
+		 *
+		 * If this key is non-empty and there is a pending task with the
+		 * same key, the pending task is replaced by the new one, and the
+		 * future of the pending task is canceled.
+		 */
+		QByteArray CoalesceKey_ = {};
+	};
+
+	/** @brief The statistics of the queue of a WorkerThreadBase.
+	 */
+	struct WorkerQueueMetrics
+	{
+		/** @brief The number of pending tasks for each TaskPriority.
+		 */
+		std::array<size_t, 3> Pending_ {};
+
+		/** @brief The maximum total number of pending tasks ever.
+		 */
+		size_t MaxPending_ = 0;
+
+		/** @brief The number of tasks that have been executed.
+		 */
+		uint64_t Executed_ = 0;
+
+		/** @brief The number of tasks whose futures have been canceled
+		 * before they started executing.
+		 */
+		uint64_t Canceled_ = 0;
+
+		/** @brief The number of tasks replaced by newer tasks with the
+		 * same coalescing key.
+		 */
+		uint64_t Coalesced_ = 0;
+
+		/** @brief The number of times the thread woke up to drain the
+		 * queue.
+		 */
+		uint64_t Wakeups_ = 0;
+
+		size_t GetPendingCount () const
+		{
+			return std::accumulate (Pending_.begin (), Pending_.end (), size_t { 0 });
+		}
+	};
+
 	class UTIL_THREADS_API WorkerThreadBase : public QThread
 	{
 		Q_OBJECT
 
 		std::atomic_bool IsPaused_ { false };
 
+		struct Task
+		{
+			// Returns false if the task has been canceled instead of being executed.
+			std::function<bool ()> Run_;
+			std::function<void ()> Cancel_;
+
+			QByteArray CoalesceKey_;
+		};
+		using TaskQueue_t = std::list<Task>;
+
 		QMutex FunctionsMutex_;
-		QList<std::function<void ()>> Functions_;
+		std::array<TaskQueue_t, 3> Queues_;
+		QHash<QByteArray, QPair<TaskPriority, TaskQueue_t::iterator>> Coalescing_;
+		WorkerQueueMetrics Metrics_;
+
+		std::atomic_bool IsRotateScheduled_ { false };
+		bool IsDraining_ = false;
+
+		std::atomic_int BatchSize_ { 16 };
 	public:
 		using QThread::QThread;
 
 		void SetPaused (bool);
 
+		/** @brief Sets the maximum number of tasks taken per batch.
+		 *
+		 * The thread takes the tasks in batches, picking the highest
+		 * priority ones first, so a higher priority task scheduled while
+		 * a batch is running waits for at most the rest of that batch.
+		 *
+		 * @param[in] size The batch size, 16 by default.
+		 */
+		void SetBatchSize (int size);
+
 		template<typename F>
-		QFuture<std::result_of_t<F ()>> ScheduleImpl (F func)
+		QFuture<std::result_of_t<F ()>> ScheduleImpl (const TaskParams& params, F func)
 		{
 			QFutureInterface<std::result_of_t<F ()>> iface;
 			iface.reportStarted ();
 
-			auto reporting = [func, iface] () mutable
+			Task task
 			{
-				ReportFutureResult (iface, func);
+				[func, iface] () mutable
+				{
+					if (iface.isCanceled ())
+					{
+						iface.reportFinished ();
+						return false;
+					}
+
+					ReportFutureResult (iface, func);
+					return true;
+				},
+				[iface] () mutable
+				{
+					iface.reportCanceled ();
+					iface.reportFinished ();
+				},
+				{}
 			};
+			Enqueue (params, std::move (task));
 
-			{
-				QMutexLocker locker { &FunctionsMutex_ };
-				Functions_ << reporting;
-			}
+			return iface.future ();
+		}
 
-			emit rotateFuncs ();
+		template<typename F>
+		QFuture<std::result_of_t<F ()>> ScheduleImpl (F func)
+		{
+			return ScheduleImpl (TaskParams {}, std::move (func));
+		}
 
-			return iface.future ();
+		template<typename F, typename... Args>
+		QFuture<std::result_of_t<F (Args...)>> ScheduleImpl (const TaskParams& params, F f, Args&&... args)
+		{
+			return ScheduleImpl (params, [f, args...] () mutable { return std::invoke (f, args...); });
 		}
 
 		template<typename F, typename... Args>
@@ -85,12 +207,17 @@ namespace Util
 		}
 
 		virtual size_t GetQueueSize ();
+
+		WorkerQueueMetrics GetQueueMetrics ();
 	protected:
 		void run () final;
 
 		virtual void Initialize () = 0;
 		virtual void Cleanup () = 0;
 	private:
+		void Enqueue (const TaskParams&, Task&&);
+		QList<Task> TakeBatch ();
+
 		void RotateFuncs ();
 	signals:
 		void rotateFuncs ();
@@ -200,6 +327,13 @@ namespace Util
 			const auto fWrapped = [f, this] (auto... args) mutable { return std::invoke (f, Worker_.get (), args...); };
 			return WorkerThreadBase::ScheduleImpl (fWrapped, std::forward<Args> (args)...);
 		}
+
+		template<typename F, typename... Args>
+		QFuture<std::result_of_t<F (WorkerType*, Args...)>> ScheduleImpl (const TaskParams& params, F f, Args&&... args)
+		{
+			const auto fWrapped = [f, this] (auto... args) mutable { return std::invoke (f, Worker_.get (), args...); };
+			return WorkerThreadBase::ScheduleImpl (params, fWrapped, std::forward<Args> (args)...);
+		}
 	protected:
 		void Initialize () override
 		{